@@ -0,0 +1,29 @@
+$input v_texcoord0, v_color0
+
+#include <bgfx_shader.sh>
+
+SAMPLER2DARRAY(s_texBiomes, 0);
+uniform vec4 u_skyColor;     // Current sky color for ambient tint
+uniform vec4 u_sunDirection; // Sun direction for basic lighting
+uniform vec4 u_timeOfDay;    // Time info: x=normalizedTime, y=sunHeight
+
+void main()
+{
+    // Weights are quantized to 8 bits, renormalize so they sum to one
+    vec4 weights = v_color0 / max(dot(v_color0, vec4(1.0, 1.0, 1.0, 1.0)), 0.0001);
+
+    vec4 color = texture2DArray(s_texBiomes, vec3(v_texcoord0, 0.0)) * weights.x
+               + texture2DArray(s_texBiomes, vec3(v_texcoord0, 1.0)) * weights.y
+               + texture2DArray(s_texBiomes, vec3(v_texcoord0, 2.0)) * weights.z
+               + texture2DArray(s_texBiomes, vec3(v_texcoord0, 3.0)) * weights.w;
+
+    // Basic lighting based on sun height
+    float sunHeight = u_timeOfDay.y;
+    float lightIntensity = max(0.3, sunHeight * 0.7 + 0.3); // Never completely dark
+
+    // Apply sky color tint and lighting
+    vec3 litColor = color.rgb * lightIntensity;
+    vec3 finalColor = mix(litColor, litColor * u_skyColor.rgb, 0.2);
+
+    gl_FragColor = vec4(finalColor, 1.0);
+}
@@ -4,7 +4,10 @@ vec3 v_normal    : NORMAL    = vec3(0.0, 0.0, 1.0);
 vec3 a_position   : POSITION;
 vec3 a_normal     : NORMAL;
 vec2 a_texcoord0  : TEXCOORD0;
+vec4 a_indices    : BLENDINDICES;
+vec4 a_weight     : BLENDWEIGHT;
 vec4 i_data0      : TEXCOORD7;
 vec4 i_data1      : TEXCOORD6;
 vec4 i_data2      : TEXCOORD5;
-vec4 i_data3      : TEXCOORD4;
\ No newline at end of file
+vec4 i_data3      : TEXCOORD4;
+vec4 i_data4      : TEXCOORD3;
\ No newline at end of file
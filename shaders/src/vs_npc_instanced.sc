@@ -1,19 +1,49 @@
-$input a_position, a_normal, a_texcoord0, i_data0, i_data1, i_data2, i_data3
+$input a_position, a_normal, a_texcoord0, a_indices, a_weight, i_data0, i_data1, i_data2, i_data3, i_data4
 $output v_texcoord0, v_normal
 
 #include <bgfx_shader.sh>
 
+// Skin matrices of every drawn instance, four RGBA32F texels (columns) per joint; see SkinPalette
+SAMPLER2D(s_skinPalette, 1);
+uniform vec4 u_skinPaletteInfo; // x = width in texels, y = 1 / width, z = 1 / height
+
+vec4 paletteTexel(float texel)
+{
+    float row = floor(texel * u_skinPaletteInfo.y);
+    float column = texel - row * u_skinPaletteInfo.x;
+    vec2 uv = vec2((column + 0.5) * u_skinPaletteInfo.y, (row + 0.5) * u_skinPaletteInfo.z);
+    return texture2DLod(s_skinPalette, uv, 0.0);
+}
+
+mat4 paletteMatrix(float paletteOffset, float joint)
+{
+    float texel = paletteOffset + joint * 4.0;
+    return mtxFromCols(paletteTexel(texel), paletteTexel(texel + 1.0), paletteTexel(texel + 2.0), paletteTexel(texel + 3.0));
+}
+
 void main()
 {
     // Extract instance matrix from instance data  
     mat4 instanceMatrix = mtxFromCols(i_data0, i_data1, i_data2, i_data3);
     
-    // Apply instance transformation directly to vertex position (no skeletal animation for now)
-    vec4 worldPosition = mul(instanceMatrix, vec4(a_position, 1.0));
+    // i_data4: x = first palette texel of this instance, y = 1 if it is animated
+    vec4 position = vec4(a_position, 1.0);
+    vec4 normal = vec4(a_normal, 0.0);
+    if (i_data4.y > 0.5)
+    {
+        mat4 skinMatrix = paletteMatrix(i_data4.x, a_indices.x) * a_weight.x
+                        + paletteMatrix(i_data4.x, a_indices.y) * a_weight.y
+                        + paletteMatrix(i_data4.x, a_indices.z) * a_weight.z
+                        + paletteMatrix(i_data4.x, a_indices.w) * a_weight.w;
+        position = mul(skinMatrix, position);
+        normal = mul(skinMatrix, normal);
+    }
+    
+    vec4 worldPosition = mul(instanceMatrix, position);
     
     gl_Position = mul(u_viewProj, worldPosition);
     v_texcoord0 = a_texcoord0;
     
     // Transform normal to world space (assuming uniform scaling)
-    v_normal = mul(instanceMatrix, vec4(a_normal, 0.0)).xyz;
-}
\ No newline at end of file
+    v_normal = mul(instanceMatrix, normal).xyz;
+}
@@ -0,0 +1,201 @@
+#include "animation_library.h"
+#include "model.h"
+#include <ozz/base/io/stream.h>
+#include <ozz/base/io/archive.h>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+ozz::math::Float4x4 loadMatrix(const float* matrix) {
+    // Column-major float array to ozz::math::Float4x4
+    ozz::math::Float4x4 result;
+    result.cols[0] = ozz::math::simd_float4::Load(matrix[0], matrix[1], matrix[2], matrix[3]);
+    result.cols[1] = ozz::math::simd_float4::Load(matrix[4], matrix[5], matrix[6], matrix[7]);
+    result.cols[2] = ozz::math::simd_float4::Load(matrix[8], matrix[9], matrix[10], matrix[11]);
+    result.cols[3] = ozz::math::simd_float4::Load(matrix[12], matrix[13], matrix[14], matrix[15]);
+    return result;
+}
+
+ozz::math::Float4x4 identityMatrix() {
+    static const float identity[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                       0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    return loadMatrix(identity);
+}
+
+// Deserialize one ozz object from an archive file
+template <typename T>
+bool readArchive(const std::string& path, T& object, const char* kind) {
+    ozz::io::File file(path.c_str(), "rb");
+    if (!file.opened()) {
+        std::cerr << "Failed to open " << kind << " file: " << path << std::endl;
+        return false;
+    }
+
+    ozz::io::IArchive archive(&file);
+    if (!archive.TestTag<T>()) {
+        std::cerr << "Invalid " << kind << " file format: " << path << std::endl;
+        return false;
+    }
+
+    archive >> object;
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<SkinBinding> SkinBinding::create(int ozzJointCount, const float* gltfInverseBindMatrices, int numGltfJoints,
+                                                 const std::vector<int>& gltfToOzzMapping) {
+    auto binding = std::make_shared<SkinBinding>();
+    binding->inverseBindMatrices.resize(ozzJointCount, identityMatrix());
+    binding->gltfToOzz = gltfToOzzMapping;
+    binding->gltfToOzz.resize(numGltfJoints, -1);
+
+    for (int gltfIndex = 0; gltfIndex < numGltfJoints; gltfIndex++) {
+        int ozzIndex = binding->gltfToOzz[gltfIndex];
+        if (ozzIndex >= 0 && ozzIndex < ozzJointCount) {
+            binding->inverseBindMatrices[ozzIndex] = loadMatrix(gltfInverseBindMatrices + gltfIndex * 16);
+            binding->mappedJoints++;
+        }
+    }
+    return binding;
+}
+
+AnimationLibrary& AnimationLibrary::get() {
+    static AnimationLibrary library;
+    return library;
+}
+
+std::shared_ptr<const SkeletonAsset> AnimationLibrary::loadSkeleton(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = skeletons.find(path);
+    if (found != skeletons.end()) {
+        if (auto cached = found->second.lock()) {
+            cacheHits++;
+            return cached;
+        }
+    }
+    if (failedPaths.count(path)) return nullptr;
+
+    auto asset = std::make_shared<SkeletonAsset>();
+    asset->path = path;
+    if (!readArchive(path, asset->skeleton, "skeleton")) {
+        failedPaths.insert(path);
+        return nullptr;
+    }
+    fileLoads++;
+
+    std::cout << "Loaded skeleton " << path << " with " << asset->skeleton.num_joints() << " joints" << std::endl;
+    pruneExpired();
+    skeletons[path] = asset;
+    return asset;
+}
+
+std::shared_ptr<const AnimationAsset> AnimationLibrary::loadAnimation(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = clips.find(path);
+    if (found != clips.end()) {
+        if (auto cached = found->second.lock()) {
+            cacheHits++;
+            return cached;
+        }
+    }
+    if (failedPaths.count(path)) return nullptr;
+
+    auto clip = std::make_shared<AnimationAsset>();
+    clip->path = path;
+    if (!readArchive(path, clip->animation, "animation")) {
+        failedPaths.insert(path);
+        return nullptr;
+    }
+    fileLoads++;
+
+    std::cout << "Loaded animation " << path << " with duration: " << clip->animation.duration() << "s" << std::endl;
+    pruneExpired();
+    clips[path] = clip;
+    return clip;
+}
+
+std::shared_ptr<const SkinBinding> AnimationLibrary::getSkinBinding(const std::shared_ptr<const SkeletonAsset>& skeleton,
+                                                                    const Model& model, int firstOzzJoint) {
+    if (!skeleton) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_tuple(skeleton->path, model.sourcePath, firstOzzJoint);
+    auto found = model.sourcePath.empty() ? skinBindings.end() : skinBindings.find(key);
+    if (found != skinBindings.end()) {
+        if (auto cached = found->second.lock()) {
+            cacheHits++;
+            return cached;
+        }
+    }
+
+    std::vector<float> inverseBindMatrices;
+    if (!model.getInverseBindMatrices(inverseBindMatrices)) {
+        std::cerr << "Failed to extract inverse bind matrices from model for " << skeleton->path << std::endl;
+        return nullptr;
+    }
+    const int numGltfJoints = (int)(inverseBindMatrices.size() / 16);
+
+    // One pass over the ozz joint names instead of a scan per glTF joint
+    const auto jointNames = skeleton->skeleton.joint_names();
+    std::unordered_map<std::string, int> ozzJointsByName;
+    for (int ozzIndex = (int)jointNames.size() - 1; ozzIndex >= firstOzzJoint; ozzIndex--) {
+        ozzJointsByName[jointNames[ozzIndex]] = ozzIndex;  // Lowest index wins, as the scan did
+    }
+
+    std::vector<int> gltfToOzz(numGltfJoints, -1);
+    if (!model.skins.empty()) {
+        const auto& skin = model.skins[0];
+        for (int skinIndex = 0; skinIndex < (int)skin.jointIndices.size() && skinIndex < numGltfJoints; skinIndex++) {
+            int nodeIndex = skin.jointIndices[skinIndex];
+            if (nodeIndex < 0 || nodeIndex >= (int)model.nodes.size()) continue;
+            auto ozzJoint = ozzJointsByName.find(model.nodes[nodeIndex].name);
+            if (ozzJoint != ozzJointsByName.end()) {
+                gltfToOzz[skinIndex] = ozzJoint->second;
+            }
+        }
+    }
+
+    std::shared_ptr<const SkinBinding> binding =
+        SkinBinding::create(skeleton->skeleton.num_joints(), inverseBindMatrices.data(), numGltfJoints, gltfToOzz);
+    std::cout << "Skin binding for " << skeleton->path << ": " << binding->mappedJoints << "/" << numGltfJoints
+              << " joints mapped" << std::endl;
+    if (!model.sourcePath.empty()) {
+        pruneExpired();
+        skinBindings[key] = binding;
+    }
+    return binding;
+}
+
+void AnimationLibrary::pruneExpired() {
+    auto prune = [](auto& entries) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->second.expired() ? entries.erase(it) : std::next(it);
+        }
+    };
+    prune(skinBindings);
+    prune(clips);
+    prune(skeletons);
+}
+
+AnimationLibrary::Stats AnimationLibrary::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    for (const auto& skeleton : skeletons) {
+        if (!skeleton.second.expired()) stats.skeletons++;
+    }
+    for (const auto& binding : skinBindings) {
+        if (!binding.second.expired()) stats.skinBindings++;
+    }
+    for (const auto& entry : clips) {
+        if (auto clip = entry.second.lock()) {
+            stats.clips++;
+            stats.clipBytes += clip->animation.size();
+        }
+    }
+    stats.fileLoads = fileLoads;
+    stats.cacheHits = cacheHits;
+    stats.failedPaths = failedPaths.size();
+    return stats;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <ozz/animation/runtime/animation.h>
+#include <ozz/animation/runtime/skeleton.h>
+#include <ozz/base/maths/simd_math.h>
+#include <ozz/base/containers/vector.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class Model;
+
+// Immutable animation data shared by every OzzAnimationSystem that uses it
+struct SkeletonAsset {
+    std::string path;
+    ozz::animation::Skeleton skeleton;
+};
+
+struct AnimationAsset {
+    std::string path;
+    ozz::animation::Animation animation;
+};
+
+// Inverse bind matrices of a glTF skin laid out in ozz joint order (identity for joints
+// the skin doesn't mention), and the glTF skin joint -> ozz joint remap they came from
+struct SkinBinding {
+    ozz::vector<ozz::math::Float4x4> inverseBindMatrices;
+    std::vector<int> gltfToOzz;  // -1 where a glTF joint has no ozz counterpart
+    int mappedJoints = 0;
+
+    // gltfInverseBindMatrices: numGltfJoints column-major 4x4s in glTF skin order
+    static std::shared_ptr<SkinBinding> create(int ozzJointCount, const float* gltfInverseBindMatrices, int numGltfJoints,
+                                               const std::vector<int>& gltfToOzzMapping);
+};
+
+// Process-wide cache of skeletons, clips and skin bindings. Each file is read and
+// deserialized once; instances hold shared references and keep only their runtime
+// buffers. The cache holds weak references, so an asset is freed when its last user goes
+// and read again if it's needed later. Paths that failed to load are remembered so
+// spawning more NPCs with a missing asset doesn't retry the file. Thread safe.
+class AnimationLibrary {
+public:
+    static AnimationLibrary& get();
+
+    // nullptr if the file is missing or not a skeleton/animation archive; the failure is
+    // reported once and later requests for the same path return nullptr straight away
+    std::shared_ptr<const SkeletonAsset> loadSkeleton(const std::string& path);
+    std::shared_ptr<const AnimationAsset> loadAnimation(const std::string& path);
+
+    // Skin binding of model's first skin to skeleton, matching joints by name. The first
+    // firstOzzJoint ozz joints (armature roots the glTF skin doesn't have) are skipped.
+    // Cached by skeleton path, model source path and firstOzzJoint; a model without a
+    // source path gets a fresh binding every call.
+    std::shared_ptr<const SkinBinding> getSkinBinding(const std::shared_ptr<const SkeletonAsset>& skeleton,
+                                                      const Model& model, int firstOzzJoint = 0);
+
+    struct Stats {
+        size_t skeletons = 0;     // Live entries, still referenced by some instance
+        size_t clips = 0;
+        size_t skinBindings = 0;
+        size_t clipBytes = 0;     // Compressed track data of the cached clips
+        uint64_t fileLoads = 0;   // Archives read from disk
+        uint64_t cacheHits = 0;   // Requests served without touching the disk
+        size_t failedPaths = 0;   // Missing or invalid archives, not retried
+    };
+    Stats getStats() const;
+
+private:
+    AnimationLibrary() = default;
+
+    // Forget entries whose asset has been freed; called with the mutex held
+    void pruneExpired();
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::weak_ptr<const SkeletonAsset>> skeletons;
+    std::map<std::string, std::weak_ptr<const AnimationAsset>> clips;
+    std::set<std::string> failedPaths;
+    // Keyed by skeleton path, model path and first ozz joint, none of which dangle when
+    // a skeleton or model is freed and another takes its address
+    std::map<std::tuple<std::string, std::string, int>, std::weak_ptr<const SkinBinding>> skinBindings;
+    uint64_t fileLoads = 0;
+    uint64_t cacheHits = 0;
+};
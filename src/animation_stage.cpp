@@ -0,0 +1,274 @@
+#include "animation_stage.h"
+#include "ozz_animation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+int AnimationLodPolicy::getTier(float distance, bool visible) const {
+    if (!visible) return getOffscreenTier();
+    for (size_t i = 0; i < bands.size(); i++) {
+        if (distance <= bands[i].maxDistance) return (int)i;
+    }
+    return getOffscreenTier();  // Past the last band is as good as off screen
+}
+
+float AnimationLodPolicy::getSampleInterval(int tier) const {
+    if (tier < 0 || tier >= (int)bands.size() || bands[tier].sampleHz <= 0.0f) return 0.0f;
+    return 1.0f / bands[tier].sampleHz;
+}
+
+bool AnimationLodPolicy::sharesPose(int tier) const {
+    return tier >= 0 && tier < (int)bands.size() && bands[tier].sharePose && bands[tier].sampleHz > 0.0f;
+}
+
+AnimationUpdateStage::AnimationUpdateStage(ThreadPool* workerPool) : workerPool(workerPool) {
+    stats.threads = (workerPool ? workerPool->getThreadCount() : 0) + 1;
+    // Rough first guesses for a 67-joint skeleton; replaced by measurements after a frame
+    stats.sampleMicroseconds = 8.0;
+    stats.poseMicroseconds = 4.0;
+}
+
+void AnimationUpdateStage::setLodPolicy(const AnimationLodPolicy& policy) {
+    lodPolicy = policy;
+}
+
+void AnimationUpdateStage::begin() {
+    instances.clear();
+}
+
+int AnimationUpdateStage::add(OzzAnimationSystem* system, float distance, bool visible) {
+    if (!system || !system->isLoaded() || !system->getCurrentClip()) return -1;
+
+    Instance instance;
+    instance.system = system;
+    instance.clip = system->getCurrentClip();
+    instance.tier = lodPolicy.getTier(distance, visible);
+    instances.push_back(instance);
+    return (int)instances.size() - 1;
+}
+
+void AnimationUpdateStage::run(float deltaTime) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Group by clip, then by instance so repeated adds end up next to each other
+    order.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); i++) {
+        order[i] = (int)i;
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const Instance& first = instances[a];
+        const Instance& second = instances[b];
+        if (first.clip != second.clip) return first.clip < second.clip;
+        return first.system < second.system;
+    });
+
+    // Repeated adds read the palette of the first one
+    size_t distinct = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        Instance& instance = instances[order[i]];
+        instance.paletteSource = -1;
+        if (distinct > 0 && instances[order[distinct - 1]].system == instance.system) {
+            instance.paletteSource = order[distinct - 1];
+            continue;
+        }
+        order[distinct++] = order[i];
+    }
+    order.resize(distinct);
+    stats.instances = distinct;
+
+    // Advancing is a few flops per instance; not worth a thread
+    for (int index : order) {
+        instances[index].system->advance(deltaTime);
+    }
+    planWork();
+
+    // Lay the palettes out in that order; everyone else points at their source's palette
+    size_t paletteSize = 0;
+    for (int index : order) {
+        instances[index].paletteOffset = paletteSize;
+        paletteSize += instances[index].system->getNumBones();
+    }
+    for (Instance& instance : instances) {
+        int source = instance.paletteSource;
+        if (source < 0) continue;
+        while (instances[source].paletteSource >= 0) source = instances[source].paletteSource;
+        instance.paletteOffset = instances[source].paletteOffset;
+    }
+    palettes.resize(paletteSize);
+
+    const size_t batchCount = (order.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+    nextBatch = 0;
+    // Helpers still stuck behind another job when the batches run out are told to skip, so
+    // only the ones already evaluating are waited for
+    struct Helpers {
+        std::mutex mutex;
+        std::condition_variable finished;
+        int running = 0;
+        bool closed = false;
+    };
+    auto helpers = std::make_shared<Helpers>();
+    if (workerPool && batchCount > 1) {
+        size_t helperCount = std::min(workerPool->getThreadCount(), batchCount - 1);
+        for (size_t i = 0; i < helperCount; i++) {
+            workerPool->submitUrgent([this, helpers]() {
+                {
+                    std::lock_guard<std::mutex> lock(helpers->mutex);
+                    if (helpers->closed) return;
+                    helpers->running++;
+                }
+                evaluateBatches();
+                std::lock_guard<std::mutex> lock(helpers->mutex);
+                if (--helpers->running == 0) helpers->finished.notify_one();
+            });
+        }
+    }
+    evaluateBatches();
+    {
+        std::unique_lock<std::mutex> lock(helpers->mutex);
+        helpers->closed = true;
+        helpers->finished.wait(lock, [&helpers]() { return helpers->running == 0; });
+    }
+
+    updateCostEstimates();
+    stats.batches = batchCount;
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AnimationUpdateStage::planWork() {
+    const int offscreenTier = lodPolicy.getOffscreenTier();
+    double estimate = 0.0;
+    poseOwners.clear();
+    stats.sharedPoses = 0;
+    for (int index : order) {
+        Instance& instance = instances[index];
+        instance.sharedPose = false;
+        instance.system->setSampleInterval(lodPolicy.getSampleInterval(instance.tier));
+        if (lodPolicy.sharesPose(instance.tier)) {
+            // The first instance in a (clip, binding, step) bucket samples it for everyone
+            const float sampleHz = lodPolicy.bands[instance.tier].sampleHz;
+            const int step = (int)std::floor(instance.system->getAnimationTime() * sampleHz);
+            auto key = std::make_tuple(instance.clip, (const void*)instance.system->getSkinBinding(), step);
+            auto owner = poseOwners.emplace(key, index);
+            instance.system->resetLodPoses();
+            if (owner.second) {
+                instance.sharedPose = true;
+                instance.poseTime = step / sampleHz;
+                instance.sample = true;
+                instance.computePose = true;
+                stats.sharedPoses++;
+            } else {
+                instance.paletteSource = owner.first->second;
+                instance.system->borrowPose();
+                instance.sample = false;
+                instance.computePose = false;
+            }
+        } else if (instance.tier == offscreenTier) {
+            // The clock kept running in advance(); nobody sees the pose
+            instance.sample = false;
+            instance.computePose = false;
+        } else {
+            const AnimationLodPolicy::Band& band = lodPolicy.bands[instance.tier];
+            instance.sample = instance.system->needsSample();
+            // Just out of a shared pose there is no pose of its own to hold yet
+            instance.computePose = instance.sample || band.interpolate || band.sampleHz <= 0.0f ||
+                                   !instance.system->hasCurrentSkinMatrices();
+        }
+        estimate += (instance.sample ? stats.sampleMicroseconds : 0.0) +
+                    (instance.computePose ? stats.poseMicroseconds : 0.0);
+    }
+
+    // Over budget: hold the pose of the farthest instances first, if they have one to hold
+    stats.deferred = 0;
+    const double available = lodPolicy.budgetMicroseconds * stats.threads;
+    if (lodPolicy.budgetMicroseconds > 0.0f && estimate > available) {
+        std::vector<int> reducible;
+        for (int index : order) {
+            const Instance& instance = instances[index];
+            if (instance.tier > 0 && !instance.sharedPose && (instance.sample || instance.computePose) &&
+                instance.system->hasCurrentSkinMatrices()) {
+                reducible.push_back(index);
+            }
+        }
+        std::stable_sort(reducible.begin(), reducible.end(),
+                         [this](int a, int b) { return instances[a].tier > instances[b].tier; });
+        for (int index : reducible) {
+            if (estimate <= available) break;
+            Instance& instance = instances[index];
+            estimate -= (instance.sample ? stats.sampleMicroseconds : 0.0) +
+                        (instance.computePose ? stats.poseMicroseconds : 0.0);
+            stats.deferred += instance.sample ? 1 : 0;
+            instance.sample = false;
+            instance.computePose = false;
+        }
+    }
+    stats.estimatedMicroseconds = estimate / stats.threads;
+
+    stats.tiers.assign(lodPolicy.getTierCount(), TierStats());
+    for (int index : order) {
+        const Instance& instance = instances[index];
+        TierStats& tier = stats.tiers[instance.tier];
+        tier.instances++;
+        tier.sampled += instance.sample ? 1 : 0;
+        tier.posed += instance.computePose ? 1 : 0;
+        tier.shared += instance.paletteSource >= 0 ? 1 : 0;
+    }
+
+    // Instances borrowing a shared pose have nothing left to do
+    order.erase(std::remove_if(order.begin(), order.end(),
+                               [this](int index) { return instances[index].paletteSource >= 0; }),
+                order.end());
+}
+
+void AnimationUpdateStage::updateCostEstimates() {
+    // Pose-only instances time the pose; sampled ones the sample on top of it
+    double poseTotal = 0.0, sampleTotal = 0.0;
+    int poseCount = 0, sampleCount = 0;
+    for (int index : order) {
+        const Instance& instance = instances[index];
+        if (!instance.computePose) continue;
+        if (instance.sample) {
+            sampleTotal += instance.microseconds;
+            sampleCount++;
+        } else {
+            poseTotal += instance.microseconds;
+            poseCount++;
+        }
+    }
+
+    constexpr double SMOOTHING = 0.1;
+    if (poseCount > 0) {
+        stats.poseMicroseconds += (poseTotal / poseCount - stats.poseMicroseconds) * SMOOTHING;
+    }
+    if (sampleCount > 0) {
+        double sampleOnly = std::max(0.0, sampleTotal / sampleCount - stats.poseMicroseconds);
+        stats.sampleMicroseconds += (sampleOnly - stats.sampleMicroseconds) * SMOOTHING;
+    }
+}
+
+void AnimationUpdateStage::evaluateBatches() {
+    // Threads pull batches until none are left, so a slow batch doesn't stall the rest
+    for (;;) {
+        size_t first = nextBatch.fetch_add(1) * BATCH_SIZE;
+        if (first >= order.size()) return;
+        size_t last = std::min(first + BATCH_SIZE, order.size());
+        for (size_t i = first; i < last; i++) {
+            Instance& instance = instances[order[i]];
+            auto start = std::chrono::steady_clock::now();
+            if (instance.sharedPose) {
+                instance.system->evaluateAt(instance.poseTime, palettes.data() + instance.paletteOffset);
+            } else {
+                instance.system->evaluateLod(palettes.data() + instance.paletteOffset, instance.sample,
+                                             instance.computePose);
+            }
+            instance.microseconds =
+                std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+}
+
+const ozz::math::Float4x4* AnimationUpdateStage::getPalette(int handle) const {
+    if (handle < 0 || handle >= (int)instances.size()) return nullptr;
+    return palettes.data() + instances[handle].paletteOffset;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "thread_pool.h"
+#include <ozz/base/maths/simd_math.h>
+#include <ozz/base/containers/vector.h>
+#include <atomic>
+#include <cfloat>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+class OzzAnimationSystem;
+
+// Which instances get a fresh pose how often. Visible instances fall into the first band
+// whose maxDistance covers their distance to the camera; off-screen ones into a final tier
+// of their own that only keeps the clock running. Tier i is bands[i], the off-screen
+// tier is bands.size().
+//
+// In a band with sharePose, instances on the same clip and skin binding whose clocks fall
+// in the same 1 / sampleHz step share one pose, sampled at the start of that step, so the
+// work scales with the number of distinct poses rather than instances. The poses are
+// held, not blended, and the budget never defers them.
+struct AnimationLodPolicy {
+    struct Band {
+        float maxDistance;   // World units from the camera
+        float sampleHz;      // Fresh poses per second, 0 = every frame at the exact clock
+        bool interpolate;    // Blend between samples every frame, or hold the last pose
+        bool sharePose;      // Quantize the clock and share poses, needs sampleHz > 0
+    };
+    std::vector<Band> bands = {
+        {25.0f, 30.0f, true, false},
+        {60.0f, 15.0f, true, false},
+        {120.0f, 8.0f, false, true},
+        {FLT_MAX, 4.0f, false, true},
+    };
+    // Wall-time budget of one run(), 0 = unlimited. The nearest band is never deferred, so
+    // an instance can't freeze in front of the camera when the crowd is too big.
+    float budgetMicroseconds = 2000.0f;
+
+    int getTierCount() const { return (int)bands.size() + 1; }
+    int getOffscreenTier() const { return (int)bands.size(); }
+    int getTier(float distance, bool visible) const;
+    float getSampleInterval(int tier) const;  // Seconds, 0 = every frame
+    bool sharesPose(int tier) const;
+};
+
+// Per-frame animation update for many instances. Instances are collected once a frame,
+// grouped by clip so consecutive jobs read the same keyframes, and evaluated in batches
+// across a shared worker pool (the calling thread works too). Skin matrices land in one
+// contiguous palette, grouped the same way, ready to upload in one go. How much work each
+// instance gets follows the AnimationLodPolicy, and the budget caps the whole run.
+//
+//   stage.begin();
+//   int handle = stage.add(&npc.ozzAnimSystem, distanceToCamera, visible);
+//   stage.run(deltaTime);
+//   const ozz::math::Float4x4* skin = stage.getPalette(handle);
+class AnimationUpdateStage {
+public:
+    static constexpr size_t BATCH_SIZE = 32;  // Instances per job pull
+
+    // Helpers go ahead of the pool's queued jobs, and run() never waits for one that hasn't
+    // started, so the pool can stay busy with other work. nullptr evaluates everything on
+    // the calling thread. The pool must outlive the stage.
+    explicit AnimationUpdateStage(ThreadPool* workerPool = nullptr);
+
+    void setLodPolicy(const AnimationLodPolicy& policy);
+    const AnimationLodPolicy& getLodPolicy() const { return lodPolicy; }
+
+    // Forget last frame's instances; palettes stay valid until the next run()
+    void begin();
+    // Queue an instance for this frame; -1 if it has no skeleton or clip loaded.
+    // An instance added twice is only advanced once. Instances sharing a pose
+    // also share a palette, so getPalette returns the same pointer for them.
+    int add(OzzAnimationSystem* system, float distance = 0.0f, bool visible = true);
+    // Advance and evaluate every queued instance; returns once all palettes are written
+    void run(float deltaTime);
+
+    // Skin matrices of an instance in ozz joint order, getNumBones() of them
+    const ozz::math::Float4x4* getPalette(int handle) const;
+    const ozz::vector<ozz::math::Float4x4>& getPalettes() const { return palettes; }
+    size_t getPaletteOffset(int handle) const { return instances[handle].paletteOffset; }
+
+    struct TierStats {
+        int instances = 0;
+        int sampled = 0;    // Took a fresh pose this frame
+        int posed = 0;      // Ran local-to-model and skinning this frame
+        int shared = 0;     // Reused a pose sampled for another instance
+    };
+    struct Stats {
+        size_t instances = 0;
+        size_t batches = 0;
+        size_t threads = 1;        // Including the calling thread
+        double milliseconds = 0.0; // Wall time of the last run()
+        std::vector<TierStats> tiers;
+        int deferred = 0;          // Samples pushed to a later frame by the budget
+        int sharedPoses = 0;       // Poses sampled once for a pose-sharing bucket
+        double estimatedMicroseconds = 0.0;
+        double sampleMicroseconds = 0.0;  // Running cost estimates per instance
+        double poseMicroseconds = 0.0;
+    };
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Instance {
+        OzzAnimationSystem* system = nullptr;
+        const void* clip = nullptr;  // Grouping key
+        size_t paletteOffset = 0;
+        int tier = 0;
+        bool sample = false;
+        bool computePose = false;
+        bool sharedPose = false;     // Samples at poseTime for its whole bucket
+        float poseTime = 0.0f;
+        int paletteSource = -1;      // Reads this instance's palette: a repeated add or shared pose
+        float microseconds = 0.0f;   // Measured by the thread that evaluated it
+    };
+
+    void planWork();
+    void evaluateBatches();
+    void updateCostEstimates();
+
+    ThreadPool* workerPool = nullptr;
+    AnimationLodPolicy lodPolicy;
+    std::vector<Instance> instances;  // In add() order, so handles are indices
+    std::vector<int> order;           // Instances with a palette of their own, grouped by clip
+    std::map<std::tuple<const void*, const void*, int>, int> poseOwners;  // (clip, binding, step)
+    ozz::vector<ozz::math::Float4x4> palettes;
+    std::atomic<size_t> nextBatch{0};
+    Stats stats;
+};
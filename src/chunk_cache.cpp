@@ -0,0 +1,280 @@
+#include "chunk_cache.h"
+#include <iostream>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t REGION_MAGIC = 0x52434847;  // "GHCR"
+constexpr uint32_t REGION_FORMAT_VERSION = 1;  // Layout of the header/entry table below
+
+struct RegionHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t dataVersion;
+    int32_t regionX;
+    int32_t regionZ;
+    uint32_t reserved[3];
+};
+
+struct RegionEntry {
+    uint64_t key;       // Chunk key the record belongs to
+    uint32_t offset;    // Record position in the file, 0 if the slot is empty
+    uint32_t size;      // Record size in bytes
+    uint32_t capacity;  // Space reserved at offset, lets rewrites stay in place
+    uint32_t checksum;  // FNV-1a of the record bytes
+};
+
+constexpr size_t ENTRY_COUNT = ChunkCache::REGION_SIZE * ChunkCache::REGION_SIZE;
+constexpr size_t TABLE_OFFSET = sizeof(RegionHeader);
+constexpr size_t DATA_OFFSET = TABLE_OFFSET + ENTRY_COUNT * sizeof(RegionEntry);
+
+int floorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+uint64_t getRegionKey(int regionX, int regionZ) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(regionX)) << 32) | static_cast<uint32_t>(regionZ);
+}
+
+bool writeAll(int fd, const void* data, size_t size, size_t offset) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = pwrite(fd, bytes, size, (off_t)offset);
+        if (written <= 0) return false;
+        bytes += written;
+        offset += (size_t)written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+} // namespace
+
+struct ChunkCache::Region {
+    int regionX = 0;
+    int regionZ = 0;
+    int fd = -1;
+    uint8_t* mapped = nullptr;
+    size_t mappedSize = 0;
+    size_t fileSize = 0;
+    uint64_t lastUse = 0;
+};
+
+ChunkCache::ChunkCache(const std::string& directory, uint32_t dataVersion)
+    : directory(directory), dataVersion(dataVersion) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Chunk cache disabled, cannot create " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+    enabled = true;
+}
+
+ChunkCache::~ChunkCache() {
+    for (auto& pair : regions) {
+        closeRegion(*pair.second);
+    }
+}
+
+uint32_t ChunkCache::checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+ChunkCache::Stats ChunkCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool ChunkCache::read(int chunkX, int chunkZ, uint64_t chunkKey, std::vector<uint8_t>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) return false;
+
+    int regionX = floorDiv(chunkX, REGION_SIZE);
+    int regionZ = floorDiv(chunkZ, REGION_SIZE);
+    Region* region = openRegion(regionX, regionZ);
+    if (!region || !region->mapped) {
+        stats.misses++;
+        return false;
+    }
+
+    size_t slot = (size_t)((chunkZ - regionZ * REGION_SIZE) * REGION_SIZE + (chunkX - regionX * REGION_SIZE));
+    RegionEntry entry;
+    std::memcpy(&entry, region->mapped + TABLE_OFFSET + slot * sizeof(RegionEntry), sizeof(RegionEntry));
+    if (entry.offset == 0) {
+        stats.misses++;
+        return false;
+    }
+
+    const uint8_t* record = region->mapped + entry.offset;
+    if (entry.key != chunkKey || entry.offset < DATA_OFFSET || (size_t)entry.offset + entry.size > region->mappedSize ||
+        checksum(record, entry.size) != entry.checksum) {
+        std::cerr << "Chunk cache: rejecting damaged record for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
+        stats.rejected++;
+        return false;
+    }
+
+    out.assign(record, record + entry.size);
+    stats.hits++;
+    return true;
+}
+
+bool ChunkCache::write(int chunkX, int chunkZ, uint64_t chunkKey, const std::vector<uint8_t>& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled || data.empty()) return false;
+
+    int regionX = floorDiv(chunkX, REGION_SIZE);
+    int regionZ = floorDiv(chunkZ, REGION_SIZE);
+    Region* region = openRegion(regionX, regionZ);
+    if (!region || !region->mapped) return false;
+
+    size_t slot = (size_t)((chunkZ - regionZ * REGION_SIZE) * REGION_SIZE + (chunkX - regionX * REGION_SIZE));
+    size_t entryOffset = TABLE_OFFSET + slot * sizeof(RegionEntry);
+    RegionEntry entry;
+    std::memcpy(&entry, region->mapped + entryOffset, sizeof(RegionEntry));
+
+    // Rewrite in place when the record still fits, otherwise append. A chunk's record
+    // size only changes with its spawn count, so in practice slots are reused.
+    bool append = entry.offset < DATA_OFFSET || entry.capacity < data.size();
+    size_t recordOffset = append ? region->fileSize : entry.offset;
+    if (recordOffset + data.size() > UINT32_MAX) {
+        std::cerr << "Chunk cache: region file full, not storing chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
+        return false;
+    }
+
+    // Data first, then the entry: an interrupted write leaves a checksum mismatch, not bad terrain
+    if (!writeAll(region->fd, data.data(), data.size(), recordOffset)) {
+        std::cerr << "Chunk cache: write failed for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
+        return false;
+    }
+
+    entry.key = chunkKey;
+    entry.offset = (uint32_t)recordOffset;
+    entry.size = (uint32_t)data.size();
+    entry.capacity = append ? (uint32_t)data.size() : entry.capacity;
+    entry.checksum = checksum(data.data(), data.size());
+    if (!writeAll(region->fd, &entry, sizeof(entry), entryOffset)) {
+        std::cerr << "Chunk cache: entry update failed for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
+        return false;
+    }
+
+    if (append) {
+        region->fileSize = recordOffset + data.size();
+        mapRegion(*region);
+    }
+    stats.writes++;
+    return true;
+}
+
+ChunkCache::Region* ChunkCache::openRegion(int regionX, int regionZ) {
+    uint64_t key = getRegionKey(regionX, regionZ);
+    auto it = regions.find(key);
+    if (it != regions.end()) {
+        it->second->lastUse = ++useCounter;
+        return it->second.get();
+    }
+
+    evictRegions();
+
+    std::string path = directory + "/r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".bin";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "Chunk cache: cannot open " << path << std::endl;
+        return nullptr;
+    }
+
+    auto region = std::make_unique<Region>();
+    region->regionX = regionX;
+    region->regionZ = regionZ;
+    region->fd = fd;
+    region->lastUse = ++useCounter;
+
+    struct stat fileInfo;
+    size_t fileSize = fstat(fd, &fileInfo) == 0 ? (size_t)fileInfo.st_size : 0;
+
+    RegionHeader header = {};
+    bool valid = fileSize >= DATA_OFFSET && pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+                 header.magic == REGION_MAGIC && header.formatVersion == REGION_FORMAT_VERSION &&
+                 header.dataVersion == dataVersion && header.regionX == regionX && header.regionZ == regionZ;
+
+    if (!valid) {
+        if (fileSize > 0) {
+            std::cout << "Chunk cache: discarding outdated region file " << path << std::endl;
+        }
+
+        // Fresh file: header followed by an all-zero entry table
+        header = {};
+        header.magic = REGION_MAGIC;
+        header.formatVersion = REGION_FORMAT_VERSION;
+        header.dataVersion = dataVersion;
+        header.regionX = regionX;
+        header.regionZ = regionZ;
+        if (ftruncate(fd, 0) != 0 || !writeAll(fd, &header, sizeof(header), 0) || ftruncate(fd, (off_t)DATA_OFFSET) != 0) {
+            std::cerr << "Chunk cache: cannot initialize " << path << std::endl;
+            close(fd);
+            return nullptr;
+        }
+        fileSize = DATA_OFFSET;
+    }
+
+    region->fileSize = fileSize;
+    if (!mapRegion(*region)) {
+        std::cerr << "Chunk cache: cannot map " << path << std::endl;
+        close(fd);
+        return nullptr;
+    }
+
+    Region* result = region.get();
+    regions[key] = std::move(region);
+    return result;
+}
+
+bool ChunkCache::mapRegion(Region& region) {
+    if (region.mapped) {
+        munmap(region.mapped, region.mappedSize);
+        region.mapped = nullptr;
+        region.mappedSize = 0;
+    }
+
+    void* mapped = mmap(nullptr, region.fileSize, PROT_READ, MAP_SHARED, region.fd, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    region.mapped = static_cast<uint8_t*>(mapped);
+    region.mappedSize = region.fileSize;
+    return true;
+}
+
+void ChunkCache::closeRegion(Region& region) {
+    if (region.mapped) {
+        munmap(region.mapped, region.mappedSize);
+        region.mapped = nullptr;
+    }
+    if (region.fd >= 0) {
+        close(region.fd);
+        region.fd = -1;
+    }
+}
+
+void ChunkCache::evictRegions() {
+    while (regions.size() >= MAX_OPEN_REGIONS) {
+        auto oldest = regions.begin();
+        for (auto it = regions.begin(); it != regions.end(); ++it) {
+            if (it->second->lastUse < oldest->second->lastUse) {
+                oldest = it;
+            }
+        }
+        closeRegion(*oldest->second);
+        regions.erase(oldest);
+    }
+}
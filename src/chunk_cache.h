@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// On-disk cache of generated chunk records, grouped into memory-mapped region files.
+//
+// Each region file covers REGION_SIZE x REGION_SIZE chunks:
+//   header | entry table (one slot per chunk) | records
+// Every entry stores the chunk key, the record's offset/size and a checksum. A record
+// that fails any check is treated as a miss, so a torn write just means regeneration.
+class ChunkCache {
+public:
+    static constexpr int REGION_SIZE = 32;        // Chunks per region side
+    static constexpr int MAX_OPEN_REGIONS = 16;   // Least recently used regions are closed beyond this
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t rejected = 0;  // Records that failed the key/bounds/checksum checks
+        uint64_t writes = 0;
+    };
+
+    // Region files from a different dataVersion are discarded when opened
+    ChunkCache(const std::string& directory, uint32_t dataVersion);
+    ~ChunkCache();
+
+    ChunkCache(const ChunkCache&) = delete;
+    ChunkCache& operator=(const ChunkCache&) = delete;
+
+    bool isEnabled() const { return enabled; }
+
+    // Copy the record stored for a chunk key into out. Safe to call from worker threads.
+    bool read(int chunkX, int chunkZ, uint64_t chunkKey, std::vector<uint8_t>& out);
+
+    // Store (or replace) the record for a chunk key
+    bool write(int chunkX, int chunkZ, uint64_t chunkKey, const std::vector<uint8_t>& data);
+
+    Stats getStats() const;
+
+    // FNV-1a, used for the record checksums
+    static uint32_t checksum(const uint8_t* data, size_t size);
+
+private:
+    struct Region;
+
+    Region* openRegion(int regionX, int regionZ);
+    void closeRegion(Region& region);
+    bool mapRegion(Region& region);
+    void evictRegions();
+
+    std::string directory;
+    uint32_t dataVersion;
+    bool enabled = false;
+
+    std::unordered_map<uint64_t, std::unique_ptr<Region>> regions;
+    uint64_t useCounter = 0;
+    Stats stats;
+    mutable std::mutex mutex;
+};
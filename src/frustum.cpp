@@ -0,0 +1,137 @@
+#include "frustum.h"
+#include "simd.h"
+#include <cmath>
+
+namespace {
+
+// Spheres [begin, end) in batches of V::kWidth; end - begin must be a multiple of the width
+template <typename V>
+size_t cullSpheresRange(const Frustum& frustum, const SphereBounds& spheres, size_t begin, size_t end, uint8_t* visible) {
+    using namespace Simd;
+    constexpr int W = V::kWidth;
+    size_t visibleCount = 0;
+
+    for (size_t i = begin; i < end; i += W) {
+        const V x = V::load(&spheres.x[i]);
+        const V y = V::load(&spheres.y[i]);
+        const V z = V::load(&spheres.z[i]);
+        const V negRadius = V(0.0f) - V::load(&spheres.radius[i]);
+
+        int outside = 0;
+        for (const auto& plane : frustum.planes) {
+            V distance = x * V(plane[0]) + y * V(plane[1]) + z * V(plane[2]) + V(plane[3]);
+            outside |= bitmask(lessThan(distance, negRadius));
+        }
+
+        for (int lane = 0; lane < W; lane++) {
+            uint8_t inside = ((outside >> lane) & 1) ? 0 : 1;
+            visible[i + lane] = inside;
+            visibleCount += inside;
+        }
+    }
+    return visibleCount;
+}
+
+// Boxes are tested against each plane with their most positive corner along the plane normal
+template <typename V>
+size_t cullBoxesRange(const Frustum& frustum, const BoxBounds& boxes, size_t begin, size_t end, uint8_t* visible) {
+    using namespace Simd;
+    constexpr int W = V::kWidth;
+    size_t visibleCount = 0;
+
+    for (size_t i = begin; i < end; i += W) {
+        int outside = 0;
+        for (const auto& plane : frustum.planes) {
+            const V x = V::load(plane[0] >= 0.0f ? &boxes.maxX[i] : &boxes.minX[i]);
+            const V y = V::load(plane[1] >= 0.0f ? &boxes.maxY[i] : &boxes.minY[i]);
+            const V z = V::load(plane[2] >= 0.0f ? &boxes.maxZ[i] : &boxes.minZ[i]);
+            V distance = x * V(plane[0]) + y * V(plane[1]) + z * V(plane[2]) + V(plane[3]);
+            outside |= bitmask(lessThan(distance, V(0.0f)));
+        }
+
+        for (int lane = 0; lane < W; lane++) {
+            uint8_t inside = ((outside >> lane) & 1) ? 0 : 1;
+            visible[i + lane] = inside;
+            visibleCount += inside;
+        }
+    }
+    return visibleCount;
+}
+
+} // namespace
+
+void Frustum::extract(const float* viewProj, bool homogeneousDepth) {
+    // Clip coordinates are v * viewProj, so each clip axis is a column of the matrix
+    auto column = [viewProj](int j, int row) { return viewProj[row * 4 + j]; };
+
+    for (int row = 0; row < 4; row++) {
+        planes[0][row] = column(3, row) + column(0, row);  // Left
+        planes[1][row] = column(3, row) - column(0, row);  // Right
+        planes[2][row] = column(3, row) + column(1, row);  // Bottom
+        planes[3][row] = column(3, row) - column(1, row);  // Top
+        planes[4][row] = homogeneousDepth ? column(3, row) + column(2, row) : column(2, row);  // Near
+        planes[5][row] = column(3, row) - column(2, row);  // Far
+    }
+
+    // Normalize so plane distances are in world units (needed for sphere radii)
+    for (auto& plane : planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (float& value : plane) {
+                value /= length;
+            }
+        }
+    }
+}
+
+void SphereBounds::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void SphereBounds::add(float centerX, float centerY, float centerZ, float sphereRadius) {
+    x.push_back(centerX);
+    y.push_back(centerY);
+    z.push_back(centerZ);
+    radius.push_back(sphereRadius);
+}
+
+size_t SphereBounds::cull(const Frustum& frustum, std::vector<uint8_t>& visible) const {
+    const size_t count = size();
+    const size_t batched = count - count % Simd::SimdFloat::kWidth;
+    visible.resize(count);
+
+    size_t visibleCount = cullSpheresRange<Simd::SimdFloat>(frustum, *this, 0, batched, visible.data());
+    visibleCount += cullSpheresRange<Simd::ScalarFloat>(frustum, *this, batched, count, visible.data());
+    return visibleCount;
+}
+
+void BoxBounds::clear() {
+    minX.clear();
+    minY.clear();
+    minZ.clear();
+    maxX.clear();
+    maxY.clear();
+    maxZ.clear();
+}
+
+void BoxBounds::add(float x0, float y0, float z0, float x1, float y1, float z1) {
+    minX.push_back(x0);
+    minY.push_back(y0);
+    minZ.push_back(z0);
+    maxX.push_back(x1);
+    maxY.push_back(y1);
+    maxZ.push_back(z1);
+}
+
+size_t BoxBounds::cull(const Frustum& frustum, std::vector<uint8_t>& visible) const {
+    const size_t count = size();
+    const size_t batched = count - count % Simd::SimdFloat::kWidth;
+    visible.resize(count);
+
+    size_t visibleCount = cullBoxesRange<Simd::SimdFloat>(frustum, *this, 0, batched, visible.data());
+    visibleCount += cullBoxesRange<Simd::ScalarFloat>(frustum, *this, batched, count, visible.data());
+    return visibleCount;
+}
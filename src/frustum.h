@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// View frustum as six normalized planes (a*x + b*y + c*z + d >= 0 inside)
+struct Frustum {
+    float planes[6][4];
+
+    // viewProj = view * proj in bx's row-vector convention (bx::mtxMul(viewProj, view, proj))
+    void extract(const float* viewProj, bool homogeneousDepth);
+};
+
+// Bounding spheres stored as separate arrays so they can be tested a SIMD batch at a time
+struct SphereBounds {
+    std::vector<float> x, y, z, radius;
+
+    void clear();
+    void add(float centerX, float centerY, float centerZ, float sphereRadius);
+    size_t size() const { return x.size(); }
+
+    // visible[i] = 1 if sphere i intersects the frustum; returns the visible count
+    size_t cull(const Frustum& frustum, std::vector<uint8_t>& visible) const;
+};
+
+// Axis-aligned boxes, same layout idea as SphereBounds
+struct BoxBounds {
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    void clear();
+    void add(float x0, float y0, float z0, float x1, float y1, float z1);
+    size_t size() const { return minX.size(); }
+
+    size_t cull(const Frustum& frustum, std::vector<uint8_t>& visible) const;
+};
+
+// Per-frame visibility counts shown in the debug overlay
+struct CullStats {
+    int submitted = 0;
+    int culled = 0;
+};
@@ -0,0 +1,248 @@
+#include "height_pyramid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int SAMPLE_ROW = HeightPyramid::CELLS + 1;
+
+int getBlocksPerSide(int level) {
+    return (HeightPyramid::CELLS / 2) >> level;
+}
+
+// Index of a level's first block in minSteps/maxSteps
+int getLevelOffset(int level) {
+    int offset = 0;
+    for (int l = 0; l < level; l++) {
+        offset += getBlocksPerSide(l) * getBlocksPerSide(l);
+    }
+    return offset;
+}
+
+// Barycentric slack so rays through shared edges and vertices hit one of the triangles
+constexpr float EDGE_EPSILON = 1e-5f;
+
+struct RayQuery {
+    const std::vector<uint16_t>& samples;
+    const HeightPyramid& pyramid;
+    float minHeight;
+    float heightScale;
+    float origin[3];
+    float direction[3];
+    float tMin;
+    float tMax;
+};
+
+// Clip [t0, t1] to the part of the ray inside the box; false if nothing is left
+bool clipToBox(const RayQuery& query, const float boxMin[3], const float boxMax[3], float& t0, float& t1) {
+    for (int axis = 0; axis < 3; axis++) {
+        float o = query.origin[axis];
+        float d = query.direction[axis];
+        if (std::fabs(d) < 1e-12f) {
+            if (o < boxMin[axis] || o > boxMax[axis]) return false;
+            continue;
+        }
+        float inv = 1.0f / d;
+        float near = (boxMin[axis] - o) * inv;
+        float far = (boxMax[axis] - o) * inv;
+        if (near > far) std::swap(near, far);
+        t0 = std::max(t0, near);
+        t1 = std::min(t1, far);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+// Moller-Trumbore, two-sided
+bool intersectTriangle(const RayQuery& query, const float a[3], const float b[3], const float c[3], float& t) {
+    const float* o = query.origin;
+    const float* d = query.direction;
+    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    float p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+    float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (std::fabs(det) < 1e-12f) return false;
+
+    float invDet = 1.0f / det;
+    float s[3] = {o[0] - a[0], o[1] - a[1], o[2] - a[2]};
+    float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+    if (u < -EDGE_EPSILON || u > 1.0f + EDGE_EPSILON) return false;
+
+    float q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+    float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+    if (v < -EDGE_EPSILON || u + v > 1.0f + EDGE_EPSILON) return false;
+
+    t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+    return t >= query.tMin && t <= query.tMax;
+}
+
+// Exact test against the two triangles of one grid cell
+bool intersectCell(const RayQuery& query, int x, int z, float& tHit) {
+    auto vertex = [&query](int vx, int vz, float* out) {
+        out[0] = (float)vx;
+        out[1] = query.minHeight + query.samples[vz * SAMPLE_ROW + vx] * query.heightScale;
+        out[2] = (float)vz;
+    };
+    float topLeft[3], topRight[3], bottomLeft[3], bottomRight[3];
+    vertex(x, z, topLeft);
+    vertex(x + 1, z, topRight);
+    vertex(x, z + 1, bottomLeft);
+    vertex(x + 1, z + 1, bottomRight);
+
+    bool hit = false;
+    float t;
+    if (intersectTriangle(query, topLeft, bottomLeft, topRight, t)) {
+        tHit = t;
+        hit = true;
+    }
+    if (intersectTriangle(query, topRight, bottomLeft, bottomRight, t) && (!hit || t < tHit)) {
+        tHit = t;
+        hit = true;
+    }
+    return hit;
+}
+
+// Step range covered by a block (level >= 0) or a single cell (level -1)
+void getBlockSteps(const RayQuery& query, int level, int blockX, int blockZ, int levelOffset, uint16_t& lo, uint16_t& hi) {
+    if (level < 0) {
+        uint16_t a = query.samples[blockZ * SAMPLE_ROW + blockX];
+        uint16_t b = query.samples[blockZ * SAMPLE_ROW + blockX + 1];
+        uint16_t c = query.samples[(blockZ + 1) * SAMPLE_ROW + blockX];
+        uint16_t d = query.samples[(blockZ + 1) * SAMPLE_ROW + blockX + 1];
+        lo = std::min(std::min(a, b), std::min(c, d));
+        hi = std::max(std::max(a, b), std::max(c, d));
+        return;
+    }
+    size_t index = (size_t)levelOffset + blockZ * getBlocksPerSide(level) + blockX;
+    lo = query.pyramid.minSteps[index];
+    hi = query.pyramid.maxSteps[index];
+}
+
+// Ray interval through a block, or false if the ray misses its bounding box
+bool clipToBlock(const RayQuery& query, int level, int blockX, int blockZ, int levelOffset, float& t0, float& t1) {
+    uint16_t lo, hi;
+    getBlockSteps(query, level, blockX, blockZ, levelOffset, lo, hi);
+
+    // Half a step of padding covers rounding in the triangle test
+    int size = level < 0 ? 1 : (2 << level);
+    float boxMin[3] = {(float)(blockX * size), query.minHeight + (lo - 0.5f) * query.heightScale - 1e-4f, (float)(blockZ * size)};
+    float boxMax[3] = {(float)((blockX + 1) * size), query.minHeight + (hi + 0.5f) * query.heightScale + 1e-4f, (float)((blockZ + 1) * size)};
+    t0 = query.tMin;
+    t1 = query.tMax;
+    return clipToBox(query, boxMin, boxMax, t0, t1);
+}
+
+// Visit the children of a block nearest-first; the first hit is the nearest because
+// children don't overlap in x/z
+bool traverseBlock(const RayQuery& query, int level, int blockX, int blockZ, float& tHit) {
+    if (level < 0) {
+        return intersectCell(query, blockX, blockZ, tHit);
+    }
+
+    struct Child {
+        int x, z;
+        float tEnter;
+    };
+    Child children[4];
+    int childCount = 0;
+    int childLevel = level - 1;
+    int childOffset = childLevel < 0 ? 0 : getLevelOffset(childLevel);
+
+    for (int i = 0; i < 4; i++) {
+        int childX = blockX * 2 + (i & 1);
+        int childZ = blockZ * 2 + (i >> 1);
+        float t0, t1;
+        if (!clipToBlock(query, childLevel, childX, childZ, childOffset, t0, t1)) continue;
+
+        // Insertion sort by entry distance
+        int slot = childCount++;
+        while (slot > 0 && children[slot - 1].tEnter > t0) {
+            children[slot] = children[slot - 1];
+            slot--;
+        }
+        children[slot] = {childX, childZ, t0};
+    }
+
+    for (int i = 0; i < childCount; i++) {
+        if (traverseBlock(query, childLevel, children[i].x, children[i].z, tHit)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void HeightPyramid::build(const std::vector<uint16_t>& samples) {
+    const size_t blockCount = getLevelOffset(LEVEL_COUNT);
+    minSteps.assign(blockCount, 0);
+    maxSteps.assign(blockCount, 0);
+    if (samples.size() < (size_t)(SAMPLE_ROW * SAMPLE_ROW)) return;
+
+    const int baseBlocks = getBlocksPerSide(0);
+    updateBlocks(samples, 0, 0, baseBlocks - 1, baseBlocks - 1);
+}
+
+void HeightPyramid::update(const std::vector<uint16_t>& samples, int x0, int z0, int x1, int z1) {
+    if (minSteps.empty() || samples.size() < (size_t)(SAMPLE_ROW * SAMPLE_ROW)) return;
+
+    // Level-0 block b covers samples 2b to 2b + 2, so a sample can sit in two blocks
+    const int baseBlocks = getBlocksPerSide(0);
+    updateBlocks(samples, std::max(0, (x0 - 1) / 2), std::max(0, (z0 - 1) / 2),
+                 std::min(baseBlocks - 1, x1 / 2), std::min(baseBlocks - 1, z1 / 2));
+}
+
+void HeightPyramid::updateBlocks(const std::vector<uint16_t>& samples, int blockX0, int blockZ0, int blockX1, int blockZ1) {
+    // Level 0: the 3x3 samples of each 2x2-cell block
+    const int baseBlocks = getBlocksPerSide(0);
+    for (int blockZ = blockZ0; blockZ <= blockZ1; blockZ++) {
+        for (int blockX = blockX0; blockX <= blockX1; blockX++) {
+            uint16_t lo = 65535, hi = 0;
+            for (int z = blockZ * 2; z <= blockZ * 2 + 2; z++) {
+                for (int x = blockX * 2; x <= blockX * 2 + 2; x++) {
+                    lo = std::min(lo, samples[z * SAMPLE_ROW + x]);
+                    hi = std::max(hi, samples[z * SAMPLE_ROW + x]);
+                }
+            }
+            minSteps[blockZ * baseBlocks + blockX] = lo;
+            maxSteps[blockZ * baseBlocks + blockX] = hi;
+        }
+    }
+
+    // Each coarser block bounds its four children
+    for (int level = 1; level < LEVEL_COUNT; level++) {
+        const int blocks = getBlocksPerSide(level);
+        const int childBlocks = getBlocksPerSide(level - 1);
+        const int offset = getLevelOffset(level);
+        const int childOffset = getLevelOffset(level - 1);
+        blockX0 >>= 1;
+        blockZ0 >>= 1;
+        blockX1 >>= 1;
+        blockZ1 >>= 1;
+        for (int blockZ = blockZ0; blockZ <= blockZ1; blockZ++) {
+            for (int blockX = blockX0; blockX <= blockX1; blockX++) {
+                uint16_t lo = 65535, hi = 0;
+                for (int i = 0; i < 4; i++) {
+                    int child = childOffset + (blockZ * 2 + (i >> 1)) * childBlocks + blockX * 2 + (i & 1);
+                    lo = std::min(lo, minSteps[child]);
+                    hi = std::max(hi, maxSteps[child]);
+                }
+                minSteps[offset + blockZ * blocks + blockX] = lo;
+                maxSteps[offset + blockZ * blocks + blockX] = hi;
+            }
+        }
+    }
+}
+
+bool HeightPyramid::raycast(const std::vector<uint16_t>& samples, float minHeight, float heightScale,
+                            const float origin[3], const float direction[3], float tMin, float tMax, float& tHit) const {
+    if (minSteps.empty() || samples.size() < (size_t)(SAMPLE_ROW * SAMPLE_ROW)) return false;
+
+    RayQuery query = {samples, *this, minHeight, heightScale,
+                      {origin[0], origin[1], origin[2]}, {direction[0], direction[1], direction[2]}, tMin, tMax};
+
+    const int rootLevel = LEVEL_COUNT - 1;
+    float t0, t1;
+    if (!clipToBlock(query, rootLevel, 0, 0, getLevelOffset(rootLevel), t0, t1)) return false;
+    return traverseBlock(query, rootLevel, 0, 0, tHit);
+}
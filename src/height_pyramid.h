@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Min/max bounds over power-of-two blocks of a chunk's height grid, used to skip empty
+// space when casting rays against the terrain.
+//
+// Level 0 bounds 2x2-cell blocks, each level up doubles the block size until one block
+// covers the chunk. Single cells are bounded by their own four samples, so they aren't
+// stored. Values are in the quantization steps of the samples the pyramid was built from.
+struct HeightPyramid {
+    static constexpr int CELLS = 64;         // Cells per side, samples are (CELLS + 1)^2
+    static constexpr int LEVEL_COUNT = 6;    // Blocks of 2, 4, ... 64 cells
+
+    std::vector<uint16_t> minSteps;  // All levels, finest first, row-major within a level
+    std::vector<uint16_t> maxSteps;
+
+    void build(const std::vector<uint16_t>& samples);
+
+    // Refresh the blocks over samples [x0, x1] x [z0, z1] after they changed
+    void update(const std::vector<uint16_t>& samples, int x0, int z0, int x1, int z1);
+    size_t getMemoryBytes() const { return (minSteps.capacity() + maxSteps.capacity()) * sizeof(uint16_t); }
+
+    // First intersection of a ray with the triangulated height grid for t in [tMin, tMax].
+    // Origin and direction are in grid space: x/z in cells from the chunk corner, y in the
+    // same units as minHeight + step * heightScale. Cells are split along the
+    // (x + 1, z) - (x, z + 1) diagonal, matching TerrainChunk::generateIndices.
+    bool raycast(const std::vector<uint16_t>& samples, float minHeight, float heightScale,
+                 const float origin[3], const float direction[3], float tMin, float tMax, float& tHit) const;
+
+private:
+    // Recompute level-0 blocks [blockX0, blockX1] x [blockZ0, blockZ1] and their ancestors
+    void updateBlocks(const std::vector<uint16_t>& samples, int blockX0, int blockZ0, int blockX1, int blockZ1);
+};
@@ -0,0 +1,84 @@
+#include "height_tile_cache.h"
+#include "terrain_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int TILE_SAMPLES = HeightTileCache::TILE_CELLS + 1;
+
+uint64_t getTileKey(int tileX, int tileZ) {
+    return ((uint64_t)(uint32_t)tileX << 32) | (uint32_t)tileZ;
+}
+
+} // namespace
+
+HeightTileCache::HeightTileCache(float gridScale)
+    : gridScale(gridScale), tileWorldSize(TILE_CELLS * CELL_STRIDE * gridScale) {}
+
+float HeightTileCache::getHeightAt(float worldX, float worldZ) {
+    int tileX = (int)std::floor(worldX / tileWorldSize);
+    int tileZ = (int)std::floor(worldZ / tileWorldSize);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const Tile& tile = getTile(tileX, tileZ);
+
+    // Position in coarse cells from the tile corner
+    const float cellWorldSize = CELL_STRIDE * gridScale;
+    float localX = (worldX - tileX * tileWorldSize) / cellWorldSize;
+    float localZ = (worldZ - tileZ * tileWorldSize) / cellWorldSize;
+    int x1 = std::min(std::max((int)localX, 0), TILE_CELLS - 1);
+    int z1 = std::min(std::max((int)localZ, 0), TILE_CELLS - 1);
+    float fx = localX - x1;
+    float fz = localZ - z1;
+
+    float h1 = tile.heights[z1 * TILE_SAMPLES + x1];
+    float h2 = tile.heights[z1 * TILE_SAMPLES + x1 + 1];
+    float h3 = tile.heights[(z1 + 1) * TILE_SAMPLES + x1];
+    float h4 = tile.heights[(z1 + 1) * TILE_SAMPLES + x1 + 1];
+
+    float top = h1 * (1 - fx) + h2 * fx;
+    float bottom = h3 * (1 - fx) + h4 * fx;
+    return top * (1 - fz) + bottom * fz;
+}
+
+const HeightTileCache::Tile& HeightTileCache::getTile(int tileX, int tileZ) {
+    uint64_t key = getTileKey(tileX, tileZ);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        tiles.splice(tiles.begin(), tiles, found->second);
+        stats.hits++;
+        return tiles.front();
+    }
+
+    if (tiles.size() >= (size_t)MAX_TILES) {
+        index.erase(getTileKey(tiles.back().tileX, tiles.back().tileZ));
+        tiles.pop_back();
+    }
+
+    // A coarse grid is just the terrain grid sampled with a larger scale
+    Tile tile;
+    tile.tileX = tileX;
+    tile.tileZ = tileZ;
+    tile.heights.resize(TILE_SAMPLES * TILE_SAMPLES);
+    TerrainKernel::generateHeights(tileX * TILE_CELLS, tileZ * TILE_CELLS, TILE_SAMPLES, CELL_STRIDE * gridScale,
+                                   tile.heights.data());
+
+    tiles.push_front(std::move(tile));
+    index[key] = tiles.begin();
+    stats.misses++;
+    return tiles.front();
+}
+
+void HeightTileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    tiles.clear();
+    index.clear();
+}
+
+HeightTileCache::Stats HeightTileCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = stats;
+    result.tiles = tiles.size();
+    return result;
+}
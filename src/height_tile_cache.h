@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Terrain heights for positions no loaded chunk covers. The heightfield is a pure function
+// of world position, so it is evaluated straight from TerrainKernel on a coarse grid and
+// kept in a small LRU cache of tiles. Heights are bilinear over the coarse grid, so they
+// can differ from the full-resolution chunk mesh by a fraction of a unit on steep ground.
+class HeightTileCache {
+public:
+    static constexpr int TILE_CELLS = 16;   // Coarse cells per tile side, samples are (TILE_CELLS + 1)^2
+    static constexpr int CELL_STRIDE = 4;   // Terrain grid vertices per coarse cell
+    static constexpr int MAX_TILES = 256;   // Least recently used tiles are dropped beyond this
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;  // Tiles generated
+        size_t tiles = 0;
+    };
+
+    // gridScale is the world size of one terrain grid cell (TerrainChunk::SCALE)
+    explicit HeightTileCache(float gridScale);
+
+    // Safe to call from any thread
+    float getHeightAt(float worldX, float worldZ);
+
+    void clear();
+    Stats getStats() const;
+
+private:
+    struct Tile {
+        int tileX, tileZ;
+        std::vector<float> heights;
+    };
+
+    const Tile& getTile(int tileX, int tileZ);
+
+    float gridScale;
+    float tileWorldSize;
+
+    std::list<Tile> tiles;  // Most recently used first
+    std::unordered_map<uint64_t, std::list<Tile>::iterator> index;
+    Stats stats;
+    mutable std::mutex mutex;
+};
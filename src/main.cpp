@@ -16,33 +16,10 @@
 #include <string>
 #include <memory>
 
-// Define STB_IMAGE_IMPLEMENTATION before including to create the implementation
-#define STB_IMAGE_IMPLEMENTATION
+// Image loading for textures; the single-header implementations live in third_party.cpp
 #include "stb_image.h"
-
-// Define TINYGLTF_IMPLEMENTATION and required flags once in the project
-#define TINYGLTF_IMPLEMENTATION
-#define TINYGLTF_NO_STB_IMAGE
-#define TINYGLTF_NO_STB_IMAGE_WRITE
-#include "tiny_gltf.h"
 #include "json.hpp"
 
-// Provide stub implementations for TinyGLTF image functions since we disabled STB_IMAGE in TinyGLTF
-namespace tinygltf {
-    bool LoadImageData(Image* image, const int image_idx, std::string* err, std::string* warn,
-                      int req_width, int req_height, const unsigned char* bytes, int size, void* user_data) {
-        // This is handled by our custom image loader in the model loading code
-        return false; // Return false to indicate we're not handling it here
-    }
-    
-    bool WriteImageData(const std::string* basepath, const std::string* filename,
-                       const Image* image, bool embedImages, const FsCallbacks* fs, 
-                       const URICallbacks* uri_cb, std::string* out_uri, void* user_data) {
-        // We don't support writing images
-        return false;
-    }
-}
-
 // Include our model system
 #include "model.h"
 #include "skills.h"
@@ -52,6 +29,9 @@ namespace tinygltf {
 #include "camera.h"
 #include "ui.h"
 #include "ozz_animation.h"
+#include "animation_stage.h"
+#include "skin_palette.h"
+#include "terrain.h"
 
 // Window dimensions
 const int WINDOW_WIDTH = 800;
@@ -267,923 +247,6 @@ static const uint16_t texCubeIndices[] = {
     20, 21, 22, 21, 23, 22
 };
 
-// Biome system
-enum class BiomeType {
-    DESERT,      // Flat, sandy, minimal height variation
-    MOUNTAINS,   // High elevation, steep terrain  
-    SWAMP,       // Low, flat, some water areas
-    GRASSLAND    // Rolling hills, moderate variation
-};
-
-// Forward declarations for biome texture functions
-bgfx::TextureHandle create_biome_texture(BiomeType biome);
-
-// Terrain system
-struct TerrainVertex {
-    float x, y, z;
-    float u, v;
-};
-
-// Global ocean/water constants
-static constexpr float SEA_LEVEL = 1.0f;  // Y coordinate for water surface
-static constexpr float OCEAN_DEPTH_SCALE = 0.3f;  // How much to flatten terrain underwater
-
-class TerrainChunk {
-public:
-    static constexpr int CHUNK_SIZE = 64;
-    static constexpr float SCALE = 0.5f;
-    static constexpr float HEIGHT_SCALE = 3.0f;
-    
-    BiomeType biome;
-    int chunkX, chunkZ;  // Chunk coordinates in world space
-    std::vector<TerrainVertex> vertices;
-    std::vector<uint16_t> indices;
-    bgfx::VertexBufferHandle vbh;
-    bgfx::IndexBufferHandle ibh;
-    bgfx::TextureHandle texture;  // Biome-specific texture
-    
-    // Water plane data
-    bool hasWater;  // Does this chunk need water rendering?
-    std::vector<TerrainVertex> waterVertices;
-    std::vector<uint16_t> waterIndices;
-    bgfx::VertexBufferHandle waterVbh;
-    bgfx::IndexBufferHandle waterIbh;
-    
-    TerrainChunk(int cx, int cz, BiomeType biomeType) 
-        : chunkX(cx), chunkZ(cz), biome(biomeType), hasWater(false) {
-        vbh = BGFX_INVALID_HANDLE;
-        ibh = BGFX_INVALID_HANDLE;
-        texture = BGFX_INVALID_HANDLE;
-        waterVbh = BGFX_INVALID_HANDLE;
-        waterIbh = BGFX_INVALID_HANDLE;
-    }
-    
-    ~TerrainChunk() {
-        if (bgfx::isValid(vbh)) bgfx::destroy(vbh);
-        if (bgfx::isValid(ibh)) bgfx::destroy(ibh);
-        if (bgfx::isValid(texture)) bgfx::destroy(texture);
-        if (bgfx::isValid(waterVbh)) bgfx::destroy(waterVbh);
-        if (bgfx::isValid(waterIbh)) bgfx::destroy(waterIbh);
-    }
-    
-    void generate() {
-        vertices.clear();
-        indices.clear();
-        waterVertices.clear();
-        waterIndices.clear();
-        hasWater = false;
-        
-        // Generate vertices with biome-specific terrain
-        generateBiomeTerrain();
-        generateIndices();
-        
-        // Check if this chunk needs water and generate water plane if needed
-        checkAndGenerateWater();
-        
-        // Validate chunk geometry
-        validateChunkGeometry();
-        
-        std::cout << "Generated " << getBiomeName() << " chunk (" << chunkX << ", " << chunkZ 
-                  << ") with " << vertices.size() << " vertices";
-        if (hasWater) {
-            std::cout << " (has water)";
-        }
-        std::cout << std::endl;
-    }
-    
-private:
-    // Global noise function that works across chunk boundaries
-    float getGlobalNoise(float worldX, float worldZ) const {
-        // Multiple octaves of noise for better variation
-        float noise = 0.0f;
-        
-        // Large scale features (octave 1)
-        noise += bx::sin(worldX * 0.01f) * bx::cos(worldZ * 0.012f) * 1.0f;
-        
-        // Medium scale features (octave 2)  
-        noise += bx::sin(worldX * 0.03f + worldZ * 0.02f) * 0.5f;
-        
-        // Fine detail (octave 3)
-        noise += bx::sin(worldX * 0.08f) * bx::cos(worldZ * 0.075f) * 0.25f;
-        
-        // Very fine detail (octave 4)
-        noise += bx::sin(worldX * 0.15f + worldZ * 0.12f) * 0.125f;
-        
-        return noise * 0.4f; // Scale down total amplitude
-    }
-    
-    void generateBiomeTerrain() {
-        // Generate vertices using global world coordinates for seamless transitions
-        
-        // Generate vertices with biome-specific height patterns
-        // Generate vertices including one extra row/column for seamless stitching
-        for (int z = 0; z <= CHUNK_SIZE; z++) {
-            for (int x = 0; x <= CHUNK_SIZE; x++) {
-                // Calculate world position for this chunk vertex
-                float worldX = (chunkX * CHUNK_SIZE + x) * SCALE;
-                float worldZ = (chunkZ * CHUNK_SIZE + z) * SCALE;
-                
-                // Use global noise for seamless chunk transitions
-                float globalNoise = getGlobalNoise(worldX, worldZ);
-                float height = generateBiomeHeight(globalNoise, worldX, worldZ);
-                
-                TerrainVertex vertex;
-                vertex.x = worldX;
-                vertex.y = height;
-                vertex.z = worldZ;
-                vertex.u = float(x) / CHUNK_SIZE;
-                vertex.v = float(z) / CHUNK_SIZE;
-                
-                vertices.push_back(vertex);
-            }
-        }
-    }
-    
-    float generateBiomeHeight(float baseNoise, float worldX, float worldZ) {
-        // Add secondary global noise layers for more detail (using world coordinates)
-        float detailNoise1 = bx::sin(worldX * 0.05f) * bx::cos(worldZ * 0.04f);
-        float detailNoise2 = bx::sin(worldX * 0.12f + worldZ * 0.1f);
-        float fineNoise = bx::sin(worldX * 0.25f) * bx::cos(worldZ * 0.22f);
-        
-        // Calculate biome influence at this exact world position for smooth blending
-        float biomeNoise = bx::sin(worldX * 0.001f) * bx::cos(worldZ * 0.0008f);
-        biomeNoise += bx::sin(worldX * 0.0005f + worldZ * 0.0007f) * 0.3f;
-        
-        // Add ocean areas using large-scale noise
-        float oceanNoise = bx::sin(worldX * 0.0003f) * bx::cos(worldZ * 0.0004f);
-        oceanNoise += bx::sin(worldX * 0.0002f + worldZ * 0.0003f) * 0.5f;
-        bool isOceanArea = oceanNoise < -0.6f;  // Specific areas are oceans
-        
-        // Calculate weights for each biome based on distance from thresholds
-        float swampWeight = 1.0f - bx::clamp((biomeNoise + 0.3f) / 0.4f, 0.0f, 1.0f);  // Strong below -0.3
-        float desertWeight = bx::max(0.0f, 1.0f - bx::abs(biomeNoise + 0.2f) / 0.2f);    // Peak at -0.2
-        float grasslandWeight = bx::max(0.0f, 1.0f - bx::abs(biomeNoise - 0.05f) / 0.3f); // Peak at 0.05  
-        float mountainWeight = bx::clamp((biomeNoise - 0.1f) / 0.3f, 0.0f, 1.0f);        // Strong above 0.2
-        
-        // Normalize weights so they sum to 1.0
-        float totalWeight = swampWeight + desertWeight + grasslandWeight + mountainWeight;
-        if (totalWeight > 0.0f) {
-            swampWeight /= totalWeight;
-            desertWeight /= totalWeight;
-            grasslandWeight /= totalWeight;
-            mountainWeight /= totalWeight;
-        }
-        
-        // Calculate height for each biome type
-        // Swamps: Low wetlands, oscillating around sea level for patches of water and land
-        float swampVariation = bx::sin(worldX * 0.08f) * bx::cos(worldZ * 0.07f) * 0.8f; // Create patchy wetlands
-        float swampHeight = baseNoise * HEIGHT_SCALE * 0.2f + swampVariation + detailNoise2 * HEIGHT_SCALE * 0.1f + 0.5f;
-        
-        // Deserts: Dry, above sea level with dunes
-        float desertHeight = baseNoise * HEIGHT_SCALE * 1.2f + detailNoise1 * HEIGHT_SCALE * 0.3f + fineNoise * HEIGHT_SCALE * 0.1f + 3.0f;
-        
-        // Grasslands: Rolling hills, can have some low areas near water
-        float grasslandHeight = baseNoise * HEIGHT_SCALE * 1.5f + detailNoise1 * HEIGHT_SCALE * 0.8f + detailNoise2 * HEIGHT_SCALE * 0.4f + fineNoise * HEIGHT_SCALE * 0.2f + 2.0f;
-        
-        // Mountains: High elevation, only deep valleys might have water
-        float mountainHeight = (baseNoise + 0.2f) * HEIGHT_SCALE * 2.5f + detailNoise1 * HEIGHT_SCALE * 1.2f + detailNoise2 * HEIGHT_SCALE * 0.6f + fineNoise * HEIGHT_SCALE * 0.3f + 10.0f;
-        
-        // Blend heights based on biome weights for seamless transitions
-        float blendedHeight = swampHeight * swampWeight + desertHeight * desertWeight + grasslandHeight * grasslandWeight + mountainHeight * mountainWeight;
-        
-        // If this is an ocean area, create underwater terrain
-        if (isOceanArea) {
-            // Ocean floor is below sea level
-            float oceanDepth = 3.0f + baseNoise * 2.0f + detailNoise1 * 0.5f;
-            blendedHeight = SEA_LEVEL - oceanDepth;
-        }
-        
-        // Apply underwater flattening - terrain below sea level gets progressively flatter
-        if (blendedHeight < SEA_LEVEL) {
-            float depthBelowSeaLevel = SEA_LEVEL - blendedHeight;
-            float flatteningFactor = 1.0f - bx::min(depthBelowSeaLevel * OCEAN_DEPTH_SCALE, 0.8f);
-            blendedHeight = SEA_LEVEL - (depthBelowSeaLevel * flatteningFactor);
-        }
-        
-        return blendedHeight;
-    }
-    
-    void generateIndices() {
-        // Generate indices for triangles with new vertex grid size
-        const int vertexRowSize = CHUNK_SIZE + 1; // Account for extra row/column
-        
-        for (int z = 0; z < CHUNK_SIZE; z++) {
-            for (int x = 0; x < CHUNK_SIZE; x++) {
-                int topLeft = z * vertexRowSize + x;
-                int topRight = z * vertexRowSize + (x + 1);
-                int bottomLeft = (z + 1) * vertexRowSize + x;
-                int bottomRight = (z + 1) * vertexRowSize + (x + 1);
-                
-                indices.push_back(topLeft);
-                indices.push_back(bottomLeft);
-                indices.push_back(topRight);
-                
-                indices.push_back(topRight);
-                indices.push_back(bottomLeft);
-                indices.push_back(bottomRight);
-            }
-        }
-    }
-    
-    void checkAndGenerateWater() {
-        // Check if any terrain vertices are below sea level
-        hasWater = false;
-        for (const auto& vertex : vertices) {
-            if (vertex.y < SEA_LEVEL) {
-                hasWater = true;
-                break;
-            }
-        }
-        
-        if (!hasWater) return;
-        
-        // Generate a simple water plane at sea level for this chunk
-        waterVertices.clear();
-        waterIndices.clear();
-        
-        // Create water plane vertices (simple grid at sea level)
-        const int waterResolution = 8; // Lower resolution for water plane
-        const float waterScale = float(CHUNK_SIZE) / float(waterResolution);
-        
-        for (int z = 0; z <= waterResolution; z++) {
-            for (int x = 0; x <= waterResolution; x++) {
-                TerrainVertex waterVertex;
-                waterVertex.x = (chunkX * CHUNK_SIZE + x * waterScale) * SCALE;
-                waterVertex.y = SEA_LEVEL - 5.0f; // Match the terrain offset
-                waterVertex.z = (chunkZ * CHUNK_SIZE + z * waterScale) * SCALE;
-                waterVertex.u = float(x) / waterResolution;
-                waterVertex.v = float(z) / waterResolution;
-                
-                waterVertices.push_back(waterVertex);
-            }
-        }
-        
-        // Generate water indices
-        const int waterVertexRowSize = waterResolution + 1;
-        for (int z = 0; z < waterResolution; z++) {
-            for (int x = 0; x < waterResolution; x++) {
-                int topLeft = z * waterVertexRowSize + x;
-                int topRight = z * waterVertexRowSize + (x + 1);
-                int bottomLeft = (z + 1) * waterVertexRowSize + x;
-                int bottomRight = (z + 1) * waterVertexRowSize + (x + 1);
-                
-                waterIndices.push_back(topLeft);
-                waterIndices.push_back(bottomLeft);
-                waterIndices.push_back(topRight);
-                
-                waterIndices.push_back(topRight);
-                waterIndices.push_back(bottomLeft);
-                waterIndices.push_back(bottomRight);
-            }
-        }
-    }
-    
-    void validateChunkGeometry() {
-        bool hasIssues = false;
-        float minY = 1000000.0f, maxY = -1000000.0f;
-        int invalidVertices = 0;
-        
-        // Check for invalid vertices
-        for (size_t i = 0; i < vertices.size(); i++) {
-            const auto& v = vertices[i];
-            
-            // Check for NaN or infinite values
-            if (!std::isfinite(v.x) || !std::isfinite(v.y) || !std::isfinite(v.z)) {
-                std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") vertex " << i 
-                          << " has invalid position: (" << v.x << ", " << v.y << ", " << v.z << ")" << std::endl;
-                invalidVertices++;
-                hasIssues = true;
-            }
-            
-            // Track height bounds
-            if (std::isfinite(v.y)) {
-                minY = bx::min(minY, v.y);
-                maxY = bx::max(maxY, v.y);
-            }
-            
-            // Check for extreme positions
-            if (bx::abs(v.x) > 10000.0f || bx::abs(v.z) > 10000.0f) {
-                std::cerr << "WARNING: Chunk (" << chunkX << ", " << chunkZ << ") vertex " << i 
-                          << " at extreme position: (" << v.x << ", " << v.y << ", " << v.z << ")" << std::endl;
-                hasIssues = true;
-            }
-        }
-        
-        // Check height range
-        float heightRange = maxY - minY;
-        if (heightRange > 100.0f) {
-            std::cerr << "WARNING: Chunk (" << chunkX << ", " << chunkZ << ") has extreme height range: " 
-                      << minY << " to " << maxY << " (range: " << heightRange << ")" << std::endl;
-            hasIssues = true;
-        }
-        
-        // Check indices
-        for (size_t i = 0; i < indices.size(); i++) {
-            if (indices[i] >= vertices.size()) {
-                std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") index " << i 
-                          << " value " << indices[i] << " exceeds vertex count " << vertices.size() << std::endl;
-                hasIssues = true;
-            }
-        }
-        
-        if (hasIssues) {
-            std::cerr << "CHUNK VALIDATION FAILED for (" << chunkX << ", " << chunkZ << ")" << std::endl;
-        }
-    }
-
-public:
-    const char* getBiomeName() const {
-        switch (biome) {
-            case BiomeType::DESERT: return "Desert";
-            case BiomeType::MOUNTAINS: return "Mountains";
-            case BiomeType::SWAMP: return "Swamp";
-            case BiomeType::GRASSLAND: return "Grassland";
-            default: return "Unknown";
-        }
-    }
-    
-    void createBuffers() {
-        if (vertices.empty() || indices.empty()) {
-            std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") has empty vertices or indices!" << std::endl;
-            std::cerr << "Vertices: " << vertices.size() << ", Indices: " << indices.size() << std::endl;
-            return;
-        }
-        
-        const bgfx::Memory* vertexMem = bgfx::copy(vertices.data(), vertices.size() * sizeof(TerrainVertex));
-        const bgfx::Memory* indexMem = bgfx::copy(indices.data(), indices.size() * sizeof(uint16_t));
-        
-        bgfx::VertexLayout terrainLayout;
-        terrainLayout.begin()
-            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
-            .end();
-        
-        vbh = bgfx::createVertexBuffer(vertexMem, terrainLayout);
-        ibh = bgfx::createIndexBuffer(indexMem);
-        
-        // Check if buffer creation succeeded
-        if (!bgfx::isValid(vbh)) {
-            std::cerr << "ERROR: Failed to create vertex buffer for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-        }
-        if (!bgfx::isValid(ibh)) {
-            std::cerr << "ERROR: Failed to create index buffer for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-        }
-        
-        // Create biome-specific texture
-        texture = create_biome_texture(biome);
-        if (!bgfx::isValid(texture)) {
-            std::cerr << "ERROR: Failed to create texture for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-        } else {
-            std::cout << "Successfully created " << getBiomeName() << " chunk (" << chunkX << ", " << chunkZ 
-                      << ") with " << vertices.size() << " vertices and " << indices.size() << " indices" << std::endl;
-        }
-        
-        // Create water buffers if needed
-        if (hasWater && !waterVertices.empty() && !waterIndices.empty()) {
-            const bgfx::Memory* waterVertexMem = bgfx::copy(waterVertices.data(), waterVertices.size() * sizeof(TerrainVertex));
-            const bgfx::Memory* waterIndexMem = bgfx::copy(waterIndices.data(), waterIndices.size() * sizeof(uint16_t));
-            
-            waterVbh = bgfx::createVertexBuffer(waterVertexMem, terrainLayout);
-            waterIbh = bgfx::createIndexBuffer(waterIndexMem);
-            
-            if (!bgfx::isValid(waterVbh) || !bgfx::isValid(waterIbh)) {
-                std::cerr << "ERROR: Failed to create water buffers for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-            }
-        }
-    }
-    
-    float getHeightAt(float worldX, float worldZ) const {
-        // Convert world coordinates to local chunk coordinates
-        float localX = worldX / SCALE - (chunkX * CHUNK_SIZE);
-        float localZ = worldZ / SCALE - (chunkZ * CHUNK_SIZE);
-        
-        // Clamp to chunk bounds  
-        if (localX < 0 || localX >= CHUNK_SIZE || localZ < 0 || localZ >= CHUNK_SIZE) {
-            return 0.0f;
-        }
-        
-        int x1 = (int)localX;
-        int z1 = (int)localZ;
-        int x2 = bx::min(x1 + 1, CHUNK_SIZE);
-        int z2 = bx::min(z1 + 1, CHUNK_SIZE);
-        
-        float fx = localX - x1;
-        float fz = localZ - z1;
-        
-        // Get heights at four corners (with new vertex row size)
-        const int vertexRowSize = CHUNK_SIZE + 1;
-        float h1 = vertices[z1 * vertexRowSize + x1].y;
-        float h2 = vertices[z1 * vertexRowSize + x2].y;
-        float h3 = vertices[z2 * vertexRowSize + x1].y;
-        float h4 = vertices[z2 * vertexRowSize + x2].y;
-        
-        // Bilinear interpolation
-        float top = h1 * (1 - fx) + h2 * fx;
-        float bottom = h3 * (1 - fx) + h4 * fx;
-        return top * (1 - fz) + bottom * fz;
-    }
-};
-
-// Forward declaration
-void render_object_at_position(bgfx::VertexBufferHandle vbh, bgfx::IndexBufferHandle ibh, 
-                              bgfx::ProgramHandle program, bgfx::TextureHandle texture, 
-                              bgfx::UniformHandle texUniform, const float* modelMatrix);
-
-// Resource node system
-
-// Forward declarations
-
-// Chunk management system
-class ChunkManager {
-public:
-    static constexpr int RENDER_DISTANCE = 2; // Chunks in each direction (5x5 grid)
-    
-private:
-    std::unordered_map<uint64_t, std::unique_ptr<TerrainChunk>> loadedChunks;
-    std::vector<ResourceNode>* worldResourceNodes; // Pointer to global resource nodes
-    std::vector<std::unique_ptr<NPC>>* worldNPCs; // Pointer to global NPCs
-    int playerChunkX = 0;
-    int playerChunkZ = 0;
-    
-    // Helper function to convert chunk coordinates to unique key
-    uint64_t getChunkKey(int chunkX, int chunkZ) const {
-        // Handle negative coordinates properly by treating as signed
-        uint64_t x = static_cast<uint64_t>(static_cast<uint32_t>(chunkX));
-        uint64_t z = static_cast<uint64_t>(static_cast<uint32_t>(chunkZ));
-        return (x << 32) | z;
-    }
-    
-    // Determine biome for a chunk based on its world coordinates
-    BiomeType getBiomeForChunk(int chunkX, int chunkZ) const {
-        return getBiomeAtWorldPos(chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE, 
-                                  chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE);
-    }
-    
-    // Get biome at any world position (used for blending)
-    BiomeType getBiomeAtWorldPos(float worldX, float worldZ) const {
-        // Use very large scale for biome assignment to create big continuous regions
-        float biomeNoise = bx::sin(worldX * 0.001f) * bx::cos(worldZ * 0.0008f);
-        biomeNoise += bx::sin(worldX * 0.0005f + worldZ * 0.0007f) * 0.3f;
-        
-        // Smoother thresholds for gradual transitions
-        if (biomeNoise < -0.3f) return BiomeType::SWAMP;
-        if (biomeNoise < -0.1f) return BiomeType::DESERT; 
-        if (biomeNoise < 0.2f) return BiomeType::GRASSLAND;
-        return BiomeType::MOUNTAINS;
-    }
-    
-    // Generate procedural resource nodes for a chunk
-    void generateResourcesForChunk(int chunkX, int chunkZ) {
-        if (!worldResourceNodes) return;
-        
-        BiomeType chunkBiome = getBiomeForChunk(chunkX, chunkZ);
-        
-        // World coordinates for this chunk
-        float chunkWorldX = chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-        float chunkWorldZ = chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-        
-        // Generate resource nodes based on biome
-        int nodeCount = 0;
-        float density = 0.3f; // Base density
-        
-        // Biome-specific resource generation
-        switch (chunkBiome) {
-            case BiomeType::MOUNTAINS:
-                // Mountains have iron and stone
-                density = 0.5f; // Higher density in mountains
-                for (int attempts = 0; attempts < 8; attempts++) {
-                    float seed = (chunkX * 73.0f + chunkZ * 47.0f + attempts * 23.0f);
-                    float noiseValue = bx::sin(seed * 0.1f) * bx::cos(seed * 0.13f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.7f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.8f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        ResourceType resourceType = (bx::sin(seed * 0.9f) > 0.0f) ? ResourceType::IRON : ResourceType::STONE;
-                        float worldY = getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
-                        
-                        worldResourceNodes->emplace_back(worldX, worldY, worldZ, resourceType, 100);
-                        nodeCount++;
-                    }
-                }
-                break;
-                
-            case BiomeType::DESERT:
-                // Desert has copper and stone
-                density = 0.25f;
-                for (int attempts = 0; attempts < 6; attempts++) {
-                    float seed = (chunkX * 67.0f + chunkZ * 53.0f + attempts * 29.0f);
-                    float noiseValue = bx::sin(seed * 0.15f) * bx::cos(seed * 0.11f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.6f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.7f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        ResourceType resourceType = (bx::sin(seed * 0.8f) > 0.2f) ? ResourceType::COPPER : ResourceType::STONE;
-                        float worldY = getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
-                        
-                        worldResourceNodes->emplace_back(worldX, worldY, worldZ, resourceType, 100);
-                        nodeCount++;
-                    }
-                }
-                break;
-                
-            case BiomeType::GRASSLAND:
-                // Grassland has balanced resources
-                density = 0.35f;
-                for (int attempts = 0; attempts < 7; attempts++) {
-                    float seed = (chunkX * 71.0f + chunkZ * 41.0f + attempts * 31.0f);
-                    float noiseValue = bx::sin(seed * 0.12f) * bx::cos(seed * 0.14f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.65f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.75f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        // Balanced distribution of all resource types
-                        float typeNoise = bx::sin(seed * 1.1f);
-                        ResourceType resourceType;
-                        if (typeNoise < -0.3f) resourceType = ResourceType::COPPER;
-                        else if (typeNoise < 0.3f) resourceType = ResourceType::IRON;
-                        else resourceType = ResourceType::STONE;
-                        
-                        float worldY = getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
-                        
-                        worldResourceNodes->emplace_back(worldX, worldY, worldZ, resourceType, 100);
-                        nodeCount++;
-                    }
-                }
-                break;
-                
-            case BiomeType::SWAMP:
-                // Swamp has mainly iron and occasional stone
-                density = 0.2f; // Lower density in swamps
-                for (int attempts = 0; attempts < 5; attempts++) {
-                    float seed = (chunkX * 61.0f + chunkZ * 59.0f + attempts * 37.0f);
-                    float noiseValue = bx::sin(seed * 0.18f) * bx::cos(seed * 0.09f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.55f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.85f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        ResourceType resourceType = (bx::sin(seed * 1.2f) > 0.4f) ? ResourceType::IRON : ResourceType::STONE;
-                        float worldY = getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
-                        
-                        worldResourceNodes->emplace_back(worldX, worldY, worldZ, resourceType, 100);
-                        nodeCount++;
-                    }
-                }
-                break;
-        }
-        
-        if (nodeCount > 0) {
-            std::cout << "Generated " << nodeCount << " resource nodes in " 
-                      << getBiomeName(chunkBiome) << " chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-        }
-    }
-    
-    // Generate procedural NPCs for a chunk
-    void generateNPCsForChunk(int chunkX, int chunkZ) {
-        if (!worldNPCs) return;
-        
-        BiomeType chunkBiome = getBiomeForChunk(chunkX, chunkZ);
-        
-        // World coordinates for this chunk
-        float chunkWorldX = chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-        float chunkWorldZ = chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-        
-        // Generate NPCs based on biome (lower density than resources)
-        int npcCount = 0;
-        float density = 0.1f; // Much lower base density than resources
-        
-        // Biome-specific NPC generation
-        switch (chunkBiome) {
-            case BiomeType::GRASSLAND:
-                // Grasslands have the most NPCs (villages)
-                density = 0.15f;
-                for (int attempts = 0; attempts < 3; attempts++) {
-                    float seed = (chunkX * 89.0f + chunkZ * 67.0f + attempts * 43.0f);
-                    float noiseValue = bx::sin(seed * 0.08f) * bx::cos(seed * 0.12f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.5f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.6f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        NPCType npcType;
-                        float typeNoise = bx::sin(seed * 1.3f);
-                        if (typeNoise < -0.2f) npcType = NPCType::MERCHANT;
-                        else if (typeNoise < 0.4f) npcType = NPCType::VILLAGER;
-                        else npcType = NPCType::WANDERER;
-                        
-                        float worldY = getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
-                        
-                        worldNPCs->emplace_back(std::make_unique<NPC>(worldX, worldY, worldZ, npcType));
-                        npcCount++;
-                    }
-                }
-                break;
-                
-            case BiomeType::DESERT:
-                // Desert has wanderers and occasional merchants
-                density = 0.08f;
-                for (int attempts = 0; attempts < 2; attempts++) {
-                    float seed = (chunkX * 97.0f + chunkZ * 73.0f + attempts * 47.0f);
-                    float noiseValue = bx::sin(seed * 0.1f) * bx::cos(seed * 0.09f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.4f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.7f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        NPCType npcType = (bx::sin(seed * 0.9f) > 0.3f) ? NPCType::WANDERER : NPCType::MERCHANT;
-                        float worldY = getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
-                        
-                        worldNPCs->emplace_back(std::make_unique<NPC>(worldX, worldY, worldZ, npcType));
-                        npcCount++;
-                    }
-                }
-                break;
-                
-            case BiomeType::MOUNTAINS:
-                // Mountains have few NPCs, mostly wanderers
-                density = 0.05f;
-                for (int attempts = 0; attempts < 2; attempts++) {
-                    float seed = (chunkX * 83.0f + chunkZ * 79.0f + attempts * 53.0f);
-                    float noiseValue = bx::sin(seed * 0.15f) * bx::cos(seed * 0.07f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.6f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.8f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        NPCType npcType = NPCType::WANDERER; // Only wanderers in mountains
-                        float worldY = getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
-                        
-                        worldNPCs->emplace_back(std::make_unique<NPC>(worldX, worldY, worldZ, npcType));
-                        npcCount++;
-                    }
-                }
-                break;
-                
-            case BiomeType::SWAMP:
-                // Swamps have very few NPCs
-                density = 0.03f;
-                for (int attempts = 0; attempts < 1; attempts++) {
-                    float seed = (chunkX * 101.0f + chunkZ * 103.0f + attempts * 59.0f);
-                    float noiseValue = bx::sin(seed * 0.18f) * bx::cos(seed * 0.06f);
-                    
-                    if (noiseValue > (1.0f - density)) {
-                        float offsetX = (bx::sin(seed * 0.3f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float offsetZ = (bx::cos(seed * 0.9f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                        float worldX = chunkWorldX + offsetX;
-                        float worldZ = chunkWorldZ + offsetZ;
-                        
-                        NPCType npcType = NPCType::WANDERER; // Only wanderers in swamps
-                        float worldY = getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
-                        
-                        worldNPCs->emplace_back(std::make_unique<NPC>(worldX, worldY, worldZ, npcType));
-                        npcCount++;
-                    }
-                }
-                break;
-        }
-        
-        if (npcCount > 0) {
-            std::cout << "Generated " << npcCount << " NPCs in " 
-                      << getBiomeName(chunkBiome) << " chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-        }
-    }
-    
-    // Helper function to get biome name
-    const char* getBiomeName(BiomeType biome) const {
-        switch (biome) {
-            case BiomeType::DESERT: return "Desert";
-            case BiomeType::MOUNTAINS: return "Mountains";
-            case BiomeType::SWAMP: return "Swamp";
-            case BiomeType::GRASSLAND: return "Grassland";
-            default: return "Unknown";
-        }
-    }
-    
-public:
-    ChunkManager() = default;
-    
-    // Set pointer to global resource nodes vector
-    void setResourceNodesPointer(std::vector<ResourceNode>* nodes) {
-        worldResourceNodes = nodes;
-    }
-    
-    // Set pointer to global NPCs vector
-    void setNPCsPointer(std::vector<std::unique_ptr<NPC>>* npcs) {
-        worldNPCs = npcs;
-    }
-    
-    // Force initial chunk loading around player position
-    void forceInitialChunkLoad(float playerX, float playerZ) {
-        playerChunkX = (int)bx::floor(playerX / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
-        playerChunkZ = (int)bx::floor(playerZ / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
-        
-        std::cout << "Force loading initial chunks around player at chunk (" << playerChunkX << ", " << playerChunkZ << ")" << std::endl;
-        
-        // Load chunks in render distance
-        loadChunksAroundPlayer();
-    }
-    
-    // Update chunks around player position
-    void updateChunksAroundPlayer(float playerX, float playerZ) {
-        // Calculate which chunk the player is in
-        int newPlayerChunkX = (int)bx::floor(playerX / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
-        int newPlayerChunkZ = (int)bx::floor(playerZ / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
-        
-        // Only update if player moved to a new chunk
-        if (newPlayerChunkX != playerChunkX || newPlayerChunkZ != playerChunkZ) {
-            playerChunkX = newPlayerChunkX;
-            playerChunkZ = newPlayerChunkZ;
-            
-            std::cout << "Player entered chunk (" << playerChunkX << ", " << playerChunkZ << ")" << std::endl;
-            
-            // Load chunks in render distance
-            loadChunksAroundPlayer();
-            
-            // Unload distant chunks
-            unloadDistantChunks();
-        }
-    }
-    
-    // Get height at world coordinates from appropriate chunk
-    float getHeightAt(float worldX, float worldZ) const {
-        int chunkX = (int)bx::floor(worldX / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
-        int chunkZ = (int)bx::floor(worldZ / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
-        
-        uint64_t key = getChunkKey(chunkX, chunkZ);
-        auto it = loadedChunks.find(key);
-        
-        if (it != loadedChunks.end()) {
-            return it->second->getHeightAt(worldX, worldZ);
-        }
-        
-        return 0.0f; // Default height if chunk not loaded
-    }
-    
-    // Render all loaded chunks
-    void renderChunks(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform) {
-        int renderedChunks = 0;
-        int skippedChunks = 0;
-        static int debugFrameCount = 0;
-        bool shouldDebug = (debugFrameCount % 300 == 0); // Debug every 5 seconds at 60fps
-        
-        if (shouldDebug) {
-            std::cout << "\n=== CHUNK RENDER DEBUG ===" << std::endl;
-            std::cout << "Total loaded chunks: " << loadedChunks.size() << std::endl;
-        }
-        
-        for (const auto& pair : loadedChunks) {
-            const auto& chunk = pair.second;
-            
-            // Debug chunk info
-            if (shouldDebug) {
-                float worldX = chunk->chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                float worldZ = chunk->chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
-                std::cout << "Chunk (" << chunk->chunkX << ", " << chunk->chunkZ << ") -> World pos (" 
-                          << worldX << ", " << worldZ << ") - " << chunk->getBiomeName();
-            }
-            
-            // Skip chunks with invalid buffers
-            if (!bgfx::isValid(chunk->vbh) || !bgfx::isValid(chunk->ibh) || !bgfx::isValid(chunk->texture)) {
-                if (shouldDebug) {
-                    std::cout << " - SKIPPED (invalid buffers: vbh=" << bgfx::isValid(chunk->vbh) 
-                              << ", ibh=" << bgfx::isValid(chunk->ibh) 
-                              << ", tex=" << bgfx::isValid(chunk->texture) << ")" << std::endl;
-                }
-                skippedChunks++;
-                continue;
-            }
-            
-            if (shouldDebug) {
-                std::cout << " - RENDERED" << std::endl;
-            }
-            
-            // Create transform matrix for chunk
-            float chunkMatrix[16], translation[16];
-            bx::mtxTranslate(translation, 0.0f, -5.0f, 0.0f); // Same terrain offset as before
-            bx::mtxIdentity(chunkMatrix);
-            bx::mtxMul(chunkMatrix, chunkMatrix, translation);
-            
-            // Set terrain rendering state
-            uint64_t terrainState = BGFX_STATE_DEFAULT;
-            terrainState &= ~BGFX_STATE_CULL_MASK;
-            bgfx::setState(terrainState);
-            
-            // Render this chunk with its biome-specific texture
-            render_object_at_position(chunk->vbh, chunk->ibh, program, chunk->texture, texUniform, chunkMatrix);
-            renderedChunks++;
-        }
-        
-        if (shouldDebug) {
-            std::cout << "Rendered: " << renderedChunks << ", Skipped: " << skippedChunks << std::endl;
-            std::cout << "=========================" << std::endl;
-        }
-        
-        debugFrameCount++;
-    }
-    
-    // Render water for all loaded chunks that have water
-    void renderWater(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, bgfx::TextureHandle waterTexture) {
-        for (const auto& pair : loadedChunks) {
-            const auto& chunk = pair.second;
-            
-            // Skip chunks without water
-            if (!chunk->hasWater || !bgfx::isValid(chunk->waterVbh) || !bgfx::isValid(chunk->waterIbh)) {
-                continue;
-            }
-            
-            // Create transform matrix for water (no offset needed since we included it in vertex generation)
-            float waterMatrix[16];
-            bx::mtxIdentity(waterMatrix);
-            
-            // Set water state before rendering
-            uint64_t waterState = BGFX_STATE_DEFAULT;
-            waterState |= BGFX_STATE_BLEND_ALPHA;
-            waterState &= ~BGFX_STATE_CULL_MASK;
-            bgfx::setState(waterState);
-            
-            // Render water plane with transparency
-            render_object_at_position(chunk->waterVbh, chunk->waterIbh, program, waterTexture, texUniform, waterMatrix);
-        }
-    }
-    
-    // Get chunk info for debugging
-    std::vector<std::string> getLoadedChunkInfo() const {
-        std::vector<std::string> info;
-        for (const auto& pair : loadedChunks) {
-            const auto& chunk = pair.second;
-            info.push_back(std::to_string(chunk->chunkX) + "," + std::to_string(chunk->chunkZ) + 
-                          " (" + chunk->getBiomeName() + ")");
-        }
-        return info;
-    }
-    
-private:
-    void loadChunksAroundPlayer() {
-        std::cout << "Loading chunks in " << (2*RENDER_DISTANCE+1) << "x" << (2*RENDER_DISTANCE+1) 
-                  << " grid around player chunk (" << playerChunkX << ", " << playerChunkZ << ")" << std::endl;
-        
-        for (int z = playerChunkZ - RENDER_DISTANCE; z <= playerChunkZ + RENDER_DISTANCE; z++) {
-            for (int x = playerChunkX - RENDER_DISTANCE; x <= playerChunkX + RENDER_DISTANCE; x++) {
-                uint64_t key = getChunkKey(x, z);
-                
-                // Only create chunk if it doesn't exist
-                if (loadedChunks.find(key) == loadedChunks.end()) {
-                    std::cout << "  Loading chunk (" << x << ", " << z << ")" << std::endl;
-                    BiomeType biome = getBiomeForChunk(x, z);
-                    auto chunk = std::make_unique<TerrainChunk>(x, z, biome);
-                    chunk->generate();
-                    chunk->createBuffers();
-                    
-                    loadedChunks[key] = std::move(chunk);
-                    
-                    // Generate resource nodes for this new chunk
-                    generateResourcesForChunk(x, z);
-                    
-                    // Generate NPCs for this new chunk
-                    generateNPCsForChunk(x, z);
-                } else {
-                    std::cout << "  Chunk (" << x << ", " << z << ") already exists" << std::endl;
-                }
-            }
-        }
-        std::cout << "Finished loading chunks. Total loaded: " << loadedChunks.size() << std::endl;
-    }
-    
-    void unloadDistantChunks() {
-        auto it = loadedChunks.begin();
-        while (it != loadedChunks.end()) {
-            const auto& chunk = it->second;
-            int deltaX = bx::abs(chunk->chunkX - playerChunkX);
-            int deltaZ = bx::abs(chunk->chunkZ - playerChunkZ);
-            
-            // Unload if outside render distance + buffer
-            if (deltaX > RENDER_DISTANCE + 1 || deltaZ > RENDER_DISTANCE + 1) {
-                std::cout << "Unloading chunk (" << chunk->chunkX << ", " << chunk->chunkZ << ")" << std::endl;
-                it = loadedChunks.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-};
-
 // Skill types
 
 // Player system
@@ -1195,6 +258,9 @@ void Player::setTarget(float x, float z, const ChunkManager& chunkManager, bool
     targetPosition.y = chunkManager.getHeightAt(x, z) + size - 5.0f; // Account for terrain offset
     hasTarget = true;
     isSprinting = sprint;
+    
+    // Walk around water and cliffs; update() waits for the route
+    path.request(chunkManager.getPathFinder(), position.x, position.z, x, z);
 }
 
 void Player::update(const ChunkManager& chunkManager, float currentTime, float deltaTime) {
@@ -1262,8 +328,9 @@ void Player::update(const ChunkManager& chunkManager, float currentTime, float d
             inCombat = false;
         } else {
             // Not in combat range yet - keep moving toward target
-            // Update target position in case NPC moved
+            // Update target position in case NPC moved (short chase, straight at them)
             targetPosition = combatTarget->position;
+            path.clear();
             if (!hasTarget) {
                 hasTarget = true;
                 isSprinting = true; // Sprint to combat
@@ -1274,20 +341,34 @@ void Player::update(const ChunkManager& chunkManager, float currentTime, float d
     }
     
     // Normal movement when not in active combat
-    if (hasTarget && !inCombat) {
+    PathFollower::Status pathStatus = path.poll();
+    if (hasTarget && pathStatus == PathFollower::Status::FAILED) {
+        std::cout << "No path to target" << std::endl;
+        hasTarget = false;
+        isSprinting = false;
+        path.clear();
+    }
+    
+    if (hasTarget && !inCombat && pathStatus != PathFollower::Status::PENDING) {
+        // Head for the next waypoint, or straight at the target without a path
+        float steerX = targetPosition.x, steerZ = targetPosition.z;
+        path.steer(position.x, position.z, 0.3f, steerX, steerZ);
         bx::Vec3 direction = {
-            targetPosition.x - position.x,
+            steerX - position.x,
             0.0f,
-            targetPosition.z - position.z
+            steerZ - position.z
         };
         
         float distance = bx::sqrt(direction.x * direction.x + direction.z * direction.z);
+        float targetDx = targetPosition.x - position.x;
+        float targetDz = targetPosition.z - position.z;
         
-        if (distance < 0.1f) {
+        if (bx::sqrt(targetDx * targetDx + targetDz * targetDz) < 0.1f) {
             position = targetPosition;
             hasTarget = false;
             isSprinting = false;
-        } else {
+            path.clear();
+        } else if (distance > 0.0f) {
             direction.x /= distance;
             direction.z /= distance;
             
@@ -1390,57 +471,39 @@ Ray createRayFromMouse(float mouseX, float mouseY, int screenWidth, int screenHe
 }
 
 bool rayTerrainIntersection(const Ray& ray, const ChunkManager& chunkManager, bx::Vec3& hitPoint) {
-    float t = 0.0f;
-    float maxDistance = 200.0f;
-    float stepSize = 0.1f;
-    
-    // Account for terrain offset in rendering (-5.0f in Y)
-    const float TERRAIN_Y_OFFSET = -5.0f;
-    
-    // Debug output disabled for hover system
-    // std::cout << "  Ray intersection - Origin: (" << ray.origin.x << ", " << ray.origin.y << ", " << ray.origin.z << ")" << std::endl;
-    // std::cout << "  Ray direction: (" << ray.direction.x << ", " << ray.direction.y << ", " << ray.direction.z << ")" << std::endl;
+    // Exact hit against the full-resolution terrain triangles (including the -5 offset). The
+    // LOD/RTIN mesh on screen can sit slightly off them, by up to its error bound
+    const float maxDistance = 200.0f;
+    return chunkManager.raycast(ray.origin, ray.direction, maxDistance, hitPoint);
+}
+
+// Distance along the ray to the point nearest the sphere centre, or -1 if the ray
+// passes outside the sphere or the centre is behind the camera
+float raySphereDistance(const Ray& ray, const bx::Vec3& center, float radius) {
+    bx::Vec3 toCenter = {
+        center.x - ray.origin.x,
+        center.y - ray.origin.y,
+        center.z - ray.origin.z
+    };
     
-    int intersectionChecks = 0;
+    float projDist = bx::dot(toCenter, ray.direction);
+    if (projDist < 0) return -1.0f; // Behind camera
     
-    while (t < maxDistance) {
-        bx::Vec3 currentPoint = {
-            ray.origin.x + ray.direction.x * t,
-            ray.origin.y + ray.direction.y * t,
-            ray.origin.z + ray.direction.z * t
-        };
-        
-        float rawTerrainHeight = chunkManager.getHeightAt(currentPoint.x, currentPoint.z);
-        float actualTerrainHeight = rawTerrainHeight + TERRAIN_Y_OFFSET;
-        
-        // Check if we're close to or below terrain (accounting for offset)
-        if (currentPoint.y <= actualTerrainHeight + 0.1f) {
-            hitPoint.x = currentPoint.x;
-            hitPoint.z = currentPoint.z;
-            hitPoint.y = actualTerrainHeight;
-            
-            // std::cout << "  Intersection found at t=" << t << ", point=(" << hitPoint.x << ", " << hitPoint.y << ", " << hitPoint.z << ")" << std::endl;
-            return true;
-        }
-        
-        intersectionChecks++;
-        t += stepSize;
-        
-        // Debug first few checks - disabled for hover system
-        // if (intersectionChecks <= 3) {
-        //     std::cout << "  Check " << intersectionChecks << ": t=" << t << ", point=(" << currentPoint.x << ", " << currentPoint.y << ", " << currentPoint.z << "), raw_height=" << rawTerrainHeight << ", actual_height=" << actualTerrainHeight << std::endl;
-        // }
-        
-        // Early exit if we've gone too far below terrain
-        if (intersectionChecks > 50 && currentPoint.y < actualTerrainHeight - 10.0f) {
-            break;
-        }
-    }
+    bx::Vec3 closestPoint = {
+        ray.origin.x + ray.direction.x * projDist,
+        ray.origin.y + ray.direction.y * projDist,
+        ray.origin.z + ray.direction.z * projDist
+    };
     
-    // std::cout << "  No intersection found after " << intersectionChecks << " checks" << std::endl;
-    return false;
+    float dx = closestPoint.x - center.x;
+    float dy = closestPoint.y - center.y;
+    float dz = closestPoint.z - center.z;
+    return bx::sqrt(dx*dx + dy*dy + dz*dz) <= radius ? projDist : -1.0f;
 }
 
+// Picking only considers entities this far along the ray, same as the terrain
+static constexpr float PICK_DISTANCE = 200.0f;
+
 // Shader vertex layouts
 static bgfx::VertexLayout layout;
 static bgfx::VertexLayout texLayout;
@@ -1456,6 +519,28 @@ bgfx::RendererType::Enum get_renderer_type() {
 #endif
 }
 
+// Load a compiled shader binary, invalid handle if the file is missing
+bgfx::ShaderHandle load_shader_file(const char* filePath) {
+    FILE* file = fopen(filePath, "rb");
+    if (!file) {
+        return BGFX_INVALID_HANDLE;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    const bgfx::Memory* mem = bgfx::alloc((uint32_t)size);
+    size_t read = fread(mem->data, 1, size, file);
+    fclose(file);
+
+    if ((long)read != size) {
+        std::cerr << "Failed to read shader file fully: " << filePath << std::endl;
+        return BGFX_INVALID_HANDLE;
+    }
+    return bgfx::createShader(mem);
+}
+
 // Load a PNG texture using stb_image
 bgfx::TextureHandle load_png_texture(const char* filePath) {
     uint64_t textureFlags = BGFX_TEXTURE_NONE;
@@ -1537,124 +622,6 @@ bgfx::TextureHandle create_water_texture() {
     return bgfx::createTexture2D(textureWidth, textureHeight, false, 1, bgfx::TextureFormat::RGBA8, textureFlags, texMem);
 }
 
-// Legacy function for single biome textures (kept for compatibility)
-bgfx::TextureHandle create_biome_texture(BiomeType biome) {
-    std::cout << "Creating " << (biome == BiomeType::DESERT ? "sand" : 
-                                biome == BiomeType::GRASSLAND ? "light green" :
-                                biome == BiomeType::SWAMP ? "dark green" : "brown-gray") 
-              << " texture for biome..." << std::endl;
-    
-    const uint32_t textureWidth = 256;
-    const uint32_t textureHeight = 256;
-    const uint32_t textureSize = textureWidth * textureHeight * 4;
-    
-    const bgfx::Memory* texMem = bgfx::alloc(textureSize);
-    uint8_t* data = texMem->data;
-    
-    // Base colors for each biome
-    uint8_t baseR, baseG, baseB;
-    uint8_t minR, maxR, minG, maxG, minB, maxB;
-    
-    switch (biome) {
-        case BiomeType::DESERT:
-            // Sandy colors
-            baseR = 220; baseG = 185; baseB = 140;
-            minR = 160; maxR = 240; minG = 130; maxG = 210; minB = 100; maxB = 170;
-            break;
-        case BiomeType::GRASSLAND:
-            // Light green colors
-            baseR = 100; baseG = 180; baseB = 80;
-            minR = 80; maxR = 140; minG = 150; maxG = 220; minB = 60; maxB = 120;
-            break;
-        case BiomeType::SWAMP:
-            // Dark green colors
-            baseR = 60; baseG = 120; baseB = 50;
-            minR = 40; maxR = 90; minG = 90; maxG = 150; minB = 30; maxB = 80;
-            break;
-        case BiomeType::MOUNTAINS:
-            // Brown-gray colors
-            baseR = 140; baseG = 120; baseB = 100;
-            minR = 100; maxR = 180; minG = 90; maxG = 150; minB = 70; maxB = 130;
-            break;
-    }
-    
-    // Create grain patterns
-    std::vector<std::vector<float>> grainPattern(textureWidth, std::vector<float>(textureHeight, 0.0f));
-    
-    int grainCount = (biome == BiomeType::SWAMP || biome == BiomeType::GRASSLAND) ? 150 : 200;
-    
-    for (int i = 0; i < grainCount; ++i) {
-        int grainX = rand() % textureWidth;
-        int grainY = rand() % textureHeight;
-        int grainSize = 3 + (rand() % 4);
-        float grainIntensity = 0.7f + (float)(rand() % 30) / 100.0f;
-        
-        for (int y = -grainSize; y <= grainSize; ++y) {
-            for (int x = -grainSize; x <= grainSize; ++x) {
-                int posX = grainX + x;
-                int posY = grainY + y;
-                
-                if (posX >= 0 && posX < textureWidth && posY >= 0 && posY < textureHeight) {
-                    float dist = std::sqrt(x*x + y*y);
-                    if (dist <= grainSize) {
-                        float effect = grainIntensity * (1.0f - dist/grainSize);
-                        grainPattern[posX][posY] += effect;
-                    }
-                }
-            }
-        }
-    }
-    
-    // Generate texture pixels with biome-specific patterns
-    for (uint32_t y = 0; y < textureHeight; ++y) {
-        for (uint32_t x = 0; x < textureWidth; ++x) {
-            uint32_t offset = (y * textureWidth + x) * 4;
-            
-            uint8_t r = baseR, g = baseG, b = baseB;
-            uint8_t microNoise = (uint8_t)((rand() % 20) - 10);
-            
-            float grainValue = bx::clamp(grainPattern[x][y], 0.0f, 1.0f);
-            float darkening = 1.0f - (grainValue * 0.3f);
-            
-            // Biome-specific patterns
-            float patternFactor = 1.0f;
-            switch (biome) {
-                case BiomeType::DESERT:
-                    // Horizontal sand dune patterns
-                    patternFactor = ((y / 12) % 2) == 0 ? 0.9f : 1.0f;
-                    break;
-                case BiomeType::GRASSLAND:
-                    // Subtle grass blade patterns
-                    patternFactor = ((x / 8 + y / 6) % 3) == 0 ? 0.95f : 1.0f;
-                    break;
-                case BiomeType::SWAMP:
-                    // Wet, muddy texture with darker spots
-                    patternFactor = ((x / 10 + y / 8) % 4) == 0 ? 0.8f : 1.0f;
-                    break;
-                case BiomeType::MOUNTAINS:
-                    // Rocky, uneven texture
-                    patternFactor = ((x / 6 + y / 9) % 3) == 0 ? 0.85f : 1.0f;
-                    break;
-            }
-            
-            r = (uint8_t)bx::clamp((r * darkening * patternFactor) + microNoise, (float)minR, (float)maxR);
-            g = (uint8_t)bx::clamp((g * darkening * patternFactor) + microNoise, (float)minG, (float)maxG);
-            b = (uint8_t)bx::clamp((b * darkening * patternFactor) + microNoise, (float)minB, (float)maxB);
-            
-            data[offset + 0] = r;
-            data[offset + 1] = g;
-            data[offset + 2] = b;
-            data[offset + 3] = 255;
-        }
-    }
-    
-    uint64_t textureFlags = BGFX_TEXTURE_NONE;
-    textureFlags |= BGFX_SAMPLER_MIN_ANISOTROPIC;
-    textureFlags |= BGFX_SAMPLER_MAG_ANISOTROPIC;
-    
-    return bgfx::createTexture2D(textureWidth, textureHeight, false, 1, bgfx::TextureFormat::RGBA8, textureFlags, texMem);
-}
-
 // Create procedural texture (legacy function for backward compatibility)
 bgfx::TextureHandle create_procedural_texture() {
     return create_biome_texture(BiomeType::DESERT); // Default to desert/sand texture
@@ -1902,6 +869,9 @@ int main(int argc, char* argv[]) {
     
     // Create texture uniforms
     bgfx::UniformHandle s_texColor = bgfx::createUniform("s_texColor", bgfx::UniformType::Sampler);
+    // Bone palette of the instanced NPCs, see SkinPalette
+    bgfx::UniformHandle s_skinPalette = bgfx::createUniform("s_skinPalette", bgfx::UniformType::Sampler);
+    bgfx::UniformHandle u_skinPaletteInfo = bgfx::createUniform("u_skinPaletteInfo", bgfx::UniformType::Vec4);
     
     // Day/night cycle uniforms
     bgfx::UniformHandle u_timeOfDay = bgfx::createUniform("u_timeOfDay", bgfx::UniformType::Vec4);
@@ -2113,6 +1083,7 @@ int main(int argc, char* argv[]) {
         
         sharedNPCModel.remapBoneIndices(gltfToOzzMapping);
         std::cout << "Shared NPC model joint mapping complete: " << mappedCount << "/" << numGltfJoints << " joints mapped" << std::endl;
+        NPC::setSharedModel(&sharedNPCModel);
     } else {
         std::cerr << "Failed to extract inverse bind matrices from shared NPC model!" << std::endl;
     }
@@ -2257,9 +1228,26 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Terrain program blending the biome texture array; optional, chunks fall back to
+    // texProgram with one texture per biome when the shader binaries are missing
+    bgfx::ProgramHandle terrainProgram = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle s_texBiomes = bgfx::createUniform("s_texBiomes", bgfx::UniformType::Sampler);
+#if BX_PLATFORM_OSX
+    bgfx::ShaderHandle terrainVsh = load_shader_file("shaders/metal/vs_terrain.bin");
+    bgfx::ShaderHandle terrainFsh = load_shader_file("shaders/metal/fs_terrain.bin");
+    if (bgfx::isValid(terrainVsh) && bgfx::isValid(terrainFsh)) {
+        terrainProgram = bgfx::createProgram(terrainVsh, terrainFsh, true);
+    } else {
+        if (bgfx::isValid(terrainVsh)) bgfx::destroy(terrainVsh);
+        if (bgfx::isValid(terrainFsh)) bgfx::destroy(terrainFsh);
+        std::cout << "Terrain blend shaders not found, using per-biome terrain textures" << std::endl;
+    }
+#endif
+
     // Create chunk manager and player
     std::cout << "Creating chunk manager..." << std::endl;
     ChunkManager chunkManager;
+    chunkManager.setBiomeBlendProgram(terrainProgram, s_texBiomes);
     
     std::cout << "Creating player..." << std::endl;
     Player player;
@@ -2280,6 +1268,8 @@ int main(int argc, char* argv[]) {
     // Connect ChunkManager to resource nodes and NPCs for procedural generation
     chunkManager.setResourceNodesPointer(&resourceNodes);
     chunkManager.setNPCsPointer(&npcs);
+    chunkManager.setPlayerPointer(&player);
+    chunkManager.setScreenErrorProjection(60.0f, float(WINDOW_HEIGHT));
     
     // Force initial chunk loading around player (this will generate resources)
     chunkManager.forceInitialChunkLoad(player.position.x, player.position.z);
@@ -2288,13 +1278,10 @@ int main(int argc, char* argv[]) {
     std::cout << "Initial world generation complete. Total resource nodes: " << resourceNodes.size() 
               << ", Total NPCs: " << npcs.size() << std::endl;
     
-    // Set up inverse bind matrices for all NPCs now that they exist
-    std::cout << "Setting up inverse bind matrices for " << npcs.size() << " NPCs..." << std::endl;
-    for (auto& npcPtr : npcs) {
-        if (npcPtr) {
-            npcPtr->setupInverseBindMatrices(sharedNPCModel);
-        }
-    }
+    auto animationStats = AnimationLibrary::get().getStats();
+    std::cout << "Animation library: " << animationStats.skeletons << " skeletons, " << animationStats.clips
+              << " clips (" << animationStats.clipBytes / 1024 << " KB), " << animationStats.fileLoads
+              << " file loads, " << animationStats.cacheHits << " cache hits" << std::endl;
     
     std::cout << "Starting main loop..." << std::endl;
     std::cout << "===== Controls =====" << std::endl;
@@ -2354,6 +1341,20 @@ int main(int argc, char* argv[]) {
     
     const bool* keyboardState = SDL_GetKeyboardState(NULL);
     
+    // Frustum culling scratch, reused every frame
+    Frustum viewFrustum;
+    SphereBounds cullSpheres;
+    std::vector<uint8_t> cullVisibility;
+    CullStats nodeCullStats, npcCullStats;
+
+    // NPC animation borrows the chunk workers; its helpers jump their queue, since the frame
+    // waits on animation but not on chunk builds
+    AnimationUpdateStage npcAnimationStage(&chunkManager.getWorkerPool());
+    std::vector<int> npcAnimationHandles;  // Per npcs index, -1 if not animated this frame
+    float playerSkinningTimer = 0.0f;     // Seconds since the player mesh was last skinned
+    SkinPalette npcSkinPalette;
+    std::unordered_map<size_t, uint32_t> npcPackedPalettes;  // Stage palette offset -> texel offset
+    
     // Main game loop
     while (!quit) {
         // Handle events
@@ -2373,6 +1374,10 @@ int main(int argc, char* argv[]) {
                     // Toggle debug overlay
                     debugOverlay.toggle();
                 }
+                else if (event.key.key == SDLK_M) {
+                    // Toggle adaptive terrain meshing (1 pixel error bound)
+                    chunkManager.setAdaptiveMeshing(!chunkManager.isAdaptiveMeshing(), 1.0f, true);
+                }
                 else if (event.key.key == SDLK_SPACE) {
                     // Mine nearby resource nodes
                     const float miningRange = 2.0f;
@@ -2385,30 +1390,37 @@ int main(int argc, char* argv[]) {
                     isMining = true;
                     miningStartTime = time;
                     
-                    for (auto& node : resourceNodes) {
-                        if (!node.canMine()) continue;
-                        
-                        float dx = player.position.x - node.position.x;
-                        float dz = player.position.z - node.position.z;
+                    // Nearest mineable node in range
+                    ResourceNode* target = nullptr;
+                    float targetDistance = miningRange;
+                    chunkManager.getResourceGrid().queryRadius(player.position.x, player.position.z, miningRange, [&](ResourceNode* node) {
+                        if (!node->canMine()) return;
+                        float dx = player.position.x - node->position.x;
+                        float dz = player.position.z - node->position.z;
                         float distance = bx::sqrt(dx * dx + dz * dz);
+                        if (distance <= targetDistance) {
+                            targetDistance = distance;
+                            target = node;
+                        }
+                    });
+                    
+                    if (target) {
+                        ResourceNode& node = *target;
                         
-                        if (distance <= miningRange) {
-                            // Apply Mining skill modifier to damage
-                            float miningModifier = player.skills.getSkill(SkillType::MINING).getModifier();
-                            int miningDamage = (int)(25 * miningModifier);
-                            
-                            int resourceGained = node.mine(miningDamage);
-                            if (resourceGained > 0) {
-                                inventory.addResource(node.type, resourceGained);
-                                // Award more Mining XP for depleting a node
-                                player.skills.getSkill(SkillType::MINING).addExperience(10.0f);
-                            } else {
-                                // Award Mining XP for each mining action
-                                player.skills.getSkill(SkillType::MINING).addExperience(2.0f);
-                            }
-                            minedSomething = true;
-                            break; // Mine one node at a time
+                        // Apply Mining skill modifier to damage
+                        float miningModifier = player.skills.getSkill(SkillType::MINING).getModifier();
+                        int miningDamage = (int)(25 * miningModifier);
+                        
+                        int resourceGained = node.mine(miningDamage);
+                        if (resourceGained > 0) {
+                            inventory.addResource(node.type, resourceGained);
+                            // Award more Mining XP for depleting a node
+                            player.skills.getSkill(SkillType::MINING).addExperience(10.0f);
+                        } else {
+                            // Award Mining XP for each mining action
+                            player.skills.getSkill(SkillType::MINING).addExperience(2.0f);
                         }
+                        minedSomething = true; // Mine one node at a time
                     }
                     
                     if (!minedSomething) {
@@ -2548,12 +1560,16 @@ int main(int argc, char* argv[]) {
         camera.getViewMatrix(view);
         
         float proj[16];
-        bx::mtxProj(proj, 60.0f, float(WINDOW_WIDTH) / float(WINDOW_HEIGHT), 0.1f, 100.0f, 
+        bx::mtxProj(proj, 60.0f, float(WINDOW_WIDTH) / float(WINDOW_HEIGHT), 0.1f, 400.0f, // Far enough for the 17x17 chunk view
                    bgfx::getCaps()->homogeneousDepth);
         
         bgfx::setViewTransform(0, view, proj);
         bgfx::setViewRect(0, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
         
+        float viewProj[16];
+        bx::mtxMul(viewProj, view, proj);
+        viewFrustum.extract(viewProj, bgfx::getCaps()->homogeneousDepth);
+        
         // Get current window size for various uses
         int currentWidth, currentHeight;
         SDL_GetWindowSize(window, &currentWidth, &currentHeight);
@@ -2563,41 +1579,13 @@ int main(int argc, char* argv[]) {
             std::cout << "Right-click detected! Window size: " << currentWidth << "x" << currentHeight << std::endl;
             Ray ray = createRayFromMouse(pendingMouseX, pendingMouseY, currentWidth, currentHeight, view, proj);
             
-            // First check if we clicked on an NPC
-            float closestNPCDist = FLT_MAX;
-            NPC* clickedNPC = nullptr;
-            
-            for (auto& npcPtr : npcs) {
-                if (!npcPtr || !npcPtr->isActive) continue;
-                auto& npc = *npcPtr;
-                
-                // Ray-sphere intersection test
-                bx::Vec3 toNPC = {
-                    npc.position.x - ray.origin.x,
-                    npc.position.y - ray.origin.y,
-                    npc.position.z - ray.origin.z
-                };
-                
-                float projDist = bx::dot(toNPC, ray.direction);
-                if (projDist < 0) continue; // Behind camera
-                
-                bx::Vec3 closestPoint = {
-                    ray.origin.x + ray.direction.x * projDist,
-                    ray.origin.y + ray.direction.y * projDist,
-                    ray.origin.z + ray.direction.z * projDist
-                };
-                
-                float dx = closestPoint.x - npc.position.x;
-                float dy = closestPoint.y - npc.position.y;
-                float dz = closestPoint.z - npc.position.z;
-                float distToNPC = bx::sqrt(dx*dx + dy*dy + dz*dz);
-                
-                // Check if within NPC's bounding sphere
-                if (distToNPC <= npc.size * 1.5f && projDist < closestNPCDist) {
-                    closestNPCDist = projDist;
-                    clickedNPC = npcPtr.get();
-                }
-            }
+            // First check if we clicked on an NPC, walking the grid cells under the ray
+            NPC* clickedNPC = chunkManager.getNPCGrid().raycast(ray.origin.x, ray.origin.z, ray.direction.x, ray.direction.z, PICK_DISTANCE,
+                [&ray](NPC* npc) {
+                    if (!npc->isActive) return -1.0f;
+                    // Within NPC's bounding sphere
+                    return raySphereDistance(ray, npc->position, npc->size * 1.5f);
+                });
             
             if (clickedNPC) {
                 // Clicked on an NPC - set as combat target and move toward them
@@ -2671,7 +1659,8 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        chunkManager.updateChunksAroundPlayer(player.position.x, player.position.z);
+        bx::Vec3 playerVelocity = player.getVelocity(deltaTime);
+        chunkManager.updateChunksAroundPlayer(player.position.x, player.position.z, playerVelocity.x, playerVelocity.z);
         
         // Check for hover over objects
         hasHoverInfo = false;
@@ -2684,77 +1673,21 @@ int main(int argc, char* argv[]) {
         // Create ray from mouse position
         Ray hoverRay = createRayFromMouse(currentMouseX, currentMouseY, currentWidth, currentHeight, view, proj);
         
-        // Check NPCs for hover
-        float closestNPCDist = FLT_MAX;
-        NPC* hoveredNPC = nullptr;
-        
-        for (auto& npcPtr : npcs) {
-            if (!npcPtr || !npcPtr->isActive) continue;
-            auto& npc = *npcPtr;
-            
-            // Simple ray-sphere intersection test
-            bx::Vec3 toNPC = {
-                npc.position.x - hoverRay.origin.x,
-                npc.position.y - hoverRay.origin.y,
-                npc.position.z - hoverRay.origin.z
-            };
-            
-            float projDist = bx::dot(toNPC, hoverRay.direction);
-            if (projDist < 0) continue; // Behind camera
-            
-            bx::Vec3 closestPoint = {
-                hoverRay.origin.x + hoverRay.direction.x * projDist,
-                hoverRay.origin.y + hoverRay.direction.y * projDist,
-                hoverRay.origin.z + hoverRay.direction.z * projDist
-            };
-            
-            float dx = closestPoint.x - npc.position.x;
-            float dy = closestPoint.y - npc.position.y;
-            float dz = closestPoint.z - npc.position.z;
-            float distToNPC = bx::sqrt(dx*dx + dy*dy + dz*dz);
-            
-            // Check if within NPC's bounding sphere (size * 2 for easier hovering)
-            if (distToNPC <= npc.size * 2.0f && projDist < closestNPCDist) {
-                closestNPCDist = projDist;
-                hoveredNPC = npcPtr.get();
-            }
-        }
+        // Check NPCs for hover (size * 2 for easier hovering)
+        NPC* hoveredNPC = chunkManager.getNPCGrid().raycast(hoverRay.origin.x, hoverRay.origin.z, hoverRay.direction.x, hoverRay.direction.z, PICK_DISTANCE,
+            [&hoverRay](NPC* npc) {
+                if (!npc->isActive) return -1.0f;
+                return raySphereDistance(hoverRay, npc->position, npc->size * 2.0f);
+            });
         
         // Check resources for hover (only if no NPC is hovered)
         if (!hoveredNPC) {
-            float closestResourceDist = FLT_MAX;
-            ResourceNode* hoveredResource = nullptr;
-            
-            for (auto& node : resourceNodes) {
-                if (!node.isActive) continue;
-                
-                // Simple ray-sphere intersection test
-                bx::Vec3 toResource = {
-                    node.position.x - hoverRay.origin.x,
-                    node.position.y - hoverRay.origin.y,
-                    node.position.z - hoverRay.origin.z
-                };
-                
-                float projDist = bx::dot(toResource, hoverRay.direction);
-                if (projDist < 0) continue; // Behind camera
-                
-                bx::Vec3 closestPoint = {
-                    hoverRay.origin.x + hoverRay.direction.x * projDist,
-                    hoverRay.origin.y + hoverRay.direction.y * projDist,
-                    hoverRay.origin.z + hoverRay.direction.z * projDist
-                };
-                
-                float dx = closestPoint.x - node.position.x;
-                float dy = closestPoint.y - node.position.y;
-                float dz = closestPoint.z - node.position.z;
-                float distToResource = bx::sqrt(dx*dx + dy*dy + dz*dz);
-                
-                // Check if within resource's bounding sphere (size * 2 for easier hovering)
-                if (distToResource <= node.size * 2.0f && projDist < closestResourceDist) {
-                    closestResourceDist = projDist;
-                    hoveredResource = &node;
-                }
-            }
+            // Size * 2 for easier hovering
+            ResourceNode* hoveredResource = chunkManager.getResourceGrid().raycast(hoverRay.origin.x, hoverRay.origin.z, hoverRay.direction.x, hoverRay.direction.z, PICK_DISTANCE,
+                [&hoverRay](ResourceNode* node) {
+                    if (!node->isActive) return -1.0f;
+                    return raySphereDistance(hoverRay, node->position, node->size * 2.0f);
+                });
             
             if (hoveredResource) {
                 // Format resource hover info
@@ -2849,7 +1782,7 @@ int main(int argc, char* argv[]) {
         }
         
         // Render all loaded terrain chunks
-        chunkManager.renderChunks(texProgram, s_texColor);
+        chunkManager.renderChunks(texProgram, s_texColor, &viewFrustum);
         
         // Render water with transparency enabled
         chunkManager.renderWater(texProgram, s_texColor, waterTexture);
@@ -2858,11 +1791,13 @@ int main(int argc, char* argv[]) {
         if (mannequinModel.hasAnyMeshes()) {
             // Enable animation system with optimized vertex transformation
             if (ozzAnimSystem.isLoaded()) {
-                // Try processing animation at a lower frequency to reduce CPU load
-                static float lastUpdateTime = 0.0f;
-                static float updateInterval = 0.033f; // Update at ~30 FPS instead of 60 FPS
+                // CPU skinning re-uploads the mesh, so it runs at the animation LOD rate for the
+                // player's distance from the camera rather than every frame
+                const AnimationLodPolicy& animationLod = npcAnimationStage.getLodPolicy();
+                int playerTier = animationLod.getTier(bx::length(bx::sub(player.position, camera.position)), true);
+                playerSkinningTimer += deltaTime;
                 
-                if (time - lastUpdateTime >= updateInterval) {
+                if (playerSkinningTimer >= animationLod.getSampleInterval(playerTier)) {
                     int numBones = ozzAnimSystem.getNumBones();
                     static std::vector<float> boneMatrices;
                     // Pure ozz-animation - no need for old bone matrix calculation
@@ -2887,7 +1822,7 @@ int main(int argc, char* argv[]) {
                     
                     // std::cout << "Ozz skinning completed" << std::endl;
                     
-                    lastUpdateTime = time;
+                    playerSkinningTimer = 0.0f;
                 }
             }
             
@@ -2956,9 +1891,22 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        // Render resource nodes
+        // Render resource nodes that pass the frustum test
+        cullSpheres.clear();
         for (const auto& node : resourceNodes) {
+            cullSpheres.add(node.position.x, node.position.y, node.position.z, node.boundingRadius);
+        }
+        cullSpheres.cull(viewFrustum, cullVisibility);
+        nodeCullStats = CullStats();
+        
+        for (size_t nodeIndex = 0; nodeIndex < resourceNodes.size(); nodeIndex++) {
+            const auto& node = resourceNodes[nodeIndex];
             if (!node.isActive) continue; // Don't render depleted nodes
+            if (!cullVisibility[nodeIndex]) {
+                nodeCullStats.culled++;
+                continue;
+            }
+            nodeCullStats.submitted++;
             
             float nodeMatrix[16], nodeTranslation[16], nodeScale[16];
             bx::mtxScale(nodeScale, node.size, node.size, node.size);
@@ -2990,7 +1938,16 @@ int main(int argc, char* argv[]) {
         
         // === GPU INSTANCED NPC RENDERING ===
         // Use proper BGFX instancing like examples/05-instancing
+        npcCullStats = CullStats();
         if (npcs.size() > 0) {
+            // Only NPCs near the player can notice them, so aggro is checked from the grid
+            SpatialGrid<NPC>& npcGrid = chunkManager.getNPCGrid();
+            npcGrid.queryRadius(player.position.x, player.position.z, NPC::MAX_AGGRO_RANGE, [&player](NPC* npc) {
+                if (npc->isActive) {
+                    npc->checkAggro(&player);
+                }
+            });
+
             // Update NPCs first (without rendering)
             for (auto& npcPtr : npcs) {
                 if (!npcPtr || !npcPtr->isActive) continue;
@@ -2998,22 +1955,46 @@ int main(int argc, char* argv[]) {
                 
                 // Update NPC AI
                 float npcTerrainHeight = chunkManager.getHeightAt(npc.position.x, npc.position.z);
-                npc.update(deltaTime, npcTerrainHeight, &player, time);
+                npc.update(deltaTime, npcTerrainHeight, time, &npcGrid, &chunkManager.getPathFinder());
                 npc.updateHealthColor();
-                
-                // Update NPC animation time
-                if (npc.ozzAnimSystem.isLoaded()) {
-                    npc.ozzAnimSystem.updateAnimation(deltaTime);
-                }
             }
             
             // Prepare instanced rendering data
-            const uint16_t instanceStride = 64; // 64 bytes for 4x4 matrix (no extra color data for now)
+            const uint16_t instanceStride = 80; // 4x4 matrix, then palette offset and skinned flag
             uint32_t totalNPCs = 0;
             
-            // Count active NPCs
+            // Frustum test all NPCs in one batch; only visible ones go into the instance buffer
+            cullSpheres.clear();
             for (auto& npcPtr : npcs) {
-                if (npcPtr && npcPtr->isActive) totalNPCs++;
+                if (npcPtr) {
+                    cullSpheres.add(npcPtr->position.x, npcPtr->position.y + npcPtr->boundingCenterHeight,
+                                    npcPtr->position.z, npcPtr->boundingRadius);
+                } else {
+                    cullSpheres.add(0.0f, 0.0f, 0.0f, 0.0f);
+                }
+            }
+            cullSpheres.cull(viewFrustum, cullVisibility);
+            
+            // Animate every NPC in one batch; the LOD policy decides how much work each one gets
+            // from its distance to the camera and whether it is on screen
+            npcAnimationStage.begin();
+            npcAnimationHandles.assign(npcs.size(), -1);
+            for (size_t i = 0; i < npcs.size(); i++) {
+                if (!npcs[i] || !npcs[i]->isActive) continue;
+                bx::Vec3 toCamera = bx::sub(npcs[i]->position, camera.position);
+                npcAnimationHandles[i] = npcAnimationStage.add(&npcs[i]->ozzAnimSystem, bx::length(toCamera),
+                                                               cullVisibility[i] != 0);
+            }
+            npcAnimationStage.run(deltaTime);
+            
+            // Count active, visible NPCs
+            for (size_t i = 0; i < npcs.size(); i++) {
+                if (!npcs[i] || !npcs[i]->isActive) continue;
+                if (cullVisibility[i]) {
+                    totalNPCs++;
+                } else {
+                    npcCullStats.culled++;
+                }
             }
             
             if (totalNPCs > 0) {
@@ -3027,11 +2008,13 @@ int main(int argc, char* argv[]) {
                     
                     uint8_t* data = idb.data;
                     uint32_t npcIndex = 0;
+                    npcSkinPalette.begin();
+                    npcPackedPalettes.clear();
                     
                     // Fill instance data
-                    for (auto& npcPtr : npcs) {
-                        if (!npcPtr || !npcPtr->isActive || npcIndex >= drawnNPCs) continue;
-                        auto& npc = *npcPtr;
+                    for (size_t i = 0; i < npcs.size(); i++) {
+                        if (!npcs[i] || !npcs[i]->isActive || !cullVisibility[i] || npcIndex >= drawnNPCs) continue;
+                        auto& npc = *npcs[i];
                         
                         // Calculate transformation matrix
                         float npcMatrix[16], npcTranslation[16], npcScale[16];
@@ -3041,18 +2024,46 @@ int main(int argc, char* argv[]) {
                         
                         // Copy matrix data (64 bytes)
                         float* mtx = (float*)data;
-                        for (int i = 0; i < 16; i++) {
-                            mtx[i] = npcMatrix[i];
+                        bx::memCopy(mtx, npcMatrix, sizeof(npcMatrix));
+                        
+                        // Pack this NPC's skin matrices; the shader finds them by texel offset. NPCs
+                        // sharing a pose share a stage palette, which is only packed once.
+                        float* skin = mtx + 16;
+                        const int handle = npcAnimationHandles[i];
+                        const ozz::math::Float4x4* pose = npcAnimationStage.getPalette(handle);
+                        skin[0] = 0.0f;
+                        if (pose) {
+                            auto packed = npcPackedPalettes.find(npcAnimationStage.getPaletteOffset(handle));
+                            if (packed == npcPackedPalettes.end()) {
+                                uint32_t texel = npcSkinPalette.add(pose, npc.ozzAnimSystem.getNumBones());
+                                packed = npcPackedPalettes.emplace(npcAnimationStage.getPaletteOffset(handle), texel).first;
+                            }
+                            skin[0] = (float)packed->second;
                         }
+                        skin[1] = pose ? 1.0f : 0.0f;
+                        skin[2] = skin[3] = 0.0f;
                         
                         data += instanceStride;
                         npcIndex++;
                     }
                     
+                    npcCullStats.submitted = (int)drawnNPCs;
+                    
                     // Set vertex and index buffers (using shared NPC model)
                     if (sharedNPCModel.hasAnyMeshes()) {
-                        // For now, render without animation to test instancing
-                        // TODO: Implement per-instance skeletal animation later
+                        // Without vertex texture fetch of RGBA32F, draw everyone in bind pose
+                        InstancedSkinning skinning;
+                        bool skinned = npcSkinPalette.upload();
+                        if (skinned) {
+                            skinning.paletteSampler = s_skinPalette;
+                            skinning.paletteTexture = npcSkinPalette.getTexture();
+                            skinning.paletteInfoUniform = u_skinPaletteInfo;
+                            npcSkinPalette.getShaderInfo(skinning.paletteInfo);
+                        } else {
+                            for (uint32_t n = 0; n < drawnNPCs; n++) {
+                                ((float*)(idb.data + n * instanceStride))[17] = 0.0f;
+                            }
+                        }
                         
                         // Set render state
                         uint64_t objState = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z 
@@ -3060,7 +2071,8 @@ int main(int argc, char* argv[]) {
                         bgfx::setState(objState);
                         
                         // Use instanced rendering
-                        sharedNPCModel.renderInstanced(npcInstancedProgram, s_texColor, &idb, drawnNPCs);
+                        sharedNPCModel.renderInstanced(npcInstancedProgram, s_texColor, &idb, drawnNPCs,
+                                                       skinned ? &skinning : nullptr);
                     }
                 }
             }
@@ -3163,18 +2175,68 @@ int main(int argc, char* argv[]) {
         // Render debug overlay if enabled
         if (debugOverlay.enabled) {
             // Create debug panel background (black with transparency) - ABGR format - taller panel
-            uiRenderer.panel(currentWidth - 220, 50, 210, 110, 0xAA000000); // Moved down to make room for clock
+            uiRenderer.panel(currentWidth - 220, 50, 210, 380, 0xAA000000); // Moved down to make room for clock
             
             // Render FPS and debug info with custom UI - better line spacing for 24px font
             char fpsText[64];
             snprintf(fpsText, sizeof(fpsText), "FPS: %3d (%4.1fms)", (int)debugOverlay.fps, debugOverlay.frameTime);
             uiRenderer.text(currentWidth - 210, 65, fpsText, UIColors::TEXT_NORMAL); // Moved down
             
-            snprintf(fpsText, sizeof(fpsText), "Chunks: %d", (int)chunkManager.getLoadedChunkInfo().size());
+            snprintf(fpsText, sizeof(fpsText), "Chunks: %d (+%d)", (int)chunkManager.getLoadedChunkInfo().size(),
+                     (int)chunkManager.getPendingChunkCount());
             uiRenderer.text(currentWidth - 210, 95, fpsText, UIColors::TEXT_NORMAL);  // Moved down
             
             snprintf(fpsText, sizeof(fpsText), "Player: %.1f,%.1f", player.position.x, player.position.z);
             uiRenderer.text(currentWidth - 210, 125, fpsText, UIColors::TEXT_NORMAL);  // Moved down
+
+            // Water is one draw; W is the number of merged quads in it
+            snprintf(fpsText, sizeof(fpsText), "Tris: %d W%d", chunkManager.getTrianglesSubmitted(),
+                     chunkManager.getWaterQuadCount());
+            uiRenderer.text(currentWidth - 210, 155, fpsText, UIColors::TEXT_NORMAL);
+
+            ChunkManager::MemoryStats terrainMemory = chunkManager.getMemoryStats();
+            snprintf(fpsText, sizeof(fpsText), "Terrain: %.1f/%.1fMB", terrainMemory.cpuBytes / (1024.0f * 1024.0f),
+                     terrainMemory.gpuBytes / (1024.0f * 1024.0f));
+            uiRenderer.text(currentWidth - 210, 185, fpsText, UIColors::TEXT_NORMAL);
+
+            // Frustum culling: terrain chunks / NPCs / resource nodes
+            const CullStats& chunkCull = chunkManager.getChunkCullStats();
+            snprintf(fpsText, sizeof(fpsText), "Drawn C%d N%d R%d", chunkCull.submitted,
+                     npcCullStats.submitted, nodeCullStats.submitted);
+            uiRenderer.text(currentWidth - 210, 215, fpsText, UIColors::TEXT_NORMAL);
+            snprintf(fpsText, sizeof(fpsText), "Culled C%d N%d R%d", chunkCull.culled,
+                     npcCullStats.culled, nodeCullStats.culled);
+            uiRenderer.text(currentWidth - 210, 245, fpsText, UIColors::TEXT_NORMAL);
+
+            // Chunk streaming: queued / building / awaiting upload, and last frame's main-thread cost
+            ChunkManager::StreamingStats streaming = chunkManager.getStreamingStats();
+            snprintf(fpsText, sizeof(fpsText), "Stream %d/%d/%d %.1fms", streaming.queued, streaming.inFlight,
+                     streaming.awaitingUpload, streaming.lastFrameMilliseconds);
+            uiRenderer.text(currentWidth - 210, 275, fpsText, UIColors::TEXT_NORMAL);
+
+            // Residency: warm chunks / restores from them / pooled chunks, then chunk objects
+            // allocated and GPU buffers created/destroyed since startup (flat while recycling works)
+            ChunkManager::ResidencyStats residency = chunkManager.getResidencyStats();
+            snprintf(fpsText, sizeof(fpsText), "Warm %d hit%d P%d", (int)residency.warmChunks,
+                     (int)residency.warmHits, (int)residency.pool.pooledChunks);
+            uiRenderer.text(currentWidth - 210, 305, fpsText, UIColors::TEXT_NORMAL);
+            snprintf(fpsText, sizeof(fpsText), "Alloc C%d B+%d-%d", (int)residency.pool.chunksAllocated,
+                     (int)residency.buffers.created, (int)residency.buffers.destroyed);
+            uiRenderer.text(currentWidth - 210, 335, fpsText, UIColors::TEXT_NORMAL);
+
+            // NPC animation: instances evaluated, wall time and threads of the update stage, samples
+            // the budget pushed back and shared poses; then instances per LOD tier, nearest first,
+            // off screen last
+            const AnimationUpdateStage::Stats& animation = npcAnimationStage.getStats();
+            snprintf(fpsText, sizeof(fpsText), "Anim %d %.2fms T%d D%d S%d", (int)animation.instances,
+                     animation.milliseconds, (int)animation.threads, animation.deferred, animation.sharedPoses);
+            uiRenderer.text(currentWidth - 210, 365, fpsText, UIColors::TEXT_NORMAL);
+            int lodTextLength = snprintf(fpsText, sizeof(fpsText), "LOD");
+            for (const auto& tier : animation.tiers) {
+                if (lodTextLength >= (int)sizeof(fpsText)) break;
+                lodTextLength += snprintf(fpsText + lodTextLength, sizeof(fpsText) - lodTextLength, " %d", tier.instances);
+            }
+            uiRenderer.text(currentWidth - 210, 395, fpsText, UIColors::TEXT_NORMAL);
         }
         
         // Render inventory overlay if enabled
@@ -3198,11 +2260,17 @@ int main(int argc, char* argv[]) {
     }
     
     // Clean up resources
+    chunkManager.shutdown();
     uiRenderer.destroy();
     bgfx::destroy(proceduralTexture);
     if (bgfx::isValid(pngTexture)) bgfx::destroy(pngTexture);
     bgfx::destroy(waterTexture);
     bgfx::destroy(s_texColor);
+    bgfx::destroy(s_skinPalette);
+    bgfx::destroy(u_skinPaletteInfo);
+    npcSkinPalette.destroy();
+    bgfx::destroy(s_texBiomes);
+    if (bgfx::isValid(terrainProgram)) bgfx::destroy(terrainProgram);
     bgfx::destroy(ibh);
     bgfx::destroy(vbh);
     bgfx::destroy(copperVbh);
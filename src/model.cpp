@@ -115,6 +115,7 @@ bool Model::loadFromFile(const char* filepath) {
     
     // Clear any existing data
     unload();
+    sourcePath = filepath;
     
     // Extract file extension
     std::string path(filepath);
@@ -219,6 +220,7 @@ bool Model::loadFromBinary(const char* filepath) {
     
     // Clear any existing data
     unload();
+    sourcePath = filepath;
     
     // Open the binary file
     std::ifstream file(filepath, std::ios::binary | std::ios::ate);
@@ -943,7 +945,8 @@ void Model::render(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform,
 }
 
 void Model::renderInstanced(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, 
-                           bgfx::InstanceDataBuffer* instanceBuffer, uint32_t instanceCount) {
+                           bgfx::InstanceDataBuffer* instanceBuffer, uint32_t instanceCount,
+                           const InstancedSkinning* skinning) {
     // No transform matrix needed for instanced rendering - handled by instances
     
     // Use default rendering state
@@ -969,6 +972,12 @@ void Model::renderInstanced(bgfx::ProgramHandle program, bgfx::UniformHandle tex
         // Set instance data buffer (proper BGFX instancing API)
         bgfx::setInstanceDataBuffer(instanceBuffer);
         
+        // Bone palette, reset by every submit like the textures above
+        if (skinning) {
+            bgfx::setTexture(1, skinning->paletteSampler, skinning->paletteTexture);
+            bgfx::setUniform(skinning->paletteInfoUniform, skinning->paletteInfo);
+        }
+        
         // Set state
         bgfx::setState(state);
         
@@ -1141,6 +1150,7 @@ void Model::unload() {
     animations.clear();
     nodes.clear();
     skins.clear();
+    sourcePath.clear();
 }
 
 const AnimationClip* Model::getAnimation(const std::string& name) const {
@@ -1423,6 +1433,16 @@ void Model::remapBoneIndices(const std::vector<int>& gltfToOzzMapping) {
         // Copy remapped indices to animated vertices
         mesh.animatedVertices = mesh.originalVertices;
         
+        // GPU skinning reads the indices from the vertex buffer
+        if (bgfx::isValid(mesh.vertexBuffer)) {
+            bgfx::destroy(mesh.vertexBuffer);
+        }
+        const bgfx::Memory* vertexMem = bgfx::copy(
+            mesh.originalVertices.data(),
+            mesh.originalVertices.size() * sizeof(PosNormalTexcoordVertex)
+        );
+        mesh.vertexBuffer = bgfx::createVertexBuffer(vertexMem, PosNormalTexcoordVertex::ms_layout);
+        
         std::cout << "Remapped bone indices for mesh with " << mesh.originalVertices.size() << " vertices" << std::endl;
     }
 }
@@ -90,6 +90,15 @@ struct ModelMesh {
     bool hasAnimation = false;
 };
 
+// Bone palette bound alongside an instanced draw (see SkinPalette); each instance's palette
+// offset travels in its instance data
+struct InstancedSkinning {
+    bgfx::UniformHandle paletteSampler = BGFX_INVALID_HANDLE;
+    bgfx::TextureHandle paletteTexture = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle paletteInfoUniform = BGFX_INVALID_HANDLE;
+    float paletteInfo[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+};
+
 // Simplified model class focused on GLTF loading
 class Model {
 public:
@@ -108,9 +117,10 @@ public:
     // Render the model with the given program and transform
     void render(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, float* modelMatrix);
     
-    // Render multiple instances of the model
+    // Render multiple instances of the model, one draw per mesh
     void renderInstanced(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, 
-                        bgfx::InstanceDataBuffer* instanceBuffer, uint32_t instanceCount);
+                        bgfx::InstanceDataBuffer* instanceBuffer, uint32_t instanceCount,
+                        const InstancedSkinning* skinning = nullptr);
     
     // Free resources
     void unload();
@@ -130,7 +140,7 @@ public:
     // Get inverse bind matrices for ozz skinning setup
     bool getInverseBindMatrices(std::vector<float>& outMatrices) const;
     
-    // Remap vertex bone indices from glTF space to ozz space
+    // Remap vertex bone indices from glTF space to ozz space, in the vertex buffers too
     void remapBoneIndices(const std::vector<int>& gltfToOzzMapping);
     
     // Animation support
@@ -170,6 +180,9 @@ public:
     std::vector<Skin> skins;
     std::vector<Joint> nodes; // All nodes (including non-joint nodes)
     
+    // File the model was loaded from, empty for models built in code
+    std::string sourcePath;
+    
 private:
     
     // Cache of loaded textures by source index
@@ -2,6 +2,8 @@
 #include "player.h"
 #include <cstdlib>
 
+const Model* NPC::sharedModel = nullptr;
+
 // NPC implementation
 NPC::NPC(float x, float y, float z, NPCType npcType) 
     : position({x, y, z}), velocity({0.0f, 0.0f, 0.0f}), targetPosition({x, y, z}),
@@ -49,9 +51,16 @@ NPC::NPC(float x, float y, float z, NPCType npcType)
     
     health = maxHealth;  // Start at full health
     color = baseColor;   // Start with base color
+
+    // Mannequin is roughly 1.8 units tall at scale 1 with its origin at the feet
+    boundingCenterHeight = size;
+    boundingRadius = size * 1.5f;
     updateHealthColor(); // Apply initial color
     
-    // Initialize animation system (model is now shared globally)
+    // Initialize animation system; skeleton and clips come from the shared AnimationLibrary.
+    // Each NPC starts its clips at its own phase so a crowd spawned together isn't in step.
+    float phase = bx::sin(x * 12.9898f + z * 78.233f) * 43758.5453f;
+    ozzAnimSystem.setPhaseOffset(phase - bx::floor(phase));
     if (!ozzAnimSystem.loadSkeleton("build/assets/skeleton.ozz")) {
         std::cerr << "Failed to load skeleton for NPC!" << std::endl;
     }
@@ -65,7 +74,9 @@ NPC::NPC(float x, float y, float z, NPCType npcType)
     // Set animation to idle by default
     ozzAnimSystem.setCurrentAnimation("idle");
     
-    // Note: Joint mapping will be set up globally for the shared model
+    if (sharedModel) {
+        setupInverseBindMatrices(*sharedModel);
+    }
 }
 
 const char* NPC::getTypeName() const {
@@ -150,32 +161,9 @@ void NPC::heal(int amount) {
     std::cout << getTypeName() << " healed " << amount << " HP! Health: " << health << "/" << maxHealth << std::endl;
 }
 
-void NPC::update(float deltaTime, float terrainHeight, Player* player, float currentTime) {
+void NPC::checkAggro(Player* player) {
     if (!isActive) return;
-    
-    stateTimer += deltaTime;
-    
-    // Update animation based on movement state
-    bool isMoving = (state == NPCState::MOVING_TO_TARGET || 
-                     state == NPCState::APPROACHING_ENEMY || 
-                     state == NPCState::FLEEING ||
-                     state == NPCState::WANDERING);
-    
-    if (isMoving) {
-        ozzAnimSystem.setCurrentAnimation("walking");
-    } else {
-        ozzAnimSystem.setCurrentAnimation("idle");
-    }
-    
-    // Update animation system
-    ozzAnimSystem.updateAnimation(deltaTime);
-    
-    // Update hit flash timer
-    if (hitFlashTimer > 0) {
-        hitFlashTimer -= deltaTime;
-        if (hitFlashTimer < 0) hitFlashTimer = 0;
-    }
-    
+
     // Check for combat initiation if hostile or if player is our combat target
     if (player && (isHostile || combatTarget == player)) {
         float dx = player->position.x - position.x;
@@ -187,9 +175,10 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
             if (type == NPCType::VILLAGER) {
                 // Villagers flee instead of fight
                 state = NPCState::FLEEING;
-                // Set flee target opposite of player
+                // Set flee target opposite of player; update() asks for a route there
                 targetPosition.x = position.x - (dx / distToPlayer) * 15.0f;
                 targetPosition.z = position.z - (dz / distToPlayer) * 15.0f;
+                path.clear();
             } else if (isHostile || combatTarget == player) {
                 // Enter combat mode
                 state = NPCState::APPROACHING_ENEMY;
@@ -198,6 +187,34 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
             stateTimer = 0.0f;
         }
     }
+}
+
+void NPC::update(float deltaTime, float terrainHeight, float currentTime, SpatialGrid<NPC>* grid,
+                 const PathFinder* pathFinder) {
+    if (!isActive) return;
+
+    const float oldX = position.x;
+    const float oldZ = position.z;
+    
+    stateTimer += deltaTime;
+    
+    // Update animation based on movement state
+    bool isMoving = (state == NPCState::MOVING_TO_TARGET || 
+                     state == NPCState::APPROACHING_ENEMY || 
+                     state == NPCState::FLEEING ||
+                     state == NPCState::WANDERING);
+    
+    const char* desiredAnimation = isMoving ? "walking" : "idle";
+    if (ozzAnimSystem.getCurrentAnimationName() != desiredAnimation) {
+        ozzAnimSystem.setCurrentAnimation(desiredAnimation);
+    }
+    // The clip is advanced and sampled by the AnimationUpdateStage, together with all other NPCs
+    
+    // Update hit flash timer
+    if (hitFlashTimer > 0) {
+        hitFlashTimer -= deltaTime;
+        if (hitFlashTimer < 0) hitFlashTimer = 0;
+    }
     
     switch (state) {
         case NPCState::IDLE:
@@ -209,12 +226,28 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
                 targetPosition.x = position.x + bx::cos(angle) * distance;
                 targetPosition.z = position.z + bx::sin(angle) * distance;
                 
+                // Route around water and cliffs instead of walking straight in
+                if (pathFinder) {
+                    path.request(*pathFinder, position.x, position.z, targetPosition.x, targetPosition.z);
+                } else {
+                    path.clear();
+                }
+                
                 state = NPCState::MOVING_TO_TARGET;
                 stateTimer = 0.0f;
             }
             break;
             
         case NPCState::MOVING_TO_TARGET: {
+            // Wait for the route; give up on targets that can't be reached
+            PathFollower::Status pathStatus = path.poll();
+            if (pathStatus == PathFollower::Status::FAILED) {
+                state = NPCState::IDLE;
+                stateTimer = 0.0f;
+                velocity = {0.0f, 0.0f, 0.0f};
+                break;
+            }
+            
             // Move towards target
             float dx = targetPosition.x - position.x;
             float dz = targetPosition.z - position.z;
@@ -225,10 +258,20 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
                 state = NPCState::IDLE;
                 stateTimer = 0.0f;
                 velocity = {0.0f, 0.0f, 0.0f};
+                path.clear();
+            } else if (pathStatus == PathFollower::Status::PENDING) {
+                velocity = {0.0f, 0.0f, 0.0f};
             } else {
+                // Head for the next waypoint (or straight at the target without a path)
+                float steerX = targetPosition.x, steerZ = targetPosition.z;
+                path.steer(position.x, position.z, 0.5f, steerX, steerZ);
+                dx = steerX - position.x;
+                dz = steerZ - position.z;
+                float steerDistance = bx::max(bx::sqrt(dx * dx + dz * dz), 0.001f);
+                
                 // Move towards target
-                velocity.x = (dx / distance) * speed;
-                velocity.z = (dz / distance) * speed;
+                velocity.x = (dx / steerDistance) * speed;
+                velocity.z = (dz / steerDistance) * speed;
                 
                 position.x += velocity.x * deltaTime;
                 position.z += velocity.z * deltaTime;
@@ -242,6 +285,7 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
                 state = NPCState::IDLE;
                 stateTimer = 0.0f;
                 velocity = {0.0f, 0.0f, 0.0f};
+                path.clear();
             }
             break;
         }
@@ -332,7 +376,12 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
         }
         
         case NPCState::FLEEING: {
-            // Run away!
+            // Run away along a route if we can get one
+            if (pathFinder && path.status == PathFollower::Status::NONE) {
+                path.request(*pathFinder, position.x, position.z, targetPosition.x, targetPosition.z);
+            }
+            PathFollower::Status pathStatus = path.poll();
+            
             float dx = targetPosition.x - position.x;
             float dz = targetPosition.z - position.z;
             float distance = bx::sqrt(dx * dx + dz * dz);
@@ -342,10 +391,20 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
                 state = NPCState::IDLE;
                 stateTimer = 0.0f;
                 velocity = {0.0f, 0.0f, 0.0f};
+                path.clear();
+            } else if (pathStatus == PathFollower::Status::PENDING || pathStatus == PathFollower::Status::FAILED) {
+                // Cornered (or still looking for a way out): stay put until the timeout
+                velocity = {0.0f, 0.0f, 0.0f};
             } else {
+                float steerX = targetPosition.x, steerZ = targetPosition.z;
+                path.steer(position.x, position.z, 0.5f, steerX, steerZ);
+                dx = steerX - position.x;
+                dz = steerZ - position.z;
+                float steerDistance = bx::max(bx::sqrt(dx * dx + dz * dz), 0.001f);
+                
                 // Sprint away
-                velocity.x = (dx / distance) * speed * 2.0f;
-                velocity.z = (dz / distance) * speed * 2.0f;
+                velocity.x = (dx / steerDistance) * speed * 2.0f;
+                velocity.z = (dz / steerDistance) * speed * 2.0f;
                 
                 position.x += velocity.x * deltaTime;
                 position.z += velocity.z * deltaTime;
@@ -370,40 +429,18 @@ void NPC::update(float deltaTime, float terrainHeight, Player* player, float cur
             position.y = terrainHeight - 5.0f + 0.1f; // Mannequin feet should touch ground
             break;
     }
+
+    if (grid) {
+        grid->move(this, oldX, oldZ, position.x, position.z);
+    }
 }
 
 void NPC::setupInverseBindMatrices(const Model& sharedModel) {
-    // Extract inverse bind matrices from the shared model
-    std::vector<float> inverseBindMatrices;
-    if (sharedModel.getInverseBindMatrices(inverseBindMatrices)) {
-        int numGltfJoints = inverseBindMatrices.size() / 16;
-        auto ozzJointNames = ozzAnimSystem.getJointNames();
-        
-        // Create joint mapping (same logic as in main.cpp)
-        std::vector<int> gltfToOzzMapping(numGltfJoints, -1);
-        int mappedCount = 0;
-        
-        if (!sharedModel.skins.empty()) {
-            const auto& skin = sharedModel.skins[0];
-            for (int skinIdx = 0; skinIdx < (int)skin.jointIndices.size(); skinIdx++) {
-                int nodeIndex = skin.jointIndices[skinIdx];
-                if (nodeIndex < (int)sharedModel.nodes.size()) {
-                    const std::string& gltfName = sharedModel.nodes[nodeIndex].name;
-                    // Skip first 2 ozz joints (Armature, Ch36) - start from Hips
-                    for (int ozzIdx = 2; ozzIdx < (int)ozzJointNames.size(); ozzIdx++) {
-                        if (gltfName == ozzJointNames[ozzIdx]) {
-                            gltfToOzzMapping[skinIdx] = ozzIdx;
-                            mappedCount++;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-        
-        // Set inverse bind matrices with mapping for this NPC's animation system
-        ozzAnimSystem.setInverseBindMatricesWithMapping(inverseBindMatrices.data(), numGltfJoints, gltfToOzzMapping);
-        // std::cout << "NPC inverse bind matrices set: " << mappedCount << "/" << numGltfJoints << " joints mapped" << std::endl;
+    // Skip first 2 ozz joints (Armature, Ch36) - start from Hips. The mapping is built once
+    // per model and shared by every NPC.
+    auto binding = AnimationLibrary::get().getSkinBinding(ozzAnimSystem.getSkeletonAsset(), sharedModel, 2);
+    if (binding) {
+        ozzAnimSystem.setSkinBinding(std::move(binding));
     } else {
         std::cerr << "Failed to extract inverse bind matrices from shared model for NPC!" << std::endl;
     }
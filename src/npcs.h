@@ -5,6 +5,8 @@
 #include <cstdint>
 #include "model.h"
 #include "ozz_animation.h"
+#include "spatial_grid.h"
+#include "pathfinding.h"
 
 // Forward declarations
 struct Player;
@@ -29,6 +31,8 @@ enum class NPCState {
 
 // Non-player character with AI behavior
 struct NPC {
+    static constexpr float MAX_AGGRO_RANGE = 12.0f;  // Largest aggroRange of any type
+
     bx::Vec3 position;
     bx::Vec3 velocity;
     bx::Vec3 targetPosition;
@@ -36,6 +40,8 @@ struct NPC {
     NPCState state;
     float speed;
     float size;
+    float boundingRadius;       // Culling sphere around the model...
+    float boundingCenterHeight; // ...centred this far above position (the model's feet)
     float stateTimer;
     float maxStateTime;
     bool isActive;
@@ -57,6 +63,13 @@ struct NPC {
     float hitChance;         // 0.0 to 1.0
     float dodgeChance;       // 0.0 to 1.0
     float hitFlashTimer;     // Red flash when hit
+
+    // Owning chunk and the index of this NPC in its npcSpawns, -1 if not chunk-owned
+    int chunkX = 0, chunkZ = 0;
+    int spawnIndex = -1;
+
+    // Route to targetPosition while MOVING_TO_TARGET or FLEEING
+    PathFollower path;
     
     // Animation (model is now shared globally)
     OzzAnimationSystem ozzAnimSystem; // Individual animation system
@@ -69,8 +82,14 @@ struct NPC {
     NPC(NPC&&) = delete;
     NPC& operator=(NPC&&) = delete;
     
-    // Update method implemented in main.cpp due to circular dependency with Player
-    void update(float deltaTime, float terrainHeight, Player* player, float currentTime);
+    // AI and movement; keeps the NPC's entry in grid (if given) in step with its position.
+    // Without a pathFinder NPCs walk straight at their targets.
+    void update(float deltaTime, float terrainHeight, float currentTime, SpatialGrid<NPC>* grid = nullptr,
+                const PathFinder* pathFinder = nullptr);
+
+    // Start fighting or fleeing if the player is within aggroRange. Only called for NPCs
+    // the spatial grid finds near the player.
+    void checkAggro(Player* player);
     const char* getTypeName() const;
     void takeDamage(int damage, float currentTime);
     void updateHealthColor();
@@ -79,4 +98,11 @@ struct NPC {
     
     // Helper to set up inverse bind matrices from shared model
     void setupInverseBindMatrices(const Model& sharedModel);
+
+    // Model every NPC is skinned with. Once set, NPCs bind to it on construction, so ones
+    // spawned by chunk streaming get inverse bind matrices too.
+    static void setSharedModel(const Model* model) { sharedModel = model; }
+
+private:
+    static const Model* sharedModel;
 };
\ No newline at end of file
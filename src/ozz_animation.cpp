@@ -1,34 +1,30 @@
 #include "ozz_animation.h"
-#include <ozz/base/io/stream.h>
-#include <ozz/base/io/archive.h>
 #include <ozz/base/span.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 bool OzzAnimationSystem::loadSkeleton(const std::string& skeletonPath) {
-    ozz::io::File file(skeletonPath.c_str(), "rb");
-    if (!file.opened()) {
-        std::cerr << "Failed to open skeleton file: " << skeletonPath << std::endl;
-        return false;
-    }
-    
-    ozz::io::IArchive archive(&file);
-    if (!archive.TestTag<ozz::animation::Skeleton>()) {
-        std::cerr << "Invalid skeleton file format" << std::endl;
-        return false;
-    }
+    auto asset = AnimationLibrary::get().loadSkeleton(skeletonPath);
+    if (!asset) return false;
     
-    archive >> skeleton;
+    skeleton = asset;
+    skinBinding.reset();  // Bound to the previous skeleton's joint order
     
     // Allocate runtime buffers
-    const int numJoints = skeleton.num_joints();
-    localTransforms.resize(numJoints);
+    const int numJoints = skeleton->skeleton.num_joints();
+    localTransforms.resize(skeleton->skeleton.num_soa_joints());
+    fromPose.resize(localTransforms.size());
+    toPose.resize(localTransforms.size());
     modelMatrices.resize(numJoints);
+    skinMatrices.assign(numJoints, ozz::math::Float4x4::identity());
+    lodPosesValid = false;
+    skinMatricesCurrent = false;
     
     // Allocate sampling context
     samplingContext.Resize(numJoints);
     
     skeletonLoaded = true;
-    std::cout << "Loaded skeleton with " << numJoints << " joints" << std::endl;
     return true;
 }
 
@@ -40,67 +36,137 @@ bool OzzAnimationSystem::loadAnimation(const std::string& animationPath) {
 void OzzAnimationSystem::updateAnimation(float deltaTime) {
     if (!isLoaded() || !currentAnimation) return;
     
+    advance(deltaTime);
+    skinMatrices.resize(modelMatrices.size());
+    skinMatricesCurrent = evaluate(skinMatrices.data());
+}
+
+void OzzAnimationSystem::advance(float deltaTime) {
+    if (!isLoaded() || !currentAnimation) return;
+    
     // Update animation time
     animationTime += deltaTime;
+    sinceSample += deltaTime;
     
     // Handle looping
-    if (looping && currentAnimation && animationTime > currentAnimation->duration()) {
+    if (looping && animationTime > currentAnimation->duration()) {
         animationTime = fmod(animationTime, currentAnimation->duration());
     }
+}
+
+bool OzzAnimationSystem::evaluate(ozz::math::Float4x4* skinOut) {
+    if (!isLoaded() || !currentAnimation) return false;
+    
+    if (!sampleLocal(animationTime, localTransforms)) return false;
+    return computeSkinMatrices(skinOut);
+}
+
+bool OzzAnimationSystem::needsSample() const {
+    return !lodPosesValid || sampleInterval <= 0.0f || sinceSample >= sampledInterval;
+}
+
+bool OzzAnimationSystem::evaluateLod(ozz::math::Float4x4* skinOut, bool sample, bool computePose) {
+    if (!isLoaded() || !currentAnimation) return false;
+    
+    if (sampleInterval <= 0.0f) {
+        // Full rate: nothing to blend, the pose is sampled right at the clock
+        lodPosesValid = false;
+        if (sample && !sampleLocal(animationTime, localTransforms)) return false;
+    } else {
+        if (sample || (computePose && !lodPosesValid)) {
+            if (lodPosesValid) {
+                fromPose.swap(toPose);
+            } else if (!sampleLocal(animationTime, fromPose)) {
+                return false;
+            }
+            if (!sampleLocal(animationTime + sampleInterval, toPose)) return false;
+            sampledInterval = sampleInterval;
+            sinceSample = 0.0f;
+            lodPosesValid = true;
+        }
+        if (computePose) {
+            // Blend in local space; quaternions flipped onto the same hemisphere first,
+            // so the blend takes the short way round
+            const ozz::math::SimdFloat4 alpha = ozz::math::simd_float4::Load1(std::min(sinceSample / sampledInterval, 1.0f));
+            for (size_t i = 0; i < localTransforms.size(); i++) {
+                const ozz::math::SoaTransform& from = fromPose[i];
+                const ozz::math::SoaTransform& to = toPose[i];
+                const ozz::math::SimdInt4 sign = ozz::math::Sign(ozz::math::Dot(from.rotation, to.rotation));
+                const ozz::math::SoaQuaternion toRotation = {ozz::math::Xor(to.rotation.x, sign), ozz::math::Xor(to.rotation.y, sign),
+                                                             ozz::math::Xor(to.rotation.z, sign), ozz::math::Xor(to.rotation.w, sign)};
+                localTransforms[i].translation = ozz::math::Lerp(from.translation, to.translation, alpha);
+                localTransforms[i].rotation = ozz::math::NLerpEst(from.rotation, toRotation, alpha);
+                localTransforms[i].scale = ozz::math::Lerp(from.scale, to.scale, alpha);
+            }
+        }
+    }
+    
+    if (computePose) {
+        // Keep a copy: later frames that skip the pose reuse it
+        if (!computeSkinMatrices(skinMatrices.data())) return false;
+        skinMatricesCurrent = true;
+    }
+    std::copy(skinMatrices.begin(), skinMatrices.end(), skinOut);
+    return true;
+}
+
+bool OzzAnimationSystem::evaluateAt(float time, ozz::math::Float4x4* skinOut) {
+    if (!isLoaded() || !currentAnimation) return false;
+    
+    lodPosesValid = false;
+    if (!sampleLocal(time, localTransforms)) return false;
+    // Through this instance's own matrices, so a pose held after leaving the sharing tier
+    // is the one it last showed
+    if (!computeSkinMatrices(skinMatrices.data())) return false;
+    skinMatricesCurrent = true;
+    std::copy(skinMatrices.begin(), skinMatrices.end(), skinOut);
+    return true;
+}
+
+bool OzzAnimationSystem::sampleLocal(float time, ozz::vector<ozz::math::SoaTransform>& output) {
+    const float duration = currentAnimation->duration();
+    float ratio = looping ? std::fmod(time, duration) / duration : std::min(time / duration, 1.0f);
     
     // Sample animation
     ozz::animation::SamplingJob samplingJob;
     samplingJob.animation = currentAnimation;
     samplingJob.context = &samplingContext;
-    samplingJob.ratio = currentAnimation ? animationTime / currentAnimation->duration() : 0.0f;
-    samplingJob.output = make_span(localTransforms);
+    samplingJob.ratio = ratio;
+    samplingJob.output = make_span(output);
     
     if (!samplingJob.Run()) {
         std::cerr << "Animation sampling failed" << std::endl;
-        return;
+        return false;
     }
-    
+    return true;
+}
+
+bool OzzAnimationSystem::computeSkinMatrices(ozz::math::Float4x4* skinOut) {
     // No root motion compensation needed - using in-place animations
     
     // Convert to model space matrices
     ozz::animation::LocalToModelJob localToModelJob;
-    localToModelJob.skeleton = &skeleton;
+    localToModelJob.skeleton = &skeleton->skeleton;
     localToModelJob.input = make_span(localTransforms);
     localToModelJob.output = make_span(modelMatrices);
     
     if (!localToModelJob.Run()) {
         std::cerr << "Local to model conversion failed" << std::endl;
-        return;
+        return false;
     }
     
-    // DEBUG: Test with identity transforms to isolate joint ordering issue
-    static bool useIdentityTransforms = false; // Disabled - now implement joint mapping
-    
-    if (useIdentityTransforms) {
-        // Use identity transforms - this should show bind pose even with animation enabled
-        skinMatrices.resize(modelMatrices.size());
-        for (size_t i = 0; i < modelMatrices.size(); i++) {
-            // Create identity matrix
-            skinMatrices[i].cols[0] = ozz::math::simd_float4::Load(1.0f, 0.0f, 0.0f, 0.0f);
-            skinMatrices[i].cols[1] = ozz::math::simd_float4::Load(0.0f, 1.0f, 0.0f, 0.0f);
-            skinMatrices[i].cols[2] = ozz::math::simd_float4::Load(0.0f, 0.0f, 1.0f, 0.0f);
-            skinMatrices[i].cols[3] = ozz::math::simd_float4::Load(0.0f, 0.0f, 0.0f, 1.0f);
+    // Compute skin matrices by multiplying model matrices with inverse bind matrices
+    const size_t numJoints = modelMatrices.size();
+    if (skinBinding && skinBinding->inverseBindMatrices.size() == numJoints) {
+        const auto& inverseBindMatrices = skinBinding->inverseBindMatrices;
+        for (size_t i = 0; i < numJoints; i++) {
+            skinOut[i] = modelMatrices[i] * inverseBindMatrices[i];
         }
-        std::cout << "DEBUG: Using identity transforms to test joint mapping" << std::endl;
     } else {
-        // Compute skin matrices by multiplying model matrices with inverse bind matrices
-        if (inverseBindMatrices.size() == modelMatrices.size()) {
-            skinMatrices.resize(modelMatrices.size());
-            for (size_t i = 0; i < modelMatrices.size(); i++) {
-                skinMatrices[i] = modelMatrices[i] * inverseBindMatrices[i];
-            }
-            // std::cout << "Using proper skin matrices (model * inverse bind)" << std::endl;
-        } else {
-            // If no inverse bind matrices, use model matrices directly
-            skinMatrices = modelMatrices;
-            // std::cout << "Size mismatch - using model matrices directly (inv:" << inverseBindMatrices.size() << " vs model:" << modelMatrices.size() << ")" << std::endl;
-        }
+        // If no inverse bind matrices, use model matrices directly
+        std::copy(modelMatrices.begin(), modelMatrices.end(), skinOut);
     }
+    return true;
 }
 
 void OzzAnimationSystem::calculateBoneMatrices(float* outMatrices, size_t maxMatrices) {
@@ -123,7 +189,7 @@ void OzzAnimationSystem::calculateBoneMatrices(float* outMatrices, size_t maxMat
 }
 
 int OzzAnimationSystem::getNumBones() const {
-    return skeletonLoaded ? skeleton.num_joints() : 0;
+    return skeletonLoaded ? skeleton->skeleton.num_joints() : 0;
 }
 
 float OzzAnimationSystem::getAnimationDuration() const {
@@ -134,7 +200,7 @@ std::vector<std::string> OzzAnimationSystem::getJointNames() const {
     std::vector<std::string> names;
     if (!skeletonLoaded) return names;
     
-    const auto& jointNames = skeleton.joint_names();
+    const auto& jointNames = skeleton->skeleton.joint_names();
     names.reserve(jointNames.size());
     
     for (const auto& name : jointNames) {
@@ -145,92 +211,50 @@ std::vector<std::string> OzzAnimationSystem::getJointNames() const {
 }
 
 void OzzAnimationSystem::setInverseBindMatrices(const float* inverseBindMatrices, int numJoints) {
-    // Resize to match the skeleton size, padding with identity matrices if needed
-    int skeletonJoints = skeleton.num_joints();
-    this->inverseBindMatrices.resize(skeletonJoints);
+    if (!skeletonLoaded) return;
     
-    for (int i = 0; i < skeletonJoints; i++) {
-        ozz::math::Float4x4& ozzMatrix = this->inverseBindMatrices[i];
-        
-        if (i < numJoints) {
-            // Use provided inverse bind matrix
-            const float* matrix = inverseBindMatrices + (i * 16);
-            
-            // Convert from column-major float array to ozz::math::Float4x4
-            ozzMatrix.cols[0] = ozz::math::simd_float4::Load(matrix[0], matrix[1], matrix[2], matrix[3]);      // Column 0
-            ozzMatrix.cols[1] = ozz::math::simd_float4::Load(matrix[4], matrix[5], matrix[6], matrix[7]);      // Column 1
-            ozzMatrix.cols[2] = ozz::math::simd_float4::Load(matrix[8], matrix[9], matrix[10], matrix[11]);    // Column 2
-            ozzMatrix.cols[3] = ozz::math::simd_float4::Load(matrix[12], matrix[13], matrix[14], matrix[15]);  // Column 3
-        } else {
-            // Pad with identity matrix for missing joints
-            ozzMatrix.cols[0] = ozz::math::simd_float4::Load(1.0f, 0.0f, 0.0f, 0.0f);  // Column 0
-            ozzMatrix.cols[1] = ozz::math::simd_float4::Load(0.0f, 1.0f, 0.0f, 0.0f);  // Column 1
-            ozzMatrix.cols[2] = ozz::math::simd_float4::Load(0.0f, 0.0f, 1.0f, 0.0f);  // Column 2
-            ozzMatrix.cols[3] = ozz::math::simd_float4::Load(0.0f, 0.0f, 0.0f, 1.0f);  // Column 3
-        }
+    // glTF joint i maps straight to ozz joint i; joints past numJoints stay identity
+    std::vector<int> identityMapping(numJoints);
+    for (int i = 0; i < numJoints; i++) {
+        identityMapping[i] = i;
     }
+    int skeletonJoints = skeleton->skeleton.num_joints();
+    skinBinding = SkinBinding::create(skeletonJoints, inverseBindMatrices, numJoints, identityMapping);
     
     std::cout << "Set " << numJoints << " inverse bind matrices, padded to " << skeletonJoints << " for ozz skeleton" << std::endl;
 }
 
 void OzzAnimationSystem::setInverseBindMatricesWithMapping(const float* gltfInverseBindMatrices, int numGltfJoints, 
                                                           const std::vector<int>& gltfToOzzMapping) {
-    // Resize to match the skeleton size, initialize with identity matrices
-    int skeletonJoints = skeleton.num_joints();
-    this->inverseBindMatrices.resize(skeletonJoints);
-    
-    // Initialize all matrices to identity
-    for (int i = 0; i < skeletonJoints; i++) {
-        ozz::math::Float4x4& ozzMatrix = this->inverseBindMatrices[i];
-        ozzMatrix.cols[0] = ozz::math::simd_float4::Load(1.0f, 0.0f, 0.0f, 0.0f);  // Column 0
-        ozzMatrix.cols[1] = ozz::math::simd_float4::Load(0.0f, 1.0f, 0.0f, 0.0f);  // Column 1
-        ozzMatrix.cols[2] = ozz::math::simd_float4::Load(0.0f, 0.0f, 1.0f, 0.0f);  // Column 2
-        ozzMatrix.cols[3] = ozz::math::simd_float4::Load(0.0f, 0.0f, 0.0f, 1.0f);  // Column 3
-    }
+    if (!skeletonLoaded) return;
     
-    // Map glTF inverse bind matrices to their corresponding ozz joint positions
-    int mappedCount = 0;
-    for (int gltfIdx = 0; gltfIdx < numGltfJoints && gltfIdx < (int)gltfToOzzMapping.size(); gltfIdx++) {
-        int ozzIdx = gltfToOzzMapping[gltfIdx];
-        if (ozzIdx >= 0 && ozzIdx < skeletonJoints) {
-            // Copy the glTF inverse bind matrix to the correct ozz joint position
-            const float* matrix = gltfInverseBindMatrices + (gltfIdx * 16);
-            ozz::math::Float4x4& ozzMatrix = this->inverseBindMatrices[ozzIdx];
-            
-            // Convert from column-major float array to ozz::math::Float4x4
-            ozzMatrix.cols[0] = ozz::math::simd_float4::Load(matrix[0], matrix[1], matrix[2], matrix[3]);      // Column 0
-            ozzMatrix.cols[1] = ozz::math::simd_float4::Load(matrix[4], matrix[5], matrix[6], matrix[7]);      // Column 1
-            ozzMatrix.cols[2] = ozz::math::simd_float4::Load(matrix[8], matrix[9], matrix[10], matrix[11]);    // Column 2
-            ozzMatrix.cols[3] = ozz::math::simd_float4::Load(matrix[12], matrix[13], matrix[14], matrix[15]);  // Column 3
-            
-            mappedCount++;
-            std::cout << "INVERSE_BIND_DEBUG: Mapped glTF[" << gltfIdx << "] inverse bind -> ozz[" << ozzIdx << "]" << std::endl;
-        }
-    }
+    skinBinding = SkinBinding::create(skeleton->skeleton.num_joints(), gltfInverseBindMatrices, numGltfJoints,
+                                      gltfToOzzMapping);
     
-    std::cout << "Set " << mappedCount << "/" << numGltfJoints << " inverse bind matrices with proper joint mapping" << std::endl;
+    std::cout << "Set " << skinBinding->mappedJoints << "/" << numGltfJoints << " inverse bind matrices with proper joint mapping" << std::endl;
 }
 
-bool OzzAnimationSystem::loadAnimation(const std::string& name, const std::string& animationPath) {
-    auto newAnimation = std::make_unique<ozz::animation::Animation>();
-    
-    ozz::io::File file(animationPath.c_str(), "rb");
-    if (!file.opened()) {
-        std::cerr << "Failed to open animation file: " << animationPath << std::endl;
-        return false;
+void OzzAnimationSystem::setSkinBinding(std::shared_ptr<const SkinBinding> binding) {
+    if (binding && skeletonLoaded && (int)binding->inverseBindMatrices.size() != skeleton->skeleton.num_joints()) {
+        std::cerr << "Skin binding has " << binding->inverseBindMatrices.size() << " joints, skeleton has "
+                  << skeleton->skeleton.num_joints() << std::endl;
+        return;
     }
-    
-    ozz::io::IArchive archive(&file);
-    if (!archive.TestTag<ozz::animation::Animation>()) {
-        std::cerr << "Invalid animation file format: " << animationPath << std::endl;
-        return false;
+    skinBinding = std::move(binding);
+}
+
+bool OzzAnimationSystem::loadAnimation(const std::string& name, const std::string& animationPath) {
+    auto clip = AnimationLibrary::get().loadAnimation(animationPath);
+    if (!clip) return false;
+    
+    // Re-pointing a name that is current must not leave currentAnimation dangling
+    bool replacingCurrent = (name == currentAnimationName);
+    animations[name] = std::move(clip);
+    if (replacingCurrent) {
+        currentAnimation = &animations[name]->animation;
+        lodPosesValid = false;
     }
     
-    archive >> *newAnimation;
-    
-    std::cout << "Loaded animation '" << name << "' with duration: " << newAnimation->duration() << "s" << std::endl;
-    animations[name] = std::move(newAnimation);
-    
     // If this is the first animation, make it current
     if (currentAnimationName.empty()) {
         setCurrentAnimation(name);
@@ -243,9 +267,11 @@ bool OzzAnimationSystem::loadAnimation(const std::string& name, const std::strin
 void OzzAnimationSystem::setCurrentAnimation(const std::string& name) {
     auto it = animations.find(name);
     if (it != animations.end()) {
-        currentAnimation = it->second.get();
+        currentAnimation = &it->second->animation;
         currentAnimationName = name;
-        animationTime = 0.0f; // Reset time when switching animations
+        // Restart the clip at this instance's phase
+        animationTime = phaseOffset * currentAnimation->duration();
+        lodPosesValid = false;
         // std::cout << "Switched to animation: " << name << " (duration: " << currentAnimation->duration() << "s)" << std::endl;
     } else {
         std::cerr << "Animation '" << name << "' not found!" << std::endl;
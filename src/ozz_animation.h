@@ -7,6 +7,7 @@
 #include <ozz/geometry/runtime/skinning_job.h>
 #include <ozz/base/maths/soa_transform.h>
 #include <ozz/base/containers/vector.h>
+#include "animation_library.h"
 #include <string>
 #include <map>
 #include <memory>
@@ -16,13 +17,39 @@ public:
     OzzAnimationSystem() = default;
     ~OzzAnimationSystem() = default;
     
-    // Load skeleton and animation from ozz files
+    // Load skeleton and animation from ozz files, through the shared AnimationLibrary
     bool loadSkeleton(const std::string& skeletonPath);
     bool loadAnimation(const std::string& animationPath);
     bool loadAnimation(const std::string& name, const std::string& animationPath);
     
     // Update animation and get bone matrices
     void updateAnimation(float deltaTime);
+    
+    // updateAnimation in two steps, for AnimationUpdateStage: advance the clock, then sample
+    // and write one skin matrix per joint to skinOut (getNumBones() entries). evaluate only
+    // touches this instance's buffers, so different instances can evaluate in parallel.
+    void advance(float deltaTime);
+    bool evaluate(ozz::math::Float4x4* skinOut);
+    const ozz::animation::Animation* getCurrentClip() const { return currentAnimation; }
+    
+    // Reduced-rate evaluation for animation LOD. Poses are sampled sampleInterval seconds
+    // apart (0 = exactly at the clock each time), one interval ahead of the clock, and the
+    // two latest are blended to the current time. sample takes the next pose, computePose
+    // blends, converts to model space and skins into skinOut; without it the last skin
+    // matrices are copied instead.
+    void setSampleInterval(float seconds) { sampleInterval = seconds; }
+    bool needsSample() const;
+    bool evaluateLod(ozz::math::Float4x4* skinOut, bool sample, bool computePose);
+    // Pose sharing: sample at time instead of the clock, for a pose other instances on the
+    // same clip reuse. Both this and resetLodPoses drop the blended poses, so leaving a
+    // sharing tier starts from a fresh sample.
+    bool evaluateAt(float time, ozz::math::Float4x4* skinOut);
+    void resetLodPoses() { lodPosesValid = false; }
+    // The instances reusing a shared pose call this instead of evaluating: their own skin
+    // matrices (calculateBoneMatrices, skinVertices, a held pose) are stale until the next
+    // computed pose, so only the stage palette has the pose they show
+    void borrowPose() { lodPosesValid = false; skinMatricesCurrent = false; }
+    bool hasCurrentSkinMatrices() const { return skinMatricesCurrent; }
     void calculateBoneMatrices(float* outMatrices, size_t maxMatrices);
     void getBoneMatrices(std::vector<float>& outMatrices);
     
@@ -30,6 +57,10 @@ public:
     void setInverseBindMatrices(const float* inverseBindMatrices, int numJoints);
     void setInverseBindMatricesWithMapping(const float* gltfInverseBindMatrices, int numGltfJoints, 
                                           const std::vector<int>& gltfToOzzMapping);
+    // Use a binding shared with other instances of the same skeleton and model
+    void setSkinBinding(std::shared_ptr<const SkinBinding> binding);
+    const std::shared_ptr<const SkeletonAsset>& getSkeletonAsset() const { return skeleton; }
+    const SkinBinding* getSkinBinding() const { return skinBinding.get(); }
     
     // Native ozz skinning
     bool skinVertices(const float* inPositions, float* outPositions,
@@ -50,23 +81,39 @@ public:
     float getAnimationTime() const { return animationTime; }
     void setLoop(bool loop) { looping = loop; }
     void setCurrentAnimation(const std::string& name);
+    // Where in a clip (0-1) every clip starts, so NPCs switching together don't move in lockstep
+    void setPhaseOffset(float phase) { phaseOffset = phase; }
     std::string getCurrentAnimationName() const { return currentAnimationName; }
     
 private:
-    ozz::animation::Skeleton skeleton;
+    // Shared, immutable data owned by the AnimationLibrary
+    std::shared_ptr<const SkeletonAsset> skeleton;
+    std::map<std::string, std::shared_ptr<const AnimationAsset>> animations;  // All loaded animations
+    std::shared_ptr<const SkinBinding> skinBinding;  // Inverse bind matrices in ozz joint order
     const ozz::animation::Animation* currentAnimation = nullptr;  // Pointer to current active animation
-    std::map<std::string, std::unique_ptr<ozz::animation::Animation>> animations;  // All loaded animations
     std::string currentAnimationName = "";
     
+    bool sampleLocal(float time, ozz::vector<ozz::math::SoaTransform>& output);
+    bool computeSkinMatrices(ozz::math::Float4x4* skinOut);
+    
     // Runtime data
     ozz::vector<ozz::math::SoaTransform> localTransforms;
     ozz::vector<ozz::math::Float4x4> modelMatrices;
     ozz::vector<ozz::math::Float4x4> skinMatrices;  // Final matrices for skinning (model * inverseBind)
-    ozz::vector<ozz::math::Float4x4> inverseBindMatrices; // Inverse bind matrices
     ozz::animation::SamplingJob::Context samplingContext;
     
+    // Animation LOD: the two poses being blended, sampled sampledInterval apart
+    ozz::vector<ozz::math::SoaTransform> fromPose;
+    ozz::vector<ozz::math::SoaTransform> toPose;
+    float sampleInterval = 0.0f;
+    float sampledInterval = 0.0f;
+    float sinceSample = 0.0f;
+    bool lodPosesValid = false;
+    bool skinMatricesCurrent = false;  // skinMatrices hold this instance's latest computed pose
+    
     bool skeletonLoaded = false;
     bool animationLoaded = false;
     float animationTime = 0.0f;
+    float phaseOffset = 0.0f;
     bool looping = true;
 };
\ No newline at end of file
@@ -0,0 +1,710 @@
+#include "pathfinding.h"
+#include "terrain.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+
+static_assert(PathFinder::WALK_CELLS * PathFinder::SAMPLES_PER_CELL == TerrainChunk::CHUNK_SIZE,
+              "Walk cells must tile a chunk exactly");
+static_assert(PathFinder::SAMPLES_PER_CELL * TerrainChunk::SCALE == PathFinder::CELL_SIZE,
+              "CELL_SIZE must match the height grid spacing");
+
+namespace {
+
+constexpr int CELLS = PathFinder::WALK_CELLS;
+constexpr int CELL_COUNT = CELLS * CELLS;
+constexpr float INFINITE_COST = std::numeric_limits<float>::infinity();
+constexpr float DIAGONAL = 1.41421356f;
+
+// Entrances at least this long get a transition at each end instead of one in the middle,
+// so paths along a wide opening don't detour through its centre
+constexpr int LONG_ENTRANCE = 6;
+
+// Longest straight segment the path smoothing tries, in cells
+constexpr int MAX_SHORTCUT_CELLS = 32;
+
+// Snapped starts and goals (standing in water, clicking a cliff) look this far for ground
+constexpr int SNAP_RADIUS = 3;
+
+enum Side { WEST, EAST, NORTH, SOUTH };  // -x, +x, -z, +z; opposite side is side ^ 1
+constexpr int SIDE_DX[4] = {-1, 1, 0, 0};
+constexpr int SIDE_DZ[4] = {0, 0, -1, 1};
+
+uint64_t getChunkKey(int chunkX, int chunkZ) {
+    return ((uint64_t)(uint32_t)chunkX << 32) | (uint32_t)chunkZ;
+}
+
+int floorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// Cell at position i along one side of a cluster
+int getBorderCell(int side, int i) {
+    switch (side) {
+        case WEST:  return i * CELLS;
+        case EAST:  return i * CELLS + CELLS - 1;
+        case NORTH: return i;
+        default:    return (CELLS - 1) * CELLS + i;
+    }
+}
+
+float getStepCost(const uint8_t* costs, int from, int to, bool diagonal) {
+    return (diagonal ? DIAGONAL : 1.0f) * (costs[from] + costs[to]) * 0.5f;
+}
+
+// Octile distance, admissible since no cell costs less than 1 per unit
+float getOctileDistance(int dx, int dz) {
+    dx = std::abs(dx);
+    dz = std::abs(dz);
+    return (float)std::max(dx, dz) + (DIAGONAL - 1.0f) * std::min(dx, dz);
+}
+
+// Cheapest paths over one cluster's cells from start: Dijkstra when goal < 0, otherwise A*
+// that stops at goal. parent[] points back toward start.
+void searchCells(const uint8_t* costs, int start, int goal, float* distance, int16_t* parent) {
+    std::fill(distance, distance + CELL_COUNT, INFINITE_COST);
+    std::fill(parent, parent + CELL_COUNT, (int16_t)-1);
+
+    auto heuristic = [goal](int cell) {
+        return goal < 0 ? 0.0f : getOctileDistance(cell % CELLS - goal % CELLS, cell / CELLS - goal / CELLS);
+    };
+
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    distance[start] = 0.0f;
+    open.push({heuristic(start), start});
+
+    while (!open.empty()) {
+        Entry top = open.top();
+        open.pop();
+        int cell = top.second;
+        if (top.first > distance[cell] + heuristic(cell) + 1e-4f) continue;  // Stale entry
+        if (cell == goal) return;
+
+        int x = cell % CELLS;
+        int z = cell / CELLS;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dz == 0) continue;
+                int nx = x + dx;
+                int nz = z + dz;
+                if (nx < 0 || nx >= CELLS || nz < 0 || nz >= CELLS) continue;
+                int next = nz * CELLS + nx;
+                if (costs[next] == PathFinder::BLOCKED) continue;
+
+                // No cutting corners past blocked cells
+                bool diagonal = dx != 0 && dz != 0;
+                if (diagonal && (costs[z * CELLS + nx] == PathFinder::BLOCKED || costs[nz * CELLS + x] == PathFinder::BLOCKED)) {
+                    continue;
+                }
+
+                float cost = distance[cell] + getStepCost(costs, cell, next, diagonal);
+                if (cost < distance[next]) {
+                    distance[next] = cost;
+                    parent[next] = (int16_t)cell;
+                    open.push({cost + heuristic(next), next});
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+struct PathFinder::Cluster {
+    struct Transition {
+        uint16_t cell;      // Local cell on the border
+        uint8_t side;
+        uint8_t position;   // Index along the side, shared with the neighbour's transition
+    };
+
+    int chunkX, chunkZ;
+    std::shared_ptr<const std::vector<uint8_t>> costs;
+    std::vector<Transition> transitions;
+    int16_t borderTransitions[4][CELLS];  // Transition at each border position, -1 if none
+
+    // Cached cheapest paths between transitions (n x n, row = from)
+    std::vector<float> edgeCosts;                   // Infinite when not connected inside the cluster
+    std::vector<std::vector<uint16_t>> edgePaths;   // Local cells after the first, up to the last
+
+    int getGlobalX(int cell) const { return chunkX * CELLS + cell % CELLS; }
+    int getGlobalZ(int cell) const { return chunkZ * CELLS + cell / CELLS; }
+};
+
+struct PathFinder::Snapshot {
+    std::unordered_map<uint64_t, std::shared_ptr<const Cluster>> clusters;
+
+    const Cluster* find(int chunkX, int chunkZ) const {
+        auto found = clusters.find(getChunkKey(chunkX, chunkZ));
+        return found != clusters.end() ? found->second.get() : nullptr;
+    }
+};
+
+namespace {
+
+using Cluster = PathFinder::Cluster;
+using Snapshot = PathFinder::Snapshot;
+
+std::shared_ptr<const Cluster> buildCluster(int chunkX, int chunkZ, std::shared_ptr<const std::vector<uint8_t>> costs,
+                                            const std::shared_ptr<const std::vector<uint8_t>> neighbours[4]) {
+    auto cluster = std::make_shared<Cluster>();
+    cluster->chunkX = chunkX;
+    cluster->chunkZ = chunkZ;
+    cluster->costs = std::move(costs);
+    const uint8_t* own = cluster->costs->data();
+    std::fill(&cluster->borderTransitions[0][0], &cluster->borderTransitions[0][0] + 4 * CELLS, (int16_t)-1);
+
+    // Entrances: stretches of a border that are open on both sides. Both clusters see the
+    // same stretches, so their transitions pair up by position.
+    for (int side = 0; side < 4; side++) {
+        if (!neighbours[side]) continue;
+        const uint8_t* other = neighbours[side]->data();
+        auto isOpen = [&](int i) {
+            return own[getBorderCell(side, i)] != PathFinder::BLOCKED &&
+                   other[getBorderCell(side ^ 1, i)] != PathFinder::BLOCKED;
+        };
+        auto addTransition = [&](int i) {
+            cluster->borderTransitions[side][i] = (int16_t)cluster->transitions.size();
+            cluster->transitions.push_back({(uint16_t)getBorderCell(side, i), (uint8_t)side, (uint8_t)i});
+        };
+
+        int i = 0;
+        while (i < CELLS) {
+            if (!isOpen(i)) {
+                i++;
+                continue;
+            }
+            int begin = i;
+            while (i < CELLS && isOpen(i)) i++;
+            if (i - begin >= LONG_ENTRANCE) {
+                addTransition(begin);
+                addTransition(i - 1);
+            } else {
+                addTransition((begin + i - 1) / 2);
+            }
+        }
+    }
+
+    // Cache the cheapest path between every pair of transitions
+    const size_t count = cluster->transitions.size();
+    cluster->edgeCosts.assign(count * count, INFINITE_COST);
+    cluster->edgePaths.resize(count * count);
+    std::vector<float> distance(CELL_COUNT);
+    std::vector<int16_t> parent(CELL_COUNT);
+    for (size_t from = 0; from < count; from++) {
+        const int start = cluster->transitions[from].cell;
+        searchCells(own, start, -1, distance.data(), parent.data());
+        for (size_t to = 0; to < count; to++) {
+            const int end = cluster->transitions[to].cell;
+            if (to == from || distance[end] == INFINITE_COST) continue;
+            cluster->edgeCosts[from * count + to] = distance[end];
+
+            std::vector<uint16_t>& path = cluster->edgePaths[from * count + to];
+            for (int cell = end; cell != start; cell = parent[cell]) {
+                path.push_back((uint16_t)cell);
+            }
+            std::reverse(path.begin(), path.end());
+        }
+    }
+    return cluster;
+}
+
+// Walkability of global cells, remembering the last cluster since lookups are coherent
+struct CellLookup {
+    const Snapshot& snapshot;
+    const Cluster* last = nullptr;
+
+    explicit CellLookup(const Snapshot& snapshot) : snapshot(snapshot) {}
+
+    bool isWalkable(int cellX, int cellZ) {
+        int chunkX = floorDiv(cellX, CELLS);
+        int chunkZ = floorDiv(cellZ, CELLS);
+        if (!last || last->chunkX != chunkX || last->chunkZ != chunkZ) {
+            last = snapshot.find(chunkX, chunkZ);
+            if (!last) return false;
+        }
+        int local = (cellZ - chunkZ * CELLS) * CELLS + (cellX - chunkX * CELLS);
+        return (*last->costs)[local] != PathFinder::BLOCKED;
+    }
+};
+
+// Straight walk between two cell centres that only touches walkable cells
+bool hasLineOfSight(CellLookup& lookup, int fromX, int fromZ, int toX, int toZ) {
+    const int dx = toX - fromX;
+    const int dz = toZ - fromZ;
+    const int stepX = dx > 0 ? 1 : -1;
+    const int stepZ = dz > 0 ? 1 : -1;
+    const float tDeltaX = dx != 0 ? 1.0f / std::abs(dx) : INFINITE_COST;
+    const float tDeltaZ = dz != 0 ? 1.0f / std::abs(dz) : INFINITE_COST;
+    float tNextX = tDeltaX * 0.5f;
+    float tNextZ = tDeltaZ * 0.5f;
+
+    int x = fromX;
+    int z = fromZ;
+    while (x != toX || z != toZ) {
+        if (std::fabs(tNextX - tNextZ) < 1e-6f) {
+            // Through a corner: both cells beside it must be open
+            if (!lookup.isWalkable(x + stepX, z) || !lookup.isWalkable(x, z + stepZ)) return false;
+            x += stepX;
+            z += stepZ;
+            tNextX += tDeltaX;
+            tNextZ += tDeltaZ;
+        } else if (tNextX < tNextZ) {
+            x += stepX;
+            tNextX += tDeltaX;
+        } else {
+            z += stepZ;
+            tNextZ += tDeltaZ;
+        }
+        if (!lookup.isWalkable(x, z)) return false;
+    }
+    return true;
+}
+
+// Nearest walkable local cell within SNAP_RADIUS, -1 if there is none
+int snapToWalkable(const Cluster& cluster, int localX, int localZ) {
+    const uint8_t* costs = cluster.costs->data();
+    for (int radius = 0; radius <= SNAP_RADIUS; radius++) {
+        int best = -1;
+        int bestDistance = std::numeric_limits<int>::max();
+        for (int z = localZ - radius; z <= localZ + radius; z++) {
+            for (int x = localX - radius; x <= localX + radius; x++) {
+                if (x < 0 || x >= CELLS || z < 0 || z >= CELLS) continue;
+                if (std::max(std::abs(x - localX), std::abs(z - localZ)) != radius) continue;  // Ring only
+                int distance = (x - localX) * (x - localX) + (z - localZ) * (z - localZ);
+                if (costs[z * CELLS + x] != PathFinder::BLOCKED && distance < bestDistance) {
+                    best = z * CELLS + x;
+                    bestDistance = distance;
+                }
+            }
+        }
+        if (best >= 0) return best;
+    }
+    return -1;
+}
+
+// Abstract node key: chunk coordinates (24 bits each) and transition index
+uint64_t getNodeKey(const Cluster& cluster, int transition) {
+    return ((uint64_t)((uint32_t)cluster.chunkX & 0xFFFFFF) << 40) |
+           ((uint64_t)((uint32_t)cluster.chunkZ & 0xFFFFFF) << 16) | (uint64_t)transition;
+}
+
+constexpr uint64_t START_NODE = ~0ull - 1;
+constexpr uint64_t GOAL_NODE = ~0ull;
+
+struct GlobalCell {
+    int x, z;
+};
+
+// Merge cells into waypoints wherever a straight line would cross blocked ground
+void smoothPath(const Snapshot& snapshot, const std::vector<GlobalCell>& cells, std::vector<PathPoint>& waypoints) {
+    CellLookup lookup(snapshot);
+    auto toPoint = [](const GlobalCell& cell) {
+        return PathPoint{(cell.x + 0.5f) * PathFinder::CELL_SIZE, (cell.z + 0.5f) * PathFinder::CELL_SIZE};
+    };
+
+    size_t anchor = 0;
+    for (size_t i = 2; i < cells.size(); i++) {
+        const GlobalCell& from = cells[anchor];
+        bool tooLong = std::max(std::abs(cells[i].x - from.x), std::abs(cells[i].z - from.z)) > MAX_SHORTCUT_CELLS;
+        if (tooLong || !hasLineOfSight(lookup, from.x, from.z, cells[i].x, cells[i].z)) {
+            anchor = i - 1;
+            waypoints.push_back(toPoint(cells[anchor]));
+        }
+    }
+    if (cells.size() > 1) {
+        waypoints.push_back(toPoint(cells.back()));
+    }
+}
+
+PathResult searchPath(const Snapshot& snapshot, float startX, float startZ, float goalX, float goalZ) {
+    PathResult result;
+
+    const int startCellX = (int)std::floor(startX / PathFinder::CELL_SIZE);
+    const int startCellZ = (int)std::floor(startZ / PathFinder::CELL_SIZE);
+    const int goalCellX = (int)std::floor(goalX / PathFinder::CELL_SIZE);
+    const int goalCellZ = (int)std::floor(goalZ / PathFinder::CELL_SIZE);
+    const Cluster* startCluster = snapshot.find(floorDiv(startCellX, CELLS), floorDiv(startCellZ, CELLS));
+    const Cluster* goalCluster = snapshot.find(floorDiv(goalCellX, CELLS), floorDiv(goalCellZ, CELLS));
+    if (!startCluster || !goalCluster) {
+        return result;
+    }
+
+    result.outcome = PathResult::Outcome::UNREACHABLE;
+    const int start = snapToWalkable(*startCluster, startCellX - startCluster->chunkX * CELLS, startCellZ - startCluster->chunkZ * CELLS);
+    const int goal = snapToWalkable(*goalCluster, goalCellX - goalCluster->chunkX * CELLS, goalCellZ - goalCluster->chunkZ * CELLS);
+    if (start < 0 || goal < 0) {
+        return result;
+    }
+
+    std::vector<float> startDistance(CELL_COUNT), goalDistance(CELL_COUNT);
+    std::vector<int16_t> startParent(CELL_COUNT), goalParent(CELL_COUNT);
+    std::vector<GlobalCell> cells;
+    auto appendCell = [&cells](const Cluster& cluster, int cell) {
+        cells.push_back({cluster.getGlobalX(cell), cluster.getGlobalZ(cell)});
+    };
+
+    // Trips inside one chunk stay on the cell grid if they can
+    bool found = false;
+    if (startCluster == goalCluster) {
+        searchCells(startCluster->costs->data(), start, goal, startDistance.data(), startParent.data());
+        if (startDistance[goal] != INFINITE_COST) {
+            for (int cell = goal; cell != start; cell = startParent[cell]) {
+                appendCell(*startCluster, cell);
+            }
+            appendCell(*startCluster, start);
+            std::reverse(cells.begin(), cells.end());
+            found = true;
+        }
+    }
+
+    if (!found) {
+        // Costs from the start to its cluster's transitions and from the goal's transitions
+        // to the goal (steps cost the same both ways)
+        searchCells(startCluster->costs->data(), start, -1, startDistance.data(), startParent.data());
+        searchCells(goalCluster->costs->data(), goal, -1, goalDistance.data(), goalParent.data());
+
+        struct NodeRecord {
+            float cost = INFINITE_COST;
+            uint64_t parent = 0;
+            const Cluster* cluster = nullptr;
+            int transition = -1;
+            bool closed = false;
+        };
+        std::unordered_map<uint64_t, NodeRecord> records;
+        using Entry = std::pair<float, uint64_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+        const int goalGlobalX = goalCluster->getGlobalX(goal);
+        const int goalGlobalZ = goalCluster->getGlobalZ(goal);
+        auto relax = [&](uint64_t key, float cost, uint64_t parent, const Cluster* cluster, int transition) {
+            NodeRecord& record = records[key];
+            if (record.closed || cost >= record.cost) return;
+            record.cost = cost;
+            record.parent = parent;
+            record.cluster = cluster;
+            record.transition = transition;
+            float estimate = 0.0f;
+            if (cluster) {
+                int cell = cluster->transitions[transition].cell;
+                estimate = getOctileDistance(cluster->getGlobalX(cell) - goalGlobalX, cluster->getGlobalZ(cell) - goalGlobalZ);
+            }
+            open.push({cost + estimate, key});
+        };
+
+        for (size_t t = 0; t < startCluster->transitions.size(); t++) {
+            float cost = startDistance[startCluster->transitions[t].cell];
+            if (cost != INFINITE_COST) {
+                relax(getNodeKey(*startCluster, (int)t), cost, START_NODE, startCluster, (int)t);
+            }
+        }
+
+        while (!open.empty()) {
+            uint64_t key = open.top().second;
+            open.pop();
+            if (key == GOAL_NODE) {
+                found = true;
+                break;
+            }
+            NodeRecord& record = records[key];
+            if (record.closed) continue;
+            record.closed = true;
+            if (++result.expandedNodes > PathFinder::MAX_ABSTRACT_EXPANSIONS) break;
+
+            const Cluster& cluster = *record.cluster;
+            const int transition = record.transition;
+            const Cluster::Transition& here = cluster.transitions[transition];
+            const float cost = record.cost;
+            const size_t count = cluster.transitions.size();
+
+            if (&cluster == goalCluster && goalDistance[here.cell] != INFINITE_COST) {
+                relax(GOAL_NODE, cost + goalDistance[here.cell], key, nullptr, -1);
+            }
+
+            // Along the cached paths inside this cluster
+            for (size_t other = 0; other < count; other++) {
+                float edgeCost = cluster.edgeCosts[transition * count + other];
+                if (edgeCost != INFINITE_COST) {
+                    relax(getNodeKey(cluster, (int)other), cost + edgeCost, key, &cluster, (int)other);
+                }
+            }
+
+            // Across the border to the paired transition
+            const Cluster* neighbour = snapshot.find(cluster.chunkX + SIDE_DX[here.side], cluster.chunkZ + SIDE_DZ[here.side]);
+            if (neighbour) {
+                int partner = neighbour->borderTransitions[here.side ^ 1][here.position];
+                if (partner >= 0) {
+                    int partnerCell = neighbour->transitions[partner].cell;
+                    float stepCost = ((*cluster.costs)[here.cell] + (*neighbour->costs)[partnerCell]) * 0.5f;
+                    relax(getNodeKey(*neighbour, partner), cost + stepCost, key, neighbour, partner);
+                }
+            }
+        }
+        if (!found) {
+            return result;
+        }
+
+        // Nodes from the start to the goal
+        std::vector<const NodeRecord*> chain;
+        for (uint64_t key = records[GOAL_NODE].parent; key != START_NODE; key = records[key].parent) {
+            chain.push_back(&records[key]);
+        }
+        std::reverse(chain.begin(), chain.end());
+
+        // Start to the first transition, from the start search's parents
+        const NodeRecord& first = *chain.front();
+        for (int cell = first.cluster->transitions[first.transition].cell; cell != start; cell = startParent[cell]) {
+            appendCell(*startCluster, cell);
+        }
+        appendCell(*startCluster, start);
+        std::reverse(cells.begin(), cells.end());
+
+        // Transition to transition: cached paths inside clusters, single steps across borders
+        for (size_t i = 1; i < chain.size(); i++) {
+            const NodeRecord& from = *chain[i - 1];
+            const NodeRecord& to = *chain[i];
+            if (from.cluster == to.cluster) {
+                size_t count = from.cluster->transitions.size();
+                for (uint16_t cell : from.cluster->edgePaths[from.transition * count + to.transition]) {
+                    appendCell(*from.cluster, cell);
+                }
+            } else {
+                appendCell(*to.cluster, to.cluster->transitions[to.transition].cell);
+            }
+        }
+
+        // Last transition to the goal; the goal search's parents lead toward the goal
+        const NodeRecord& last = *chain.back();
+        for (int cell = goalParent[last.cluster->transitions[last.transition].cell]; cell >= 0; cell = goalParent[cell]) {
+            appendCell(*goalCluster, cell);
+        }
+    }
+
+    result.outcome = PathResult::Outcome::FOUND;
+    smoothPath(snapshot, cells, result.waypoints);
+
+    // End exactly where asked when that spot is walkable
+    const bool goalSnapped = goal != (goalCellZ - goalCluster->chunkZ * CELLS) * CELLS + (goalCellX - goalCluster->chunkX * CELLS);
+    if (!goalSnapped) {
+        if (result.waypoints.empty()) {
+            result.waypoints.push_back({goalX, goalZ});
+        } else {
+            result.waypoints.back() = {goalX, goalZ};
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+void PathFinder::buildWalkCosts(const std::vector<uint16_t>& samples, float minHeight, float heightScale,
+                                std::vector<uint8_t>& costs) {
+    const int sampleRow = TerrainChunk::CHUNK_SIZE + 1;
+    costs.assign(CELL_COUNT, BLOCKED);
+    if (samples.size() < (size_t)(sampleRow * sampleRow)) return;
+
+    // Rise across the cell's samples over the cell width; anything wet is blocked
+    for (int cellZ = 0; cellZ < CELLS; cellZ++) {
+        for (int cellX = 0; cellX < CELLS; cellX++) {
+            uint16_t lo = 65535, hi = 0;
+            for (int z = cellZ * SAMPLES_PER_CELL; z <= (cellZ + 1) * SAMPLES_PER_CELL; z++) {
+                for (int x = cellX * SAMPLES_PER_CELL; x <= (cellX + 1) * SAMPLES_PER_CELL; x++) {
+                    lo = std::min(lo, samples[z * sampleRow + x]);
+                    hi = std::max(hi, samples[z * sampleRow + x]);
+                }
+            }
+
+            float lowest = minHeight + lo * heightScale;
+            float slope = (hi - lo) * heightScale / CELL_SIZE;
+            if (lowest < SEA_LEVEL || slope > MAX_SLOPE) continue;
+            costs[cellZ * CELLS + cellX] = (uint8_t)(1 + (int)(slope / MAX_SLOPE * (MAX_COST - 1) + 0.5f));
+        }
+    }
+}
+
+PathFinder::PathFinder(ThreadPool& workerPool)
+    : workerPool(workerPool), snapshot(std::make_shared<Snapshot>()) {}
+
+PathFinder::~PathFinder() {
+    // Builds still on the workers only hold their own copies of the cost grids
+    pendingBuilds.clear();
+}
+
+void PathFinder::addChunk(int chunkX, int chunkZ, const std::vector<uint8_t>& costs) {
+    if (costs.size() != (size_t)CELL_COUNT) return;
+
+    ChunkEntry& entry = chunks[getChunkKey(chunkX, chunkZ)];
+    entry.chunkX = chunkX;
+    entry.chunkZ = chunkZ;
+    entry.costs = std::make_shared<const std::vector<uint8_t>>(costs);
+    dirtyChunks.insert(getChunkKey(chunkX, chunkZ));
+    markNeighboursDirty(chunkX, chunkZ);
+}
+
+void PathFinder::removeChunk(int chunkX, int chunkZ) {
+    const uint64_t key = getChunkKey(chunkX, chunkZ);
+    chunks.erase(key);
+    dirtyChunks.erase(key);
+    if (clusters.erase(key) > 0) {
+        clustersChanged = true;
+    }
+    markNeighboursDirty(chunkX, chunkZ);
+}
+
+void PathFinder::markNeighboursDirty(int chunkX, int chunkZ) {
+    for (int side = 0; side < 4; side++) {
+        uint64_t key = getChunkKey(chunkX + SIDE_DX[side], chunkZ + SIDE_DZ[side]);
+        if (chunks.count(key)) {
+            dirtyChunks.insert(key);
+        }
+    }
+}
+
+void PathFinder::update() {
+    // Publish finished builds unless their chunk was rebuilt or unloaded since
+    for (size_t i = 0; i < pendingBuilds.size();) {
+        PendingBuild& build = pendingBuilds[i];
+        if (build.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            i++;
+            continue;
+        }
+
+        std::shared_ptr<const Cluster> cluster = build.result.get();
+        auto entry = chunks.find(build.key);
+        if (entry != chunks.end() && entry->second.generation == build.generation) {
+            clusters[build.key] = std::move(cluster);
+            clustersChanged = true;
+        }
+        pendingBuilds[i] = std::move(pendingBuilds.back());
+        pendingBuilds.pop_back();
+    }
+
+    // Rebuild changed clusters against their current neighbours
+    for (uint64_t key : dirtyChunks) {
+        auto found = chunks.find(key);
+        if (found == chunks.end()) continue;
+        ChunkEntry& entry = found->second;
+        entry.generation++;
+
+        std::shared_ptr<const std::vector<uint8_t>> neighbours[4];
+        for (int side = 0; side < 4; side++) {
+            auto neighbour = chunks.find(getChunkKey(entry.chunkX + SIDE_DX[side], entry.chunkZ + SIDE_DZ[side]));
+            if (neighbour != chunks.end()) {
+                neighbours[side] = neighbour->second.costs;
+            }
+        }
+
+        int chunkX = entry.chunkX, chunkZ = entry.chunkZ;
+        std::shared_ptr<const std::vector<uint8_t>> costs = entry.costs;
+        PendingBuild build;
+        build.key = key;
+        build.generation = entry.generation;
+        build.result = workerPool.submit([chunkX, chunkZ, costs, neighbours]() {
+            return buildCluster(chunkX, chunkZ, costs, neighbours);
+        });
+        pendingBuilds.push_back(std::move(build));
+    }
+    dirtyChunks.clear();
+
+    if (clustersChanged) {
+        auto next = std::make_shared<Snapshot>();
+        next->clusters = clusters;
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        snapshot = std::move(next);
+        clustersChanged = false;
+    }
+}
+
+std::shared_ptr<const PathFinder::Snapshot> PathFinder::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return snapshot;
+}
+
+std::future<PathResult> PathFinder::requestPath(float startX, float startZ, float goalX, float goalZ) const {
+    requestCount++;
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    return workerPool.submit([current, startX, startZ, goalX, goalZ]() {
+        return searchPath(*current, startX, startZ, goalX, goalZ);
+    });
+}
+
+PathResult PathFinder::findPath(float startX, float startZ, float goalX, float goalZ) const {
+    requestCount++;
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    return searchPath(*current, startX, startZ, goalX, goalZ);
+}
+
+bool PathFinder::isWalkable(float worldX, float worldZ) const {
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    CellLookup lookup(*current);
+    return lookup.isWalkable((int)std::floor(worldX / CELL_SIZE), (int)std::floor(worldZ / CELL_SIZE));
+}
+
+PathFinder::Stats PathFinder::getStats() const {
+    Stats stats;
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    stats.clusters = current->clusters.size();
+    for (const auto& entry : current->clusters) {
+        stats.transitions += entry.second->transitions.size();
+    }
+    stats.pendingBuilds = pendingBuilds.size();
+    stats.requests = requestCount.load();
+    return stats;
+}
+
+// PathFollower implementation
+void PathFollower::request(const PathFinder& pathFinder, float fromX, float fromZ, float toX, float toZ) {
+    pending = pathFinder.requestPath(fromX, fromZ, toX, toZ);
+    waypoints.clear();
+    nextWaypoint = 0;
+    status = Status::PENDING;
+}
+
+void PathFollower::clear() {
+    // Dropping the future doesn't wait for the search; its result is just discarded
+    pending = std::future<PathResult>();
+    waypoints.clear();
+    nextWaypoint = 0;
+    status = Status::NONE;
+}
+
+PathFollower::Status PathFollower::poll() {
+    if (status != Status::PENDING || pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return status;
+    }
+
+    PathResult result = pending.get();
+    switch (result.outcome) {
+        case PathResult::Outcome::FOUND:
+            waypoints = std::move(result.waypoints);
+            nextWaypoint = 0;
+            status = Status::FOLLOWING;
+            break;
+        case PathResult::Outcome::UNREACHABLE:
+            status = Status::FAILED;
+            break;
+        case PathResult::Outcome::NOT_LOADED:
+            status = Status::DIRECT;
+            break;
+    }
+    return status;
+}
+
+void PathFollower::steer(float x, float z, float reachRadius, float& targetX, float& targetZ) {
+    if (status != Status::FOLLOWING || waypoints.empty()) return;
+
+    // Pass waypoints we're on top of, but always keep the last one
+    while (nextWaypoint + 1 < waypoints.size()) {
+        float dx = waypoints[nextWaypoint].x - x;
+        float dz = waypoints[nextWaypoint].z - z;
+        if (dx * dx + dz * dz > reachRadius * reachRadius) break;
+        nextWaypoint++;
+    }
+    targetX = waypoints[nextWaypoint].x;
+    targetZ = waypoints[nextWaypoint].z;
+}
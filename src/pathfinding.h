@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class ThreadPool;
+
+struct PathPoint {
+    float x, z;
+};
+
+struct PathResult {
+    enum class Outcome {
+        FOUND,
+        UNREACHABLE,  // Searched the loaded terrain and found no way there
+        NOT_LOADED    // Start or goal is outside the chunks the graph knows about
+    };
+
+    Outcome outcome = Outcome::NOT_LOADED;
+    std::vector<PathPoint> waypoints;  // World x/z after the start; the last one is the goal
+    int expandedNodes = 0;             // Abstract graph nodes, for profiling
+};
+
+// Walkability over the loaded terrain and hierarchical A* (HPA*) across it.
+//
+// Every chunk has a WALK_CELLS x WALK_CELLS cost grid (one cell per world unit) built from
+// its height tile. Cells under water or steeper than MAX_SLOPE are blocked, and the rest
+// cost more the steeper they are. Each loaded chunk is a cluster of the abstract graph.
+// Transitions sit on the open stretches of its borders with loaded neighbours, and the
+// cheapest path between every pair of a cluster's transitions is cached when the cluster
+// is built. A search runs A* over the transitions and splices the cached paths together,
+// so its cost grows with the number of chunks crossed rather than the number of cells.
+//
+// Clusters are rebuilt on the worker pool whenever a chunk or one of its neighbours loads
+// or unloads. Searches read an immutable snapshot of the graph, so they can run on any
+// thread while streaming carries on.
+class PathFinder {
+public:
+    static constexpr int WALK_CELLS = 32;              // Per chunk side
+    static constexpr int SAMPLES_PER_CELL = 2;         // Height grid cells per walk cell side
+    static constexpr float CELL_SIZE = 1.0f;           // World units
+    static constexpr float MAX_SLOPE = 1.0f;           // Rise per unit of run that is still walkable
+    static constexpr uint8_t BLOCKED = 0;
+    static constexpr uint8_t MAX_COST = 8;             // Cost of the steepest walkable cell (flat = 1)
+    static constexpr int MAX_ABSTRACT_EXPANSIONS = 8192;
+
+    // Cost grid for one chunk from its quantized height samples ((64 + 1)^2, as HeightTile)
+    static void buildWalkCosts(const std::vector<uint16_t>& samples, float minHeight, float heightScale,
+                               std::vector<uint8_t>& costs);
+
+    explicit PathFinder(ThreadPool& workerPool);
+    ~PathFinder();
+
+    PathFinder(const PathFinder&) = delete;
+    PathFinder& operator=(const PathFinder&) = delete;
+
+    // Main thread: the chunks the graph covers
+    void addChunk(int chunkX, int chunkZ, const std::vector<uint8_t>& costs);
+    void removeChunk(int chunkX, int chunkZ);
+
+    // Main thread, once per frame: start cluster rebuilds and publish finished ones
+    void update();
+
+    // Search on the worker pool against the current graph
+    std::future<PathResult> requestPath(float startX, float startZ, float goalX, float goalZ) const;
+
+    // The same search on the calling thread
+    PathResult findPath(float startX, float startZ, float goalX, float goalZ) const;
+
+    // False for blocked cells and for positions outside the graph
+    bool isWalkable(float worldX, float worldZ) const;
+
+    struct Stats {
+        size_t clusters = 0;
+        size_t transitions = 0;
+        size_t pendingBuilds = 0;
+        uint64_t requests = 0;
+    };
+    Stats getStats() const;
+
+    struct Cluster;
+    struct Snapshot;
+
+private:
+    struct ChunkEntry {
+        int chunkX, chunkZ;
+        std::shared_ptr<const std::vector<uint8_t>> costs;
+        uint32_t generation = 0;  // Bumped per rebuild so stale builds are dropped
+    };
+
+    struct PendingBuild {
+        uint64_t key;
+        uint32_t generation;
+        std::future<std::shared_ptr<const Cluster>> result;
+    };
+
+    void markNeighboursDirty(int chunkX, int chunkZ);
+    std::shared_ptr<const Snapshot> getSnapshot() const;
+
+    ThreadPool& workerPool;
+
+    // Main thread only
+    std::unordered_map<uint64_t, ChunkEntry> chunks;
+    std::unordered_map<uint64_t, std::shared_ptr<const Cluster>> clusters;
+    std::unordered_set<uint64_t> dirtyChunks;
+    std::vector<PendingBuild> pendingBuilds;
+    bool clustersChanged = false;
+
+    // Published copy of clusters for the searches
+    std::shared_ptr<const Snapshot> snapshot;
+    mutable std::mutex snapshotMutex;
+    mutable std::atomic<uint64_t> requestCount{0};
+};
+
+// Steering along a path requested from a PathFinder, for anything that walks
+struct PathFollower {
+    enum class Status {
+        NONE,       // No path requested, steer straight at the target
+        PENDING,    // Search still running
+        FOLLOWING,  // Steering along waypoints
+        DIRECT,     // The graph doesn't cover the trip, steer straight at the target
+        FAILED      // No way to the target
+    };
+
+    Status status = Status::NONE;
+    std::future<PathResult> pending;
+    std::vector<PathPoint> waypoints;
+    size_t nextWaypoint = 0;
+
+    void request(const PathFinder& pathFinder, float fromX, float fromZ, float toX, float toZ);
+    void clear();
+
+    // Pick up a finished search; returns the updated status
+    Status poll();
+
+    // Replace targetX/targetZ with the waypoint to head for when following a path.
+    // Waypoints closer than reachRadius are passed.
+    void steer(float x, float z, float reachRadius, float& targetX, float& targetZ);
+};
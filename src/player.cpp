@@ -34,6 +34,24 @@ bool Player::canTakeDamage(float currentTime) const {
     return (currentTime - lastDamageTime) > 1.0f; // 1 second damage immunity
 }
 
+bx::Vec3 Player::getVelocity(float deltaTime) const {
+    if (!hasTarget || inCombat || deltaTime <= 0.0f) {
+        return {0.0f, 0.0f, 0.0f};
+    }
+
+    float dx = targetPosition.x - position.x;
+    float dz = targetPosition.z - position.z;
+    float distance = bx::sqrt(dx * dx + dz * dz);
+    if (distance < 0.1f) {
+        return {0.0f, 0.0f, 0.0f};
+    }
+
+    // Same per-frame step as Player::update, converted to a rate
+    float athleticsModifier = skills.getSkill(SkillType::ATHLETICS).getModifier();
+    float speed = (isSprinting ? sprintSpeed : moveSpeed) * athleticsModifier / deltaTime;
+    return {dx / distance * speed, 0.0f, dz / distance * speed};
+}
+
 void Player::heal(int amount) {
     health = bx::min(maxHealth, health + amount);
     std::cout << "Player healed " << amount << " HP! Health: " << health << "/" << maxHealth << std::endl;
@@ -43,6 +61,7 @@ void Player::respawn() {
     health = maxHealth;
     position = {0.0f, 0.0f, 0.0f}; // Reset to spawn point
     hasTarget = false;
+    path.clear();
     lastDamageTime = 0.0f;
 }
 
@@ -3,6 +3,7 @@
 #include <bx/math.h>
 #include <iostream>
 #include "skills.h"
+#include "pathfinding.h"
 
 // Forward declarations
 struct NPC;
@@ -14,6 +15,7 @@ struct Player {
     bx::Vec3 position;
     bx::Vec3 targetPosition;
     bool hasTarget;
+    PathFollower path;       // Route to targetPosition for click-to-move
     bool isSprinting;
     float moveSpeed;
     float sprintSpeed;
@@ -53,6 +55,9 @@ struct Player {
     void update(const ChunkManager& chunkManager, float currentTime, float deltaTime);
     void takeDamage(int damage, float currentTime);
     bool canTakeDamage(float currentTime) const;
+
+    // Movement toward targetPosition in world units per second (zero when standing still)
+    bx::Vec3 getVelocity(float deltaTime) const;
     void heal(int amount);
     void respawn();
     void renderHealthBar(UIRenderer& uiRenderer, float screenWidth) const;
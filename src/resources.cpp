@@ -4,7 +4,9 @@
 
 // ResourceNode implementation
 ResourceNode::ResourceNode(float x, float y, float z, ResourceType resourceType, int hp) 
-    : position({x, y, z}), type(resourceType), health(hp), maxHealth(hp), size(0.5f), isActive(true) {}
+    : position({x, y, z}), type(resourceType), health(hp), maxHealth(hp), size(0.5f), isActive(true) {
+    boundingRadius = size * 1.7320508f; // Cube mesh spans -1..1 on each axis, scaled by size
+}
 
 bool ResourceNode::canMine() const {
     return isActive && health > 0;
@@ -21,7 +21,12 @@ struct ResourceNode {
     int health;
     int maxHealth;
     float size;
+    float boundingRadius;  // Culling sphere around the node's cube
     bool isActive;
+
+    // Owning chunk and the index of this node in its resourceSpawns, -1 if not chunk-owned
+    int chunkX = 0, chunkZ = 0;
+    int spawnIndex = -1;
     
     ResourceNode(float x, float y, float z, ResourceType resourceType, int hp = 100);
     
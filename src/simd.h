@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Small SIMD float wrapper used by the terrain kernels and culling.
+// SimdFloat is the widest type the compiler targets (AVX2 8-wide, SSE2/NEON 4-wide),
+// ScalarFloat is the 1-wide fallback with the same interface so kernels can be
+// written once as templates.
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SIMD_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define SIMD_NEON 1
+#endif
+
+namespace Simd {
+
+// Polynomial coefficients for sin/cos on [-pi/4, pi/4]
+constexpr float kTwoOverPi = 0.636619772f;
+constexpr float kPiOver2Hi = 1.57079637f;      // pi/2 split for Cody-Waite reduction
+constexpr float kPiOver2Lo = -4.37113883e-8f;
+constexpr float kSinCoeffs[4] = { -1.0f / 6.0f, 1.0f / 120.0f, -1.0f / 5040.0f, 1.0f / 362880.0f };
+constexpr float kCosCoeffs[4] = { -1.0f / 2.0f, 1.0f / 24.0f, -1.0f / 720.0f, 1.0f / 40320.0f };
+
+template <typename V>
+inline V sinPoly(V r) {
+    V r2 = r * r;
+    V p = V(kSinCoeffs[3]);
+    p = p * r2 + V(kSinCoeffs[2]);
+    p = p * r2 + V(kSinCoeffs[1]);
+    p = p * r2 + V(kSinCoeffs[0]);
+    return r + r * r2 * p;
+}
+
+template <typename V>
+inline V cosPoly(V r) {
+    V r2 = r * r;
+    V p = V(kCosCoeffs[3]);
+    p = p * r2 + V(kCosCoeffs[2]);
+    p = p * r2 + V(kCosCoeffs[1]);
+    p = p * r2 + V(kCosCoeffs[0]);
+    return V(1.0f) + r2 * p;
+}
+
+// Scalar fallback
+struct ScalarFloat {
+    static constexpr int kWidth = 1;
+    static constexpr const char* kName = "scalar";
+    using Mask = bool;
+
+    float v;
+
+    ScalarFloat() = default;
+    ScalarFloat(float s) : v(s) {}
+
+    static ScalarFloat load(const float* p) { return ScalarFloat(*p); }
+    void store(float* p) const { *p = v; }
+};
+
+inline ScalarFloat operator+(ScalarFloat a, ScalarFloat b) { return ScalarFloat(a.v + b.v); }
+inline ScalarFloat operator-(ScalarFloat a, ScalarFloat b) { return ScalarFloat(a.v - b.v); }
+inline ScalarFloat operator*(ScalarFloat a, ScalarFloat b) { return ScalarFloat(a.v * b.v); }
+inline ScalarFloat operator/(ScalarFloat a, ScalarFloat b) { return ScalarFloat(a.v / b.v); }
+inline ScalarFloat min(ScalarFloat a, ScalarFloat b) { return ScalarFloat(a.v < b.v ? a.v : b.v); }
+inline ScalarFloat max(ScalarFloat a, ScalarFloat b) { return ScalarFloat(a.v > b.v ? a.v : b.v); }
+inline ScalarFloat abs(ScalarFloat a) { return ScalarFloat(std::fabs(a.v)); }
+inline bool lessThan(ScalarFloat a, ScalarFloat b) { return a.v < b.v; }
+inline bool greaterThan(ScalarFloat a, ScalarFloat b) { return a.v > b.v; }
+inline bool any(bool m) { return m; }
+inline bool all(bool m) { return m; }
+inline int bitmask(bool m) { return m ? 1 : 0; }
+inline ScalarFloat select(bool m, ScalarFloat a, ScalarFloat b) { return m ? a : b; }
+
+inline ScalarFloat sinQuadrant(ScalarFloat a, int32_t quadrantOffset) {
+    int32_t q = (int32_t)std::lrint(a.v * kTwoOverPi);
+    float qf = (float)q;
+    ScalarFloat r = ScalarFloat(a.v - qf * kPiOver2Hi - qf * kPiOver2Lo);
+    q += quadrantOffset;
+    float result = (q & 1) ? cosPoly(r).v : sinPoly(r).v;
+    return ScalarFloat((q & 2) ? -result : result);
+}
+
+inline ScalarFloat sin(ScalarFloat a) { return sinQuadrant(a, 0); }
+inline ScalarFloat cos(ScalarFloat a) { return sinQuadrant(a, 1); }
+
+#if defined(SIMD_AVX2)
+
+struct Float8 {
+    static constexpr int kWidth = 8;
+    static constexpr const char* kName = "avx2";
+
+    struct Mask { __m256 m; };
+
+    __m256 v;
+
+    Float8() = default;
+    explicit Float8(__m256 x) : v(x) {}
+    Float8(float s) : v(_mm256_set1_ps(s)) {}
+
+    static Float8 load(const float* p) { return Float8(_mm256_loadu_ps(p)); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline Float8 operator+(Float8 a, Float8 b) { return Float8(_mm256_add_ps(a.v, b.v)); }
+inline Float8 operator-(Float8 a, Float8 b) { return Float8(_mm256_sub_ps(a.v, b.v)); }
+inline Float8 operator*(Float8 a, Float8 b) { return Float8(_mm256_mul_ps(a.v, b.v)); }
+inline Float8 operator/(Float8 a, Float8 b) { return Float8(_mm256_div_ps(a.v, b.v)); }
+inline Float8 min(Float8 a, Float8 b) { return Float8(_mm256_min_ps(a.v, b.v)); }
+inline Float8 max(Float8 a, Float8 b) { return Float8(_mm256_max_ps(a.v, b.v)); }
+inline Float8 abs(Float8 a) { return Float8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+inline Float8::Mask lessThan(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline Float8::Mask greaterThan(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+inline bool any(Float8::Mask m) { return _mm256_movemask_ps(m.m) != 0; }
+inline bool all(Float8::Mask m) { return _mm256_movemask_ps(m.m) == 0xFF; }
+inline int bitmask(Float8::Mask m) { return _mm256_movemask_ps(m.m); }
+inline Float8 select(Float8::Mask m, Float8 a, Float8 b) { return Float8(_mm256_blendv_ps(b.v, a.v, m.m)); }
+
+inline Float8 sinQuadrant(Float8 a, int32_t quadrantOffset) {
+    __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(a.v, _mm256_set1_ps(kTwoOverPi)));
+    Float8 qf(_mm256_cvtepi32_ps(q));
+    Float8 r = a - qf * Float8(kPiOver2Hi) - qf * Float8(kPiOver2Lo);
+    q = _mm256_add_epi32(q, _mm256_set1_epi32(quadrantOffset));
+
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256 odd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+    __m256 result = _mm256_blendv_ps(sinPoly(r).v, cosPoly(r).v, odd);
+    __m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+    return Float8(_mm256_xor_ps(result, sign));
+}
+
+inline Float8 sin(Float8 a) { return sinQuadrant(a, 0); }
+inline Float8 cos(Float8 a) { return sinQuadrant(a, 1); }
+
+using SimdFloat = Float8;
+
+#elif defined(SIMD_SSE2)
+
+struct Float4 {
+    static constexpr int kWidth = 4;
+    static constexpr const char* kName = "sse2";
+
+    struct Mask { __m128 m; };
+
+    __m128 v;
+
+    Float4() = default;
+    explicit Float4(__m128 x) : v(x) {}
+    Float4(float s) : v(_mm_set1_ps(s)) {}
+
+    static Float4 load(const float* p) { return Float4(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return Float4(_mm_add_ps(a.v, b.v)); }
+inline Float4 operator-(Float4 a, Float4 b) { return Float4(_mm_sub_ps(a.v, b.v)); }
+inline Float4 operator*(Float4 a, Float4 b) { return Float4(_mm_mul_ps(a.v, b.v)); }
+inline Float4 operator/(Float4 a, Float4 b) { return Float4(_mm_div_ps(a.v, b.v)); }
+inline Float4 min(Float4 a, Float4 b) { return Float4(_mm_min_ps(a.v, b.v)); }
+inline Float4 max(Float4 a, Float4 b) { return Float4(_mm_max_ps(a.v, b.v)); }
+inline Float4 abs(Float4 a) { return Float4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+inline Float4::Mask lessThan(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline Float4::Mask greaterThan(Float4 a, Float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline bool any(Float4::Mask m) { return _mm_movemask_ps(m.m) != 0; }
+inline bool all(Float4::Mask m) { return _mm_movemask_ps(m.m) == 0xF; }
+inline int bitmask(Float4::Mask m) { return _mm_movemask_ps(m.m); }
+inline Float4 select(Float4::Mask m, Float4 a, Float4 b) {
+    return Float4(_mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v)));
+}
+
+inline Float4 sinQuadrant(Float4 a, int32_t quadrantOffset) {
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(a.v, _mm_set1_ps(kTwoOverPi)));
+    Float4 qf(_mm_cvtepi32_ps(q));
+    Float4 r = a - qf * Float4(kPiOver2Hi) - qf * Float4(kPiOver2Lo);
+    q = _mm_add_epi32(q, _mm_set1_epi32(quadrantOffset));
+
+    const __m128i one = _mm_set1_epi32(1);
+    Float4::Mask odd = { _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one)) };
+    Float4 result = select(odd, cosPoly(r), sinPoly(r));
+    __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    return Float4(_mm_xor_ps(result.v, sign));
+}
+
+inline Float4 sin(Float4 a) { return sinQuadrant(a, 0); }
+inline Float4 cos(Float4 a) { return sinQuadrant(a, 1); }
+
+using SimdFloat = Float4;
+
+#elif defined(SIMD_NEON)
+
+struct Float4 {
+    static constexpr int kWidth = 4;
+    static constexpr const char* kName = "neon";
+
+    struct Mask { uint32x4_t m; };
+
+    float32x4_t v;
+
+    Float4() = default;
+    explicit Float4(float32x4_t x) : v(x) {}
+    Float4(float s) : v(vdupq_n_f32(s)) {}
+
+    static Float4 load(const float* p) { return Float4(vld1q_f32(p)); }
+    void store(float* p) const { vst1q_f32(p, v); }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return Float4(vaddq_f32(a.v, b.v)); }
+inline Float4 operator-(Float4 a, Float4 b) { return Float4(vsubq_f32(a.v, b.v)); }
+inline Float4 operator*(Float4 a, Float4 b) { return Float4(vmulq_f32(a.v, b.v)); }
+inline Float4 operator/(Float4 a, Float4 b) { return Float4(vdivq_f32(a.v, b.v)); }
+inline Float4 min(Float4 a, Float4 b) { return Float4(vminq_f32(a.v, b.v)); }
+inline Float4 max(Float4 a, Float4 b) { return Float4(vmaxq_f32(a.v, b.v)); }
+inline Float4 abs(Float4 a) { return Float4(vabsq_f32(a.v)); }
+inline Float4::Mask lessThan(Float4 a, Float4 b) { return { vcltq_f32(a.v, b.v) }; }
+inline Float4::Mask greaterThan(Float4 a, Float4 b) { return { vcgtq_f32(a.v, b.v) }; }
+inline bool any(Float4::Mask m) { return vmaxvq_u32(m.m) != 0; }
+inline bool all(Float4::Mask m) { return vminvq_u32(m.m) != 0; }
+inline int bitmask(Float4::Mask m) {
+    const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+    return (int)vaddvq_u32(vandq_u32(m.m, vld1q_u32(laneBits)));
+}
+inline Float4 select(Float4::Mask m, Float4 a, Float4 b) { return Float4(vbslq_f32(m.m, a.v, b.v)); }
+
+inline Float4 sinQuadrant(Float4 a, int32_t quadrantOffset) {
+    int32x4_t q = vcvtnq_s32_f32(vmulq_f32(a.v, vdupq_n_f32(kTwoOverPi)));
+    Float4 qf(vcvtq_f32_s32(q));
+    Float4 r = a - qf * Float4(kPiOver2Hi) - qf * Float4(kPiOver2Lo);
+    q = vaddq_s32(q, vdupq_n_s32(quadrantOffset));
+
+    Float4::Mask odd = { vtstq_s32(q, vdupq_n_s32(1)) };
+    Float4 result = select(odd, cosPoly(r), sinPoly(r));
+    uint32x4_t sign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(q), vdupq_n_u32(2)), 30);
+    return Float4(vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(result.v), sign)));
+}
+
+inline Float4 sin(Float4 a) { return sinQuadrant(a, 0); }
+inline Float4 cos(Float4 a) { return sinQuadrant(a, 1); }
+
+using SimdFloat = Float4;
+
+#else
+
+using SimdFloat = ScalarFloat;
+
+#endif
+
+// Clamp helper shared by every width
+template <typename V>
+inline V clamp(V x, V lo, V hi) { return min(max(x, lo), hi); }
+
+} // namespace Simd
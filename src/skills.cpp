@@ -80,4 +80,7 @@ void PlayerSkills::renderOverlay(UIRenderer& uiRenderer, float screenHeight) con
 
 Skill& PlayerSkills::getSkill(SkillType type) {
     return skills.at(type);
-}
\ No newline at end of file
+}
+const Skill& PlayerSkills::getSkill(SkillType type) const {
+    return skills.at(type);
+}
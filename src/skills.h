@@ -38,4 +38,5 @@ struct PlayerSkills {
     void toggleOverlay();
     void renderOverlay(UIRenderer& uiRenderer, float screenHeight) const;
     Skill& getSkill(SkillType type);
+    const Skill& getSkill(SkillType type) const;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "skin_palette.h"
+#include <algorithm>
+#include <iostream>
+
+void SkinPalette::destroy() {
+    if (bgfx::isValid(texture)) {
+        bgfx::destroy(texture);
+        texture = BGFX_INVALID_HANDLE;
+    }
+    textureRows = 0;
+}
+
+void SkinPalette::begin() {
+    texels.clear();
+}
+
+uint32_t SkinPalette::add(const ozz::math::Float4x4* matrices, int count) {
+    uint32_t offset = getTexelCount();
+    texels.resize(texels.size() + (size_t)count * 16);
+    float* out = texels.data() + (size_t)offset * 4;
+    for (int i = 0; i < count; i++) {
+        for (int column = 0; column < 4; column++) {
+            ozz::math::StorePtrU(matrices[i].cols[column], out);
+            out += 4;
+        }
+    }
+    return offset;
+}
+
+bool SkinPalette::upload() {
+    const uint32_t rowsUsed = (getTexelCount() + TEXTURE_WIDTH - 1) / TEXTURE_WIDTH;
+    if (rowsUsed == 0) return true;
+
+    const bgfx::Caps* caps = bgfx::getCaps();
+    if (!(caps->formats[bgfx::TextureFormat::RGBA32F] & BGFX_CAPS_FORMAT_TEXTURE_VERTEX)) {
+        return false;
+    }
+    if (rowsUsed > caps->limits.maxTextureSize) {
+        std::cerr << "Skin palette needs " << rowsUsed << " rows, the GPU allows " << caps->limits.maxTextureSize
+                  << std::endl;
+        return false;
+    }
+
+    // Grow in powers of two so a crowd walking into view doesn't recreate it every frame
+    if (rowsUsed > textureRows) {
+        uint32_t rows = std::max<uint32_t>(textureRows, 16);
+        while (rows < rowsUsed) rows *= 2;
+        rows = std::min(rows, caps->limits.maxTextureSize);
+
+        if (bgfx::isValid(texture)) {
+            bgfx::destroy(texture);
+        }
+        texture = bgfx::createTexture2D(TEXTURE_WIDTH, (uint16_t)rows, false, 1, bgfx::TextureFormat::RGBA32F,
+                                        BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP);
+        textureRows = (uint16_t)rows;
+    }
+
+    // Whole rows only; the tail of the last one is padding the shader never reads
+    texels.resize((size_t)rowsUsed * TEXTURE_WIDTH * 4, 0.0f);
+    const bgfx::Memory* memory = bgfx::copy(texels.data(), (uint32_t)(texels.size() * sizeof(float)));
+    bgfx::updateTexture2D(texture, 0, 0, 0, 0, TEXTURE_WIDTH, (uint16_t)rowsUsed, memory);
+    return true;
+}
+
+void SkinPalette::getShaderInfo(float info[4]) const {
+    info[0] = TEXTURE_WIDTH;
+    info[1] = 1.0f / TEXTURE_WIDTH;
+    info[2] = textureRows > 0 ? 1.0f / textureRows : 0.0f;
+    info[3] = 0.0f;
+}
+
+void SkinPalette::skinPosition(const float* texels, uint32_t paletteOffset, const uint8_t jointIndices[4],
+                               const float jointWeights[4], const float position[3], float out[3]) {
+    out[0] = out[1] = out[2] = 0.0f;
+    for (int influence = 0; influence < 4; influence++) {
+        // Column-major: texel c of a matrix is column c
+        const float* m = texels + ((size_t)paletteOffset + jointIndices[influence] * 4) * 4;
+        const float weight = jointWeights[influence];
+        out[0] += weight * (m[0] * position[0] + m[4] * position[1] + m[8] * position[2] + m[12]);
+        out[1] += weight * (m[1] * position[0] + m[5] * position[1] + m[9] * position[2] + m[13]);
+        out[2] += weight * (m[2] * position[0] + m[6] * position[1] + m[10] * position[2] + m[14]);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <ozz/base/maths/simd_math.h>
+#include <cstdint>
+#include <vector>
+
+// Skin matrices of every instance drawn this frame, packed into one RGBA32F texture so a
+// single instanced draw can skin them all. Each matrix takes four consecutive texels (its
+// columns); an instance's palette starts at the texel offset add() returned, which goes
+// into its instance data. vs_npc_instanced.sc does the reverse lookup.
+class SkinPalette {
+public:
+    // Texels per row; a multiple of 4 so a matrix never straddles two rows
+    static constexpr uint16_t TEXTURE_WIDTH = 1024;
+
+    SkinPalette() = default;
+
+    SkinPalette(const SkinPalette&) = delete;
+    SkinPalette& operator=(const SkinPalette&) = delete;
+
+    // Start packing a new frame
+    void begin();
+    // Append one instance's palette; returns its first texel
+    uint32_t add(const ozz::math::Float4x4* matrices, int count);
+
+    // Copy the packed rows to the texture, growing it if needed. False if the palette
+    // doesn't fit the largest texture the GPU supports or vertex shaders can't read RGBA32F.
+    bool upload();
+    bgfx::TextureHandle getTexture() const { return texture; }
+    // Free the texture; call before bgfx::shutdown
+    void destroy();
+    // x = texture width, y = 1 / width, z = 1 / height, for the shader's texel lookup
+    void getShaderInfo(float info[4]) const;
+
+    const std::vector<float>& getTexels() const { return texels; }  // RGBA, TEXTURE_WIDTH per row
+    uint32_t getTexelCount() const { return (uint32_t)(texels.size() / 4); }
+
+    // What the vertex shader does to a bind-pose position, on the CPU. texels is a packed
+    // palette (getTexels()), paletteOffset an instance's add() result and jointIndices and
+    // jointWeights the vertex's four influences.
+    static void skinPosition(const float* texels, uint32_t paletteOffset, const uint8_t jointIndices[4],
+                             const float jointWeights[4], const float position[3], float out[3]);
+
+private:
+    std::vector<float> texels;
+    bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+    uint16_t textureRows = 0;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Uniform spatial hash over the x/z plane. Items are filed under the cell containing the
+// point they were inserted at; cells hash into a fixed bucket table, so the world needs no
+// bounds. Queries hand out candidates and callers do their own exact tests.
+template <typename T>
+class SpatialGrid {
+public:
+    static constexpr int BUCKET_COUNT = 4096;  // Must be a power of two
+
+    explicit SpatialGrid(float cellSize = 8.0f) : cellSize(cellSize), buckets(BUCKET_COUNT) {}
+
+    float getCellSize() const { return cellSize; }
+    size_t size() const { return count; }
+
+    void insert(T* item, float x, float z) {
+        int cellX = toCell(x);
+        int cellZ = toCell(z);
+        buckets[getBucket(cellX, cellZ)].push_back({item, cellX, cellZ});
+        count++;
+    }
+
+    // x/z must be where the item was inserted or last moved to
+    bool remove(T* item, float x, float z) {
+        std::vector<Entry>& bucket = buckets[getBucket(toCell(x), toCell(z))];
+        for (size_t i = 0; i < bucket.size(); i++) {
+            if (bucket[i].item == item) {
+                bucket[i] = bucket.back();
+                bucket.pop_back();
+                count--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Cheap when the item stays in its cell, which is almost every frame
+    void move(T* item, float oldX, float oldZ, float newX, float newZ) {
+        if (toCell(oldX) == toCell(newX) && toCell(oldZ) == toCell(newZ)) return;
+        if (remove(item, oldX, oldZ)) {
+            insert(item, newX, newZ);
+        }
+    }
+
+    void clear() {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        count = 0;
+    }
+
+    // visit(T*) for every item filed in a cell that overlaps the square (x, z) +- radius
+    template <typename F>
+    void queryRadius(float x, float z, float radius, F&& visit) const {
+        int minX = toCell(x - radius), maxX = toCell(x + radius);
+        int minZ = toCell(z - radius), maxZ = toCell(z + radius);
+        for (int cellZ = minZ; cellZ <= maxZ; cellZ++) {
+            for (int cellX = minX; cellX <= maxX; cellX++) {
+                visitCell(cellX, cellZ, visit);
+            }
+        }
+    }
+
+    // Nearest item along a ray, walking the cells it crosses in order. hitDistance(T*)
+    // returns the ray parameter of the hit, or a negative value for a miss. An item may be
+    // hit up to one cell away from its own (horizontal extent <= cell size), so every cell
+    // on the ray is searched together with its neighbours. The direction's x/z are used as
+    // given, so distances stay in the units of the full 3D ray.
+    template <typename F>
+    T* raycast(float originX, float originZ, float directionX, float directionZ, float maxDistance, F&& hitDistance) const {
+        const float infinity = std::numeric_limits<float>::infinity();
+        int cellX = toCell(originX);
+        int cellZ = toCell(originZ);
+        int stepX = directionX > 0.0f ? 1 : -1;
+        int stepZ = directionZ > 0.0f ? 1 : -1;
+        float tDeltaX = directionX != 0.0f ? cellSize / std::fabs(directionX) : infinity;
+        float tDeltaZ = directionZ != 0.0f ? cellSize / std::fabs(directionZ) : infinity;
+        float tNextX = directionX != 0.0f ? ((cellX + (stepX > 0 ? 1 : 0)) * cellSize - originX) / directionX : infinity;
+        float tNextZ = directionZ != 0.0f ? ((cellZ + (stepZ > 0 ? 1 : 0)) * cellSize - originZ) / directionZ : infinity;
+
+        T* nearest = nullptr;
+        float nearestDistance = maxDistance;
+        auto testItem = [&](T* item) {
+            float distance = hitDistance(item);
+            if (distance >= 0.0f && distance < nearestDistance) {
+                nearestDistance = distance;
+                nearest = item;
+            }
+        };
+
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                visitCell(cellX + dx, cellZ + dz, testItem);
+            }
+        }
+
+        // The walk only moves forward on each axis, so each step uncovers exactly the three
+        // cells on the leading side of the new 3x3 block. Every hit before tEnter has been
+        // seen, so stop once the nearest one is behind us.
+        while (tNextX != infinity || tNextZ != infinity) {
+            bool stepAlongX = tNextX < tNextZ;
+            float tEnter = stepAlongX ? tNextX : tNextZ;
+            if (tEnter > nearestDistance) break;
+
+            if (stepAlongX) {
+                tNextX += tDeltaX;
+                cellX += stepX;
+                for (int dz = -1; dz <= 1; dz++) {
+                    visitCell(cellX + stepX, cellZ + dz, testItem);
+                }
+            } else {
+                tNextZ += tDeltaZ;
+                cellZ += stepZ;
+                for (int dx = -1; dx <= 1; dx++) {
+                    visitCell(cellX + dx, cellZ + stepZ, testItem);
+                }
+            }
+        }
+        return nearest;
+    }
+
+private:
+    struct Entry {
+        T* item;
+        int cellX, cellZ;  // Buckets are shared between cells, so entries keep their own
+    };
+
+    int toCell(float coordinate) const {
+        return (int)std::floor(coordinate / cellSize);
+    }
+
+    static size_t getBucket(int cellX, int cellZ) {
+        uint32_t hash = ((uint32_t)cellX * 73856093u) ^ ((uint32_t)cellZ * 19349663u);
+        return hash & (BUCKET_COUNT - 1);
+    }
+
+    template <typename F>
+    void visitCell(int cellX, int cellZ, F&& visit) const {
+        for (const Entry& entry : buckets[getBucket(cellX, cellZ)]) {
+            if (entry.cellX == cellX && entry.cellZ == cellZ) {
+                visit(entry.item);
+            }
+        }
+    }
+
+    float cellSize;
+    std::vector<std::vector<Entry>> buckets;
+    size_t count = 0;
+};
@@ -0,0 +1,2462 @@
+#include "terrain.h"
+#include "terrain_kernel.h"
+#include "player.h"
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <unordered_set>
+
+// TerrainChunk implementation
+TerrainChunk::BufferStats TerrainChunk::bufferStats;
+
+TerrainChunk::TerrainChunk(int cx, int cz, BiomeType biomeType)
+    : biome(biomeType), chunkX(cx), chunkZ(cz), hasWater(false) {
+    vbh = BGFX_INVALID_HANDLE;
+    adaptiveIbh = BGFX_INVALID_HANDLE;
+    adaptiveTriangleCount = 0;
+    adaptiveMaxError = -1.0f;
+}
+
+TerrainChunk::~TerrainChunk() {
+    if (bgfx::isValid(vbh)) {
+        bgfx::destroy(vbh);
+        bufferStats.destroyed++;
+    }
+    if (bgfx::isValid(adaptiveIbh)) {
+        bgfx::destroy(adaptiveIbh);
+        bufferStats.destroyed++;
+    }
+}
+
+void TerrainChunk::reset(int cx, int cz, BiomeType biomeType) {
+    biome = biomeType;
+    chunkX = cx;
+    chunkZ = cz;
+    vertices.clear();
+    heightTile.samples.clear();
+    walkCosts.clear();
+    errors.clear();
+    resourceSpawns.clear();
+    npcSpawns.clear();
+    hasWater = false;
+    adaptiveTriangleCount = 0;
+    adaptiveMaxError = -1.0f;
+    inFrustum = true;
+    loadedFromCache = false;
+    spawnsChanged = false;
+    heightsEdited = false;
+    buildMilliseconds = 0.0f;
+    generationTimings = GenerationTimings();
+    uploaded = false;
+}
+
+void TerrainChunk::generate() {
+    vertices.clear();
+    hasWater = false;
+
+    // Milliseconds since the previous stage ended
+    auto stageStart = std::chrono::steady_clock::now();
+    auto endStage = [&stageStart]() {
+        auto now = std::chrono::steady_clock::now();
+        float elapsed = std::chrono::duration<float, std::milli>(now - stageStart).count();
+        stageStart = now;
+        return elapsed;
+    };
+
+    // Generate vertices with biome-specific terrain
+    generateBiomeTerrain();
+    generationTimings.heightMilliseconds = endStage();
+    heightTile.build(vertices);
+    heightPyramid.build(heightTile.samples);
+    PathFinder::buildWalkCosts(heightTile.samples, heightTile.minHeight, heightTile.heightScale, walkCosts);
+    generationTimings.derivedMilliseconds = endStage();
+    buildErrorHierarchy();
+    generationTimings.errorMilliseconds = endStage();
+
+    // Flag the chunk for the merged water surface
+    checkForWater();
+    generationTimings.waterMilliseconds = endStage();
+
+    // Validate chunk geometry
+    validateChunkGeometry();
+    generationTimings.validationMilliseconds = endStage();
+
+    // Build the line first so output from several workers doesn't interleave
+    std::ostringstream log;
+    log << "Generated " << getBiomeName() << " chunk (" << chunkX << ", " << chunkZ
+        << ") with " << vertices.size() << " vertices";
+    if (hasWater) {
+        log << " (has water)";
+    }
+    log << "\n";
+    std::cout << log.str() << std::flush;
+}
+
+namespace {
+
+// Plain little helpers for the chunk cache records
+template <typename T>
+void appendValue(std::vector<uint8_t>& out, const T& value) {
+    size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+struct RecordReader {
+    const std::vector<uint8_t>& data;
+    size_t offset = 0;
+
+    template <typename T>
+    bool read(T& value) {
+        if (offset + sizeof(T) > data.size()) return false;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+};
+
+constexpr uint32_t MAX_CACHED_SPAWNS = 1024;  // Sanity limit when reading records
+
+// Biome weights as RGBA8, channel n = BiomeType n
+uint32_t packBiomeWeights(const float* weights) {
+    uint32_t packed = 0;
+    for (int biome = 0; biome < TerrainKernel::kBiomeWeightCount; biome++) {
+        uint32_t channel = (uint32_t)(bx::clamp(weights[biome], 0.0f, 1.0f) * 255.0f + 0.5f);
+        packed |= channel << (biome * 8);
+    }
+    return packed;
+}
+
+const bgfx::VertexLayout& getTerrainLayout() {
+    static bgfx::VertexLayout layout = []() {
+        bgfx::VertexLayout terrainLayout;
+        terrainLayout.begin()
+            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+            .end();
+        return terrainLayout;
+    }();
+    return layout;
+}
+
+} // namespace
+
+bool TerrainChunk::loadFromCache(const std::vector<uint8_t>& record) {
+    RecordReader reader{record};
+    int32_t recordX = 0, recordZ = 0;
+    uint8_t recordBiome = 0, recordHasWater = 0;
+    uint32_t sampleCount = 0;
+    if (!reader.read(recordX) || !reader.read(recordZ) || !reader.read(recordBiome) || !reader.read(recordHasWater) ||
+        !reader.read(heightTile.minHeight) || !reader.read(heightTile.heightScale) || !reader.read(sampleCount)) {
+        return false;
+    }
+    if (recordX != chunkX || recordZ != chunkZ || recordBiome != (uint8_t)biome ||
+        sampleCount != (CHUNK_SIZE + 1) * (CHUNK_SIZE + 1)) {
+        return false;
+    }
+
+    heightTile.samples.resize(sampleCount);
+    for (uint16_t& sample : heightTile.samples) {
+        if (!reader.read(sample)) return false;
+    }
+
+    uint32_t resourceCount = 0;
+    if (!reader.read(resourceCount) || resourceCount > MAX_CACHED_SPAWNS) return false;
+    resourceSpawns.resize(resourceCount);
+    for (ResourceSpawn& spawn : resourceSpawns) {
+        uint8_t type = 0, active = 0;
+        int32_t health = 0;
+        if (!reader.read(spawn.x) || !reader.read(spawn.y) || !reader.read(spawn.z) ||
+            !reader.read(type) || !reader.read(health) || !reader.read(active)) {
+            return false;
+        }
+        spawn.type = (ResourceType)type;
+        spawn.health = health;
+        spawn.isActive = active != 0;
+    }
+
+    uint32_t npcCount = 0;
+    if (!reader.read(npcCount) || npcCount > MAX_CACHED_SPAWNS) return false;
+    npcSpawns.resize(npcCount);
+    for (NPCSpawn& spawn : npcSpawns) {
+        uint8_t type = 0, active = 0;
+        int32_t health = 0;
+        if (!reader.read(spawn.x) || !reader.read(spawn.y) || !reader.read(spawn.z) ||
+            !reader.read(type) || !reader.read(health) || !reader.read(active)) {
+            return false;
+        }
+        spawn.type = (NPCType)type;
+        spawn.health = health;
+        spawn.isActive = active != 0;
+    }
+
+    // Everything else derives from the height tile
+    vertices.clear();
+    buildVerticesFromTile();
+    heightPyramid.build(heightTile.samples);
+    PathFinder::buildWalkCosts(heightTile.samples, heightTile.minHeight, heightTile.heightScale, walkCosts);
+    buildErrorHierarchy();
+    hasWater = recordHasWater != 0;
+    return true;
+}
+
+void TerrainChunk::writeCacheRecord(std::vector<uint8_t>& out) const {
+    out.clear();
+    out.reserve(64 + heightTile.samples.size() * sizeof(uint16_t) +
+                resourceSpawns.size() * 20 + npcSpawns.size() * 20);
+
+    appendValue(out, (int32_t)chunkX);
+    appendValue(out, (int32_t)chunkZ);
+    appendValue(out, (uint8_t)biome);
+    appendValue(out, (uint8_t)(hasWater ? 1 : 0));
+    appendValue(out, heightTile.minHeight);
+    appendValue(out, heightTile.heightScale);
+    appendValue(out, (uint32_t)heightTile.samples.size());
+    for (uint16_t sample : heightTile.samples) {
+        appendValue(out, sample);
+    }
+
+    appendValue(out, (uint32_t)resourceSpawns.size());
+    for (const ResourceSpawn& spawn : resourceSpawns) {
+        appendValue(out, spawn.x);
+        appendValue(out, spawn.y);
+        appendValue(out, spawn.z);
+        appendValue(out, (uint8_t)spawn.type);
+        appendValue(out, (int32_t)spawn.health);
+        appendValue(out, (uint8_t)(spawn.isActive ? 1 : 0));
+    }
+
+    appendValue(out, (uint32_t)npcSpawns.size());
+    for (const NPCSpawn& spawn : npcSpawns) {
+        appendValue(out, spawn.x);
+        appendValue(out, spawn.y);
+        appendValue(out, spawn.z);
+        appendValue(out, (uint8_t)spawn.type);
+        appendValue(out, (int32_t)spawn.health);
+        appendValue(out, (uint8_t)(spawn.isActive ? 1 : 0));
+    }
+}
+
+template <typename F>
+void HeightTile::quantize(size_t count, F heightAt, float margin) {
+    float maxHeight = -1000000.0f;
+    minHeight = 1000000.0f;
+    for (size_t i = 0; i < count; i++) {
+        minHeight = bx::min(minHeight, heightAt(i));
+        maxHeight = bx::max(maxHeight, heightAt(i));
+    }
+    if (count == 0) {
+        minHeight = maxHeight = 0.0f;
+    }
+    minHeight -= margin;
+    maxHeight += margin;
+
+    heightScale = (maxHeight - minHeight) / 65535.0f;
+    samples.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        float normalized = heightScale > 0.0f ? (heightAt(i) - minHeight) / heightScale : 0.0f;
+        samples[i] = (uint16_t)bx::clamp(normalized + 0.5f, 0.0f, 65535.0f);
+    }
+}
+
+void HeightTile::build(const std::vector<TerrainVertex>& vertices) {
+    quantize(vertices.size(), [&vertices](size_t i) { return vertices[i].y; }, 0.0f);
+}
+
+void HeightTile::build(const std::vector<float>& heights, float margin) {
+    quantize(heights.size(), [&heights](size_t i) { return heights[i]; }, margin);
+}
+
+bool HeightTile::setHeight(int index, float height) {
+    if (height < minHeight || height > getMaxHeight()) return false;
+    float normalized = heightScale > 0.0f ? (height - minHeight) / heightScale : 0.0f;
+    samples[index] = (uint16_t)bx::clamp(normalized + 0.5f, 0.0f, 65535.0f);
+    return true;
+}
+
+void TerrainChunk::generateBiomeTerrain() {
+    // Generate vertices using global world coordinates for seamless transitions
+    const int vertexRowSize = CHUNK_SIZE + 1; // Extra row/column for seamless stitching
+
+    // Heights for the whole grid come from the batched kernel
+    std::vector<float> heights(vertexRowSize * vertexRowSize);
+    std::vector<float> biomeWeights(heights.size() * TerrainKernel::kBiomeWeightCount);
+    TerrainKernel::generateHeights(chunkX * CHUNK_SIZE, chunkZ * CHUNK_SIZE, vertexRowSize, SCALE, heights.data(),
+                                   TerrainKernel::Path::SIMD, biomeWeights.data());
+
+    vertices.reserve(heights.size());
+    for (int z = 0; z <= CHUNK_SIZE; z++) {
+        for (int x = 0; x <= CHUNK_SIZE; x++) {
+            // Calculate world position for this chunk vertex
+            float worldX = (chunkX * CHUNK_SIZE + x) * SCALE;
+            float worldZ = (chunkZ * CHUNK_SIZE + z) * SCALE;
+
+            TerrainVertex vertex;
+            vertex.x = worldX;
+            vertex.y = heights[z * vertexRowSize + x];
+            vertex.z = worldZ;
+            vertex.u = float(x) / CHUNK_SIZE;
+            vertex.v = float(z) / CHUNK_SIZE;
+            vertex.biomeWeights = packBiomeWeights(&biomeWeights[(z * vertexRowSize + x) * TerrainKernel::kBiomeWeightCount]);
+
+            vertices.push_back(vertex);
+        }
+    }
+}
+
+void TerrainChunk::buildVerticesFromTile() {
+    const int vertexRowSize = CHUNK_SIZE + 1;
+    std::vector<float> biomeWeights(vertexRowSize * vertexRowSize * TerrainKernel::kBiomeWeightCount);
+    TerrainKernel::generateBiomeWeights(chunkX * CHUNK_SIZE, chunkZ * CHUNK_SIZE, vertexRowSize, SCALE, biomeWeights.data());
+
+    vertices.reserve(vertexRowSize * vertexRowSize);
+    for (int z = 0; z <= CHUNK_SIZE; z++) {
+        for (int x = 0; x <= CHUNK_SIZE; x++) {
+            TerrainVertex vertex;
+            vertex.x = (chunkX * CHUNK_SIZE + x) * SCALE;
+            vertex.y = heightTile.getHeight(z * vertexRowSize + x);
+            vertex.z = (chunkZ * CHUNK_SIZE + z) * SCALE;
+            vertex.u = float(x) / CHUNK_SIZE;
+            vertex.v = float(z) / CHUNK_SIZE;
+            vertex.biomeWeights = packBiomeWeights(&biomeWeights[(z * vertexRowSize + x) * TerrainKernel::kBiomeWeightCount]);
+            vertices.push_back(vertex);
+        }
+    }
+}
+
+std::vector<uint16_t> TerrainChunk::generateIndices(int lod, uint8_t stitchMask) {
+    std::vector<uint16_t> lodIndices;
+    const int vertexRowSize = CHUNK_SIZE + 1; // Account for extra row/column
+    const int step = 1 << lod;
+    const int coarseStep = step * 2;
+
+    // Vertices on a stitched edge snap back onto the coarser neighbour's grid
+    auto vertexIndex = [&](int x, int z) {
+        if (((stitchMask & STITCH_NORTH) && z == 0) || ((stitchMask & STITCH_SOUTH) && z == CHUNK_SIZE)) {
+            x -= x % coarseStep;
+        }
+        if (((stitchMask & STITCH_WEST) && x == 0) || ((stitchMask & STITCH_EAST) && x == CHUNK_SIZE)) {
+            z -= z % coarseStep;
+        }
+        return (uint16_t)(z * vertexRowSize + x);
+    };
+
+    // Triangles collapsed by the snapping are dropped
+    auto addTriangle = [&](uint16_t a, uint16_t b, uint16_t c) {
+        if (a == b || b == c || a == c) return;
+        lodIndices.push_back(a);
+        lodIndices.push_back(b);
+        lodIndices.push_back(c);
+    };
+
+    for (int z = 0; z < CHUNK_SIZE; z += step) {
+        for (int x = 0; x < CHUNK_SIZE; x += step) {
+            uint16_t topLeft = vertexIndex(x, z);
+            uint16_t topRight = vertexIndex(x + step, z);
+            uint16_t bottomLeft = vertexIndex(x, z + step);
+            uint16_t bottomRight = vertexIndex(x + step, z + step);
+
+            addTriangle(topLeft, bottomLeft, topRight);
+            addTriangle(topRight, bottomLeft, bottomRight);
+        }
+    }
+
+    return lodIndices;
+}
+
+namespace {
+
+// RTIN triangle table for the chunk grid (after mapbox/martini). Triangle i has its
+// hypotenuse from (ax, az) to (bx, bz); the right angle vertex is derived from those.
+struct RtinTriangles {
+    static constexpr int TILE_SIZE = TerrainChunk::CHUNK_SIZE;
+    static constexpr int TRIANGLE_COUNT = TILE_SIZE * TILE_SIZE * 2 - 2;
+    static constexpr int PARENT_TRIANGLE_COUNT = TRIANGLE_COUNT - TILE_SIZE * TILE_SIZE;
+
+    std::vector<uint16_t> coords;  // ax, az, bx, bz per triangle
+
+    RtinTriangles() : coords(TRIANGLE_COUNT * 4) {
+        for (int i = 0; i < TRIANGLE_COUNT; i++) {
+            int id = i + 2;
+            int ax = 0, az = 0, bx = 0, bz = 0, cx = 0, cz = 0;
+            if (id & 1) {
+                bx = bz = cx = TILE_SIZE;  // Bottom-left root
+            } else {
+                ax = az = cz = TILE_SIZE;  // Top-right root
+            }
+            while ((id >>= 1) > 1) {
+                int mx = (ax + bx) >> 1;
+                int mz = (az + bz) >> 1;
+                if (id & 1) {
+                    bx = ax; bz = az;
+                    ax = cx; az = cz;
+                } else {
+                    ax = bx; az = bz;
+                    bx = cx; bz = cz;
+                }
+                cx = mx; cz = mz;
+            }
+            coords[i * 4 + 0] = (uint16_t)ax;
+            coords[i * 4 + 1] = (uint16_t)az;
+            coords[i * 4 + 2] = (uint16_t)bx;
+            coords[i * 4 + 3] = (uint16_t)bz;
+        }
+    }
+
+    static const RtinTriangles& get() {
+        static const RtinTriangles table;
+        return table;
+    }
+};
+
+} // namespace
+
+uint16_t TerrainChunk::getEdgeVertexIndex(int edge, int i) {
+    const int gridSize = CHUNK_SIZE + 1;
+    switch (edge) {
+        case 0: return (uint16_t)i;                                   // North, z == 0
+        case 1: return (uint16_t)(i * gridSize + CHUNK_SIZE);         // East, x == CHUNK_SIZE
+        case 2: return (uint16_t)(CHUNK_SIZE * gridSize + i);         // South, z == CHUNK_SIZE
+        default: return (uint16_t)(i * gridSize);                     // West, x == 0
+    }
+}
+
+void TerrainChunk::buildErrorHierarchy() {
+    const int gridSize = CHUNK_SIZE + 1;
+    const RtinTriangles& table = RtinTriangles::get();
+    std::vector<float> vertexErrors(gridSize * gridSize, 0.0f);
+
+    // Walk from the smallest triangles up so every midpoint error includes its children
+    for (int i = RtinTriangles::TRIANGLE_COUNT - 1; i >= 0; i--) {
+        int ax = table.coords[i * 4 + 0];
+        int az = table.coords[i * 4 + 1];
+        int bx = table.coords[i * 4 + 2];
+        int bz = table.coords[i * 4 + 3];
+        int mx = (ax + bx) >> 1;
+        int mz = (az + bz) >> 1;
+        int cx = mx + mz - az;
+        int cz = mz + ax - mx;
+
+        float interpolatedHeight = (heightTile.getHeight(az * gridSize + ax) + heightTile.getHeight(bz * gridSize + bx)) * 0.5f;
+        int middleIndex = mz * gridSize + mx;
+        float middleError = bx::abs(interpolatedHeight - heightTile.getHeight(middleIndex));
+        vertexErrors[middleIndex] = bx::max(vertexErrors[middleIndex], middleError);
+
+        if (i < RtinTriangles::PARENT_TRIANGLE_COUNT) {
+            int leftChildIndex = ((az + cz) >> 1) * gridSize + ((ax + cx) >> 1);
+            int rightChildIndex = ((bz + cz) >> 1) * gridSize + ((bx + cx) >> 1);
+            vertexErrors[middleIndex] = bx::max(vertexErrors[middleIndex],
+                                                bx::max(vertexErrors[leftChildIndex], vertexErrors[rightChildIndex]));
+        }
+    }
+
+    // Store in height tile steps, rounded up so the bound stays conservative.
+    // No error can exceed the tile's height range, so it always fits in 16 bits.
+    errors.resize(vertexErrors.size());
+    for (size_t i = 0; i < vertexErrors.size(); i++) {
+        float steps = heightTile.heightScale > 0.0f ? std::ceil(vertexErrors[i] / heightTile.heightScale) : 0.0f;
+        errors[i] = (uint16_t)bx::min(steps, 65535.0f);
+    }
+}
+
+std::vector<uint16_t> TerrainChunk::generateAdaptiveIndices(float maxError) const {
+    std::vector<uint16_t> adaptiveIndices;
+    const int gridSize = CHUNK_SIZE + 1;
+    std::vector<bool> used(gridSize * gridSize, false);
+    const float maxErrorSteps = heightTile.heightScale > 0.0f ? maxError / heightTile.heightScale : 65536.0f;
+
+    // Split a triangle while its hypotenuse midpoint error is above the bound
+    auto processTriangle = [&](auto& self, int ax, int az, int bx, int bz, int cx, int cz) -> void {
+        int mx = (ax + bx) >> 1;
+        int mz = (az + bz) >> 1;
+        if (std::abs(ax - cx) + std::abs(az - cz) > 1 && errors[mz * gridSize + mx] > maxErrorSteps) {
+            self(self, cx, cz, ax, az, mx, mz);
+            self(self, bx, bz, cx, cz, mx, mz);
+            return;
+        }
+        uint16_t a = (uint16_t)(az * gridSize + ax);
+        uint16_t b = (uint16_t)(bz * gridSize + bx);
+        uint16_t c = (uint16_t)(cz * gridSize + cx);
+        adaptiveIndices.push_back(a);
+        adaptiveIndices.push_back(b);
+        adaptiveIndices.push_back(c);
+        used[a] = used[b] = used[c] = true;
+    };
+    processTriangle(processTriangle, 0, 0, CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE, 0);
+    processTriangle(processTriangle, CHUNK_SIZE, CHUNK_SIZE, 0, 0, 0, CHUNK_SIZE);
+
+    // Skirts: one quad down to the skirt vertices for every edge segment the mesh uses
+    const uint16_t skirtBase = (uint16_t)(gridSize * gridSize);
+    for (int edge = 0; edge < 4; edge++) {
+        int previous = -1;
+        for (int i = 0; i < gridSize; i++) {
+            uint16_t top1 = getEdgeVertexIndex(edge, i);
+            if (!used[top1]) continue;
+
+            if (previous >= 0) {
+                uint16_t top0 = getEdgeVertexIndex(edge, previous);
+                uint16_t bottom0 = skirtBase + edge * gridSize + previous;
+                uint16_t bottom1 = skirtBase + edge * gridSize + i;
+                adaptiveIndices.push_back(top0);
+                adaptiveIndices.push_back(bottom0);
+                adaptiveIndices.push_back(top1);
+                adaptiveIndices.push_back(top1);
+                adaptiveIndices.push_back(bottom0);
+                adaptiveIndices.push_back(bottom1);
+            }
+            previous = i;
+        }
+    }
+
+    return adaptiveIndices;
+}
+
+void TerrainChunk::updateAdaptiveBuffer(float maxError) {
+    if (errors.empty()) return;
+
+    std::vector<uint16_t> adaptiveIndices = generateAdaptiveIndices(maxError);
+    if (adaptiveIndices.empty() || adaptiveIndices.size() > MAX_ADAPTIVE_INDEX_COUNT) return;
+
+    // Sized for the densest mesh once, then refilled whenever the error bound changes
+    if (!bgfx::isValid(adaptiveIbh)) {
+        adaptiveIbh = bgfx::createDynamicIndexBuffer(MAX_ADAPTIVE_INDEX_COUNT);
+        if (!bgfx::isValid(adaptiveIbh)) return;
+        gpuMemoryBytes += MAX_ADAPTIVE_INDEX_COUNT * sizeof(uint16_t);
+        bufferStats.created++;
+    } else {
+        bufferStats.updated++;
+    }
+    bgfx::update(adaptiveIbh, 0, bgfx::copy(adaptiveIndices.data(), (uint32_t)(adaptiveIndices.size() * sizeof(uint16_t))));
+    adaptiveTriangleCount = (uint32_t)(adaptiveIndices.size() / 3);
+    adaptiveMaxError = maxError;
+}
+
+void TerrainChunk::checkForWater() {
+    // Check if any terrain vertices are below sea level
+    hasWater = false;
+    for (size_t i = 0; i < heightTile.samples.size(); i++) {
+        if (heightTile.getHeight((int)i) < SEA_LEVEL) {
+            hasWater = true;
+            break;
+        }
+    }
+}
+
+void TerrainChunk::validateChunkGeometry() {
+    bool hasIssues = false;
+    float minY = 1000000.0f, maxY = -1000000.0f;
+    int invalidVertices = 0;
+
+    // Check for invalid vertices
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto& v = vertices[i];
+
+        // Check for NaN or infinite values
+        if (!std::isfinite(v.x) || !std::isfinite(v.y) || !std::isfinite(v.z)) {
+            std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") vertex " << i
+                      << " has invalid position: (" << v.x << ", " << v.y << ", " << v.z << ")" << std::endl;
+            invalidVertices++;
+            hasIssues = true;
+        }
+
+        // Track height bounds
+        if (std::isfinite(v.y)) {
+            minY = bx::min(minY, v.y);
+            maxY = bx::max(maxY, v.y);
+        }
+
+        // Check for extreme positions
+        if (bx::abs(v.x) > 10000.0f || bx::abs(v.z) > 10000.0f) {
+            std::cerr << "WARNING: Chunk (" << chunkX << ", " << chunkZ << ") vertex " << i
+                      << " at extreme position: (" << v.x << ", " << v.y << ", " << v.z << ")" << std::endl;
+            hasIssues = true;
+        }
+    }
+
+    // Check height range
+    float heightRange = maxY - minY;
+    if (heightRange > 100.0f) {
+        std::cerr << "WARNING: Chunk (" << chunkX << ", " << chunkZ << ") has extreme height range: "
+                  << minY << " to " << maxY << " (range: " << heightRange << ")" << std::endl;
+        hasIssues = true;
+    }
+
+    // Shared LOD index buffers address the full grid
+    const size_t expectedVertices = (CHUNK_SIZE + 1) * (CHUNK_SIZE + 1);
+    if (vertices.size() != expectedVertices) {
+        std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") has " << vertices.size()
+                  << " vertices, expected " << expectedVertices << std::endl;
+        hasIssues = true;
+    }
+
+    if (hasIssues) {
+        std::cerr << "CHUNK VALIDATION FAILED for (" << chunkX << ", " << chunkZ << ")" << std::endl;
+    }
+}
+
+const char* TerrainChunk::getBiomeName() const {
+    return ChunkManager::getBiomeName(biome);
+}
+
+void TerrainChunk::createBuffers() {
+    if (vertices.empty()) {
+        std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") has no vertices!" << std::endl;
+        return;
+    }
+    if (vertices.size() + SKIRT_VERTEX_COUNT != VERTEX_BUFFER_COUNT) {
+        std::cerr << "ERROR: Chunk (" << chunkX << ", " << chunkZ << ") has " << vertices.size()
+                  << " vertices, doesn't fit its vertex buffer" << std::endl;
+        return;
+    }
+
+    // A recycled chunk already owns a buffer of the right size
+    bool created = false;
+    if (!bgfx::isValid(vbh)) {
+        vbh = bgfx::createDynamicVertexBuffer(VERTEX_BUFFER_COUNT, getTerrainLayout());
+        if (!bgfx::isValid(vbh)) {
+            std::cerr << "ERROR: Failed to create vertex buffer for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
+            return;
+        }
+        gpuMemoryBytes += VERTEX_BUFFER_COUNT * sizeof(TerrainVertex);
+        bufferStats.created++;
+        created = true;
+    } else {
+        bufferStats.updated++;
+    }
+
+    // Grid vertices followed by the skirt rows used by adaptive meshes
+    const bgfx::Memory* vertexMem = bgfx::alloc(VERTEX_BUFFER_COUNT * sizeof(TerrainVertex));
+    TerrainVertex* uploadVertices = (TerrainVertex*)vertexMem->data;
+    std::copy(vertices.begin(), vertices.end(), uploadVertices);
+
+    const int gridSize = CHUNK_SIZE + 1;
+    TerrainVertex* skirtVertices = uploadVertices + vertices.size();
+    for (int edge = 0; edge < 4; edge++) {
+        for (int i = 0; i < gridSize; i++) {
+            TerrainVertex skirt = vertices[getEdgeVertexIndex(edge, i)];
+            skirt.y -= SKIRT_DEPTH;
+            skirtVertices[edge * gridSize + i] = skirt;
+        }
+    }
+
+    bgfx::update(vbh, 0, vertexMem);
+    uploaded = true;
+    std::cout << "Successfully " << (created ? "created " : "recycled buffers for ") << getBiomeName() << " chunk ("
+              << chunkX << ", " << chunkZ << ") with " << vertices.size() << " vertices" << std::endl;
+}
+
+void TerrainChunk::setHeights(int x0, int z0, int x1, int z1, const float* heights) {
+    const int gridSize = CHUNK_SIZE + 1;
+    const int width = x1 - x0 + 1;
+    bool requantized = false;
+    for (int z = z0; z <= z1; z++) {
+        for (int x = x0; x <= x1; x++) {
+            if (!heightTile.setHeight(z * gridSize + x, heights[(z - z0) * width + (x - x0)])) {
+                requantized = true;
+            }
+        }
+    }
+
+    // Some height left the tile's range: decode, apply the edit and requantize everything
+    if (requantized) {
+        std::vector<float> allHeights(heightTile.samples.size());
+        for (size_t i = 0; i < allHeights.size(); i++) {
+            allHeights[i] = heightTile.getHeight((int)i);
+        }
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                allHeights[z * gridSize + x] = heights[(z - z0) * width + (x - x0)];
+            }
+        }
+        heightTile.build(allHeights, EDIT_HEIGHT_MARGIN);
+        heightPyramid.build(heightTile.samples);
+        x0 = z0 = 0;
+        x1 = z1 = CHUNK_SIZE;
+    } else {
+        heightPyramid.update(heightTile.samples, x0, z0, x1, z1);
+    }
+
+    // Cheap enough per chunk to redo in full; RTIN errors propagate to every ancestor anyway
+    PathFinder::buildWalkCosts(heightTile.samples, heightTile.minHeight, heightTile.heightScale, walkCosts);
+    buildErrorHierarchy();
+    checkForWater();
+    heightsEdited = true;
+
+    if (uploaded) {
+        uploadVertexRows(z0, z1);
+        if (adaptiveMaxError >= 0.0f) {
+            updateAdaptiveBuffer(adaptiveMaxError);
+        }
+    }
+}
+
+void TerrainChunk::uploadVertexRows(int z0, int z1) {
+    // Whole rows, so the grid vertices go up as one contiguous range
+    const int gridSize = CHUNK_SIZE + 1;
+    const uint32_t rowVertexCount = (uint32_t)((z1 - z0 + 1) * gridSize);
+    const bgfx::Memory* rowMem = bgfx::alloc(rowVertexCount * sizeof(TerrainVertex));
+    TerrainVertex* rowVertices = (TerrainVertex*)rowMem->data;
+
+    // Weights depend only on position; one kernel call covers every edited row
+    std::vector<float> biomeWeights(rowVertexCount * TerrainKernel::kBiomeWeightCount);
+    TerrainKernel::generateBiomeWeights(chunkX * CHUNK_SIZE, chunkZ * CHUNK_SIZE + z0, gridSize, z1 - z0 + 1, SCALE,
+                                        biomeWeights.data());
+    for (int z = z0; z <= z1; z++) {
+        for (int x = 0; x <= CHUNK_SIZE; x++) {
+            TerrainVertex& vertex = rowVertices[(z - z0) * gridSize + x];
+            vertex.x = (chunkX * CHUNK_SIZE + x) * SCALE;
+            vertex.y = heightTile.getHeight(z * gridSize + x);
+            vertex.z = (chunkZ * CHUNK_SIZE + z) * SCALE;
+            vertex.u = float(x) / CHUNK_SIZE;
+            vertex.v = float(z) / CHUNK_SIZE;
+            vertex.biomeWeights = packBiomeWeights(&biomeWeights[((z - z0) * gridSize + x) * TerrainKernel::kBiomeWeightCount]);
+        }
+    }
+    bgfx::update(vbh, (uint32_t)(z0 * gridSize), rowMem);
+    bufferStats.updated++;
+
+    // Skirt vertices hanging below the edited part of each edge
+    for (int edge = 0; edge < 4; edge++) {
+        int first = 0, last = CHUNK_SIZE;
+        if (edge == 0 || edge == 2) {
+            int edgeRow = edge == 0 ? 0 : CHUNK_SIZE;
+            if (edgeRow < z0 || edgeRow > z1) continue;
+        } else {
+            first = z0;
+            last = z1;
+        }
+
+        const bgfx::Memory* skirtMem = bgfx::alloc((uint32_t)((last - first + 1) * sizeof(TerrainVertex)));
+        TerrainVertex* skirtVertices = (TerrainVertex*)skirtMem->data;
+        for (int i = first; i <= last; i++) {
+            int gridIndex = getEdgeVertexIndex(edge, i);
+            TerrainVertex skirt = rowVertices[gridIndex - z0 * gridSize];
+            skirt.y -= SKIRT_DEPTH;
+            skirtVertices[i - first] = skirt;
+        }
+        bgfx::update(vbh, (uint32_t)(gridSize * gridSize + edge * gridSize + first), skirtMem);
+    }
+}
+
+size_t TerrainChunk::getCpuMemoryBytes() const {
+    return sizeof(TerrainChunk)
+        + vertices.capacity() * sizeof(TerrainVertex)
+        + heightTile.getMemoryBytes()
+        + heightPyramid.getMemoryBytes()
+        + walkCosts.capacity()
+        + errors.capacity() * sizeof(uint16_t)
+        + resourceSpawns.capacity() * sizeof(ResourceSpawn)
+        + npcSpawns.capacity() * sizeof(NPCSpawn);
+}
+
+void TerrainChunk::getBounds(bx::Vec3& boundsMin, bx::Vec3& boundsMax) const {
+    const float chunkWorldSize = CHUNK_SIZE * SCALE;
+    boundsMin = { chunkX * chunkWorldSize, heightTile.minHeight - 5.0f - SKIRT_DEPTH, chunkZ * chunkWorldSize };
+    // Raised to sea level for water chunks so the bounds contain their part of the water surface
+    float maxHeight = hasWater ? bx::max(heightTile.getMaxHeight(), SEA_LEVEL) : heightTile.getMaxHeight();
+    boundsMax = { (chunkX + 1) * chunkWorldSize, maxHeight - 5.0f, (chunkZ + 1) * chunkWorldSize };
+}
+
+bool TerrainChunk::raycast(const bx::Vec3& origin, const bx::Vec3& direction, float tMin, float tMax, float& tHit) const {
+    // Into grid space: cells from the chunk corner, heights without the 5 unit draw offset.
+    // x/z are only scaled, so t means the same distance in both spaces.
+    const float localOrigin[3] = { origin.x / SCALE - chunkX * CHUNK_SIZE, origin.y + 5.0f, origin.z / SCALE - chunkZ * CHUNK_SIZE };
+    const float localDirection[3] = { direction.x / SCALE, direction.y, direction.z / SCALE };
+    return heightPyramid.raycast(heightTile.samples, heightTile.minHeight, heightTile.heightScale,
+                                 localOrigin, localDirection, tMin, tMax, tHit);
+}
+
+float TerrainChunk::getHeightAt(float worldX, float worldZ) const {
+    // Convert world coordinates to local chunk coordinates
+    float localX = worldX / SCALE - (chunkX * CHUNK_SIZE);
+    float localZ = worldZ / SCALE - (chunkZ * CHUNK_SIZE);
+
+    // Clamp to chunk bounds
+    if (localX < 0 || localX >= CHUNK_SIZE || localZ < 0 || localZ >= CHUNK_SIZE) {
+        return 0.0f;
+    }
+
+    int x1 = (int)localX;
+    int z1 = (int)localZ;
+    int x2 = bx::min(x1 + 1, CHUNK_SIZE);
+    int z2 = bx::min(z1 + 1, CHUNK_SIZE);
+
+    float fx = localX - x1;
+    float fz = localZ - z1;
+
+    // Get heights at four corners (with new vertex row size)
+    const int vertexRowSize = CHUNK_SIZE + 1;
+    float h1 = heightTile.getHeight(z1 * vertexRowSize + x1);
+    float h2 = heightTile.getHeight(z1 * vertexRowSize + x2);
+    float h3 = heightTile.getHeight(z2 * vertexRowSize + x1);
+    float h4 = heightTile.getHeight(z2 * vertexRowSize + x2);
+
+    // Bilinear interpolation
+    float top = h1 * (1 - fx) + h2 * fx;
+    float bottom = h3 * (1 - fx) + h4 * fx;
+    return top * (1 - fz) + bottom * fz;
+}
+
+std::unique_ptr<TerrainChunk> ChunkGrid::insert(std::unique_ptr<TerrainChunk> chunk) {
+    std::unique_ptr<TerrainChunk>& slot = slots[getSlot(chunk->chunkX, chunk->chunkZ)];
+    std::unique_ptr<TerrainChunk> displaced = std::move(slot);
+    if (displaced) {
+        count--;
+        if (lastHit == displaced.get()) lastHit = nullptr;
+    }
+    slot = std::move(chunk);
+    count++;
+    return displaced;
+}
+
+std::unique_ptr<TerrainChunk> ChunkGrid::remove(int chunkX, int chunkZ) {
+    std::unique_ptr<TerrainChunk>& slot = slots[getSlot(chunkX, chunkZ)];
+    if (!slot || slot->chunkX != chunkX || slot->chunkZ != chunkZ) {
+        return nullptr;
+    }
+    if (lastHit == slot.get()) lastHit = nullptr;
+    count--;
+    return std::move(slot);
+}
+
+void ChunkGrid::clear() {
+    for (auto& slot : slots) {
+        slot.reset();
+    }
+    count = 0;
+    lastHit = nullptr;
+}
+
+// ChunkPool implementation
+std::unique_ptr<TerrainChunk> ChunkPool::acquire(int chunkX, int chunkZ, BiomeType biome) {
+    std::unique_ptr<TerrainChunk> chunk;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!chunks.empty()) {
+            chunk = std::move(chunks.back());
+            chunks.pop_back();
+            stats.chunksReused++;
+        } else {
+            stats.chunksAllocated++;
+        }
+    }
+    if (chunk) {
+        chunk->reset(chunkX, chunkZ, biome);
+        return chunk;
+    }
+    return std::make_unique<TerrainChunk>(chunkX, chunkZ, biome);
+}
+
+void ChunkPool::release(std::unique_ptr<TerrainChunk> chunk) {
+    if (!chunk) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (chunks.size() < MAX_CHUNKS) {
+        chunks.push_back(std::move(chunk));
+    }
+    // Otherwise it's destroyed here, with its buffers
+}
+
+std::vector<TerrainVertex> ChunkPool::acquireVertices() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (vertexArrays.empty()) {
+        stats.vertexArraysAllocated++;
+        return {};
+    }
+    std::vector<TerrainVertex> vertices = std::move(vertexArrays.back());
+    vertexArrays.pop_back();
+    stats.vertexArraysReused++;
+    return vertices;
+}
+
+void ChunkPool::releaseVertices(std::vector<TerrainVertex>& vertices) {
+    std::vector<TerrainVertex> released;
+    released.swap(vertices);
+    if (released.capacity() == 0) return;
+
+    released.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (vertexArrays.size() < MAX_VERTEX_ARRAYS) {
+        vertexArrays.push_back(std::move(released));
+    }
+}
+
+void ChunkPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    chunks.clear();
+    vertexArrays.clear();
+}
+
+void ChunkPool::trim(size_t cpuBytes, size_t gpuBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t freedCpu = 0, freedGpu = 0, dropped = 0;
+    while (dropped < chunks.size() && (freedCpu < cpuBytes || freedGpu < gpuBytes)) {
+        freedCpu += chunks[dropped]->getCpuMemoryBytes();
+        freedGpu += chunks[dropped]->getGpuMemoryBytes();
+        dropped++;
+    }
+    // Acquire takes from the back, so the front has waited longest
+    chunks.erase(chunks.begin(), chunks.begin() + dropped);
+}
+
+ChunkPool::Stats ChunkPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats current = stats;
+    current.pooledChunks = chunks.size();
+    for (const auto& chunk : chunks) {
+        current.pooledCpuBytes += chunk->getCpuMemoryBytes();
+        current.pooledGpuBytes += chunk->getGpuMemoryBytes();
+    }
+    for (const auto& vertices : vertexArrays) {
+        current.pooledCpuBytes += vertices.capacity() * sizeof(TerrainVertex);
+    }
+    return current;
+}
+
+// ChunkManager implementation
+ChunkManager::ChunkManager() {
+    for (int lod = 0; lod < TerrainChunk::LOD_COUNT; lod++) {
+        for (int mask = 0; mask < TerrainChunk::STITCH_VARIANTS; mask++) {
+            lodIndexBuffers[lod][mask] = BGFX_INVALID_HANDLE;
+        }
+    }
+    for (auto& biomeTexture : biomeTextures) {
+        biomeTexture = BGFX_INVALID_HANDLE;
+    }
+}
+
+ChunkManager::~ChunkManager() {
+    shutdown();
+}
+
+void ChunkManager::shutdown() {
+    // Persist what's resident so the next session starts warm
+    std::vector<TerrainChunk*> residentChunks;
+    for (TerrainChunk* chunk : loadedChunks) {
+        residentChunks.push_back(chunk);
+    }
+    syncChunkEntities(residentChunks);
+    for (TerrainChunk* chunk : residentChunks) {
+        saveChunk(*chunk);
+    }
+
+    // Wait for the workers rather than drop their futures: a recycled chunk must not be
+    // destroyed (with its buffers) on a worker thread
+    for (auto& pair : pendingChunks) {
+        pair.second.cancelled->store(true);
+        pair.second.result.wait();
+    }
+    for (auto& job : cancelledJobs) {
+        job.wait();
+    }
+    pendingChunks.clear();
+    cancelledJobs.clear();
+    uploadQueue.clear();
+    loadedChunks.clear();
+    warmChunks.clear();
+    warmChunkIndex.clear();
+    chunkPool.clear();
+
+    for (int lod = 0; lod < TerrainChunk::LOD_COUNT; lod++) {
+        for (int mask = 0; mask < TerrainChunk::STITCH_VARIANTS; mask++) {
+            if (bgfx::isValid(lodIndexBuffers[lod][mask])) {
+                bgfx::destroy(lodIndexBuffers[lod][mask]);
+                lodIndexBuffers[lod][mask] = BGFX_INVALID_HANDLE;
+            }
+        }
+    }
+    for (auto& biomeTexture : biomeTextures) {
+        if (bgfx::isValid(biomeTexture)) {
+            bgfx::destroy(biomeTexture);
+            biomeTexture = BGFX_INVALID_HANDLE;
+        }
+    }
+    if (bgfx::isValid(biomeTextureArray)) {
+        bgfx::destroy(biomeTextureArray);
+        biomeTextureArray = BGFX_INVALID_HANDLE;
+    }
+}
+
+void ChunkManager::createLodIndexBuffers() {
+    for (int lod = 0; lod < TerrainChunk::LOD_COUNT; lod++) {
+        for (int mask = 0; mask < TerrainChunk::STITCH_VARIANTS; mask++) {
+            std::vector<uint16_t> lodIndices = TerrainChunk::generateIndices(lod, (uint8_t)mask);
+            lodIndexBuffers[lod][mask] = bgfx::createIndexBuffer(
+                bgfx::copy(lodIndices.data(), lodIndices.size() * sizeof(uint16_t)));
+            lodTriangleCounts[lod][mask] = (uint32_t)(lodIndices.size() / 3);
+        }
+    }
+    std::cout << "Created " << TerrainChunk::LOD_COUNT * TerrainChunk::STITCH_VARIANTS
+              << " shared terrain index buffers (LOD0 " << lodTriangleCounts[0][0]
+              << " tris, LOD" << TerrainChunk::LOD_COUNT - 1 << " "
+              << lodTriangleCounts[TerrainChunk::LOD_COUNT - 1][0] << " tris)" << std::endl;
+}
+
+bgfx::TextureHandle ChunkManager::getBiomeTexture(BiomeType biome) {
+    bgfx::TextureHandle& biomeTexture = biomeTextures[(int)biome];
+    if (!bgfx::isValid(biomeTexture)) {
+        biomeTexture = create_biome_texture(biome);
+        if (!bgfx::isValid(biomeTexture)) {
+            std::cerr << "ERROR: Failed to create " << getBiomeName(biome) << " texture" << std::endl;
+        }
+    }
+    return biomeTexture;
+}
+
+bgfx::TextureHandle ChunkManager::getBiomeTextureArray() {
+    if (bgfx::isValid(biomeTextureArray) || biomeTextureArrayFailed) {
+        return biomeTextureArray;
+    }
+
+    if ((bgfx::getCaps()->supported & BGFX_CAPS_TEXTURE_2D_ARRAY) == 0) {
+        std::cerr << "Texture arrays not supported, terrain falls back to one texture per biome" << std::endl;
+        biomeTextureArrayFailed = true;
+        return biomeTextureArray;
+    }
+
+    // One layer per BiomeType, matching the channels of TerrainVertex::biomeWeights
+    const uint32_t layerSize = BIOME_TEXTURE_SIZE * BIOME_TEXTURE_SIZE * 4;
+    const bgfx::Memory* texMem = bgfx::alloc(layerSize * BIOME_COUNT);
+    for (int biome = 0; biome < BIOME_COUNT; biome++) {
+        generate_biome_texture_pixels((BiomeType)biome, texMem->data + biome * layerSize);
+    }
+
+    uint64_t textureFlags = BGFX_TEXTURE_NONE;
+    textureFlags |= BGFX_SAMPLER_MIN_ANISOTROPIC;
+    textureFlags |= BGFX_SAMPLER_MAG_ANISOTROPIC;
+    biomeTextureArray = bgfx::createTexture2D(BIOME_TEXTURE_SIZE, BIOME_TEXTURE_SIZE, false, BIOME_COUNT,
+                                              bgfx::TextureFormat::RGBA8, textureFlags, texMem);
+    if (!bgfx::isValid(biomeTextureArray)) {
+        std::cerr << "ERROR: Failed to create biome texture array" << std::endl;
+        biomeTextureArrayFailed = true;
+    } else {
+        std::cout << "Created biome texture array (" << BIOME_COUNT << " layers, "
+                  << (layerSize * BIOME_COUNT) / 1024 << " KB)" << std::endl;
+    }
+    return biomeTextureArray;
+}
+
+void ChunkManager::setBiomeBlendProgram(bgfx::ProgramHandle program, bgfx::UniformHandle biomeSampler) {
+    biomeBlendProgram = program;
+    biomeArraySampler = biomeSampler;
+}
+
+void ChunkManager::setAdaptiveMeshing(bool enabled, float maxError, bool screenSpace) {
+    adaptiveMeshing = enabled;
+    adaptiveMaxError = maxError;
+    adaptiveScreenSpace = screenSpace;
+    std::cout << "Terrain meshing: " << (enabled ? "adaptive" : "geomipmap");
+    if (enabled) {
+        std::cout << " (max error " << maxError << (screenSpace ? " px" : " world units") << ")";
+    }
+    std::cout << std::endl;
+}
+
+void ChunkManager::setScreenErrorProjection(float fovYDegrees, float viewportHeight) {
+    pixelsToWorldAtUnitDistance = 2.0f * bx::tan(bx::toRad(fovYDegrees) * 0.5f) / viewportHeight;
+}
+
+float ChunkManager::getAdaptiveErrorForChunk(int chunkX, int chunkZ) const {
+    if (!adaptiveScreenSpace) {
+        return adaptiveMaxError;
+    }
+
+    // Distance from the player's chunk to the near side of this chunk, at least one chunk
+    // so the error bound only changes when the player crosses a chunk border
+    const float chunkWorldSize = TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+    int ringDistance = bx::max(bx::abs(chunkX - playerChunkX), bx::abs(chunkZ - playerChunkZ));
+    float distance = bx::max(1, ringDistance) * chunkWorldSize;
+    return adaptiveMaxError * pixelsToWorldAtUnitDistance * distance;
+}
+
+int ChunkManager::getChunkLod(int chunkX, int chunkZ) const {
+    int ringDistance = bx::max(bx::abs(chunkX - playerChunkX), bx::abs(chunkZ - playerChunkZ));
+    return bx::min(ringDistance / LOD_RING_WIDTH, TerrainChunk::LOD_COUNT - 1);
+}
+
+uint64_t ChunkManager::getChunkKey(int chunkX, int chunkZ) {
+    // Handle negative coordinates properly by treating as signed
+    uint64_t x = static_cast<uint64_t>(static_cast<uint32_t>(chunkX));
+    uint64_t z = static_cast<uint64_t>(static_cast<uint32_t>(chunkZ));
+    return (x << 32) | z;
+}
+
+BiomeType ChunkManager::getBiomeForChunk(int chunkX, int chunkZ) {
+    return getBiomeAtWorldPos(chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE,
+                              chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE);
+}
+
+BiomeType ChunkManager::getBiomeAtWorldPos(float worldX, float worldZ) {
+    // Use very large scale for biome assignment to create big continuous regions
+    float biomeNoise = bx::sin(worldX * 0.001f) * bx::cos(worldZ * 0.0008f);
+    biomeNoise += bx::sin(worldX * 0.0005f + worldZ * 0.0007f) * 0.3f;
+
+    // Smoother thresholds for gradual transitions
+    if (biomeNoise < -0.3f) return BiomeType::SWAMP;
+    if (biomeNoise < -0.1f) return BiomeType::DESERT;
+    if (biomeNoise < 0.2f) return BiomeType::GRASSLAND;
+    return BiomeType::MOUNTAINS;
+}
+
+const char* ChunkManager::getBiomeName(BiomeType biome) {
+    switch (biome) {
+        case BiomeType::DESERT: return "Desert";
+        case BiomeType::MOUNTAINS: return "Mountains";
+        case BiomeType::SWAMP: return "Swamp";
+        case BiomeType::GRASSLAND: return "Grassland";
+        default: return "Unknown";
+    }
+}
+
+std::unique_ptr<TerrainChunk> ChunkManager::buildChunk(int chunkX, int chunkZ, ChunkCache* cache,
+                                                       const std::atomic<bool>* cancelled, ChunkPool* pool) {
+    if (cancelled && cancelled->load()) {
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BiomeType biome = getBiomeForChunk(chunkX, chunkZ);
+    std::unique_ptr<TerrainChunk> chunk = pool ? pool->acquire(chunkX, chunkZ, biome)
+                                               : std::make_unique<TerrainChunk>(chunkX, chunkZ, biome);
+    if (pool && chunk->vertices.capacity() == 0) {
+        chunk->vertices = pool->acquireVertices();
+    }
+
+    std::vector<uint8_t> record;
+    if (cache && cache->read(chunkX, chunkZ, getChunkKey(chunkX, chunkZ), record)) {
+        chunk->loadedFromCache = chunk->loadFromCache(record);
+    }
+    if (!chunk->loadedFromCache) {
+        // Fresh chunk; also covers records that didn't match, which get replaced on save
+        chunk->reset(chunkX, chunkZ, biome);
+        chunk->generate();
+        generateSpawns(*chunk);
+    }
+
+    chunk->buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return chunk;
+}
+
+void ChunkManager::generateSpawns(TerrainChunk& chunk) {
+    chunk.resourceSpawns.clear();
+    chunk.npcSpawns.clear();
+    generateResourceSpawns(chunk);
+    generateNPCSpawns(chunk);
+}
+
+void ChunkManager::generateResourceSpawns(TerrainChunk& chunk) {
+    const int chunkX = chunk.chunkX;
+    const int chunkZ = chunk.chunkZ;
+    BiomeType chunkBiome = getBiomeForChunk(chunkX, chunkZ);
+
+    // World coordinates for this chunk
+    float chunkWorldX = chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+    float chunkWorldZ = chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+
+    // Generate resource nodes based on biome
+    float density = 0.3f; // Base density
+
+    // Biome-specific resource generation
+    switch (chunkBiome) {
+        case BiomeType::MOUNTAINS:
+            // Mountains have iron and stone
+            density = 0.5f; // Higher density in mountains
+            for (int attempts = 0; attempts < 8; attempts++) {
+                float seed = (chunkX * 73.0f + chunkZ * 47.0f + attempts * 23.0f);
+                float noiseValue = bx::sin(seed * 0.1f) * bx::cos(seed * 0.13f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.7f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.8f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    ResourceType resourceType = (bx::sin(seed * 0.9f) > 0.0f) ? ResourceType::IRON : ResourceType::STONE;
+                    float worldY = chunk.getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
+
+                    chunk.resourceSpawns.push_back({worldX, worldY, worldZ, resourceType});
+                }
+            }
+            break;
+
+        case BiomeType::DESERT:
+            // Desert has copper and stone
+            density = 0.25f;
+            for (int attempts = 0; attempts < 6; attempts++) {
+                float seed = (chunkX * 67.0f + chunkZ * 53.0f + attempts * 29.0f);
+                float noiseValue = bx::sin(seed * 0.15f) * bx::cos(seed * 0.11f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.6f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.7f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    ResourceType resourceType = (bx::sin(seed * 0.8f) > 0.2f) ? ResourceType::COPPER : ResourceType::STONE;
+                    float worldY = chunk.getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
+
+                    chunk.resourceSpawns.push_back({worldX, worldY, worldZ, resourceType});
+                }
+            }
+            break;
+
+        case BiomeType::GRASSLAND:
+            // Grassland has balanced resources
+            density = 0.35f;
+            for (int attempts = 0; attempts < 7; attempts++) {
+                float seed = (chunkX * 71.0f + chunkZ * 41.0f + attempts * 31.0f);
+                float noiseValue = bx::sin(seed * 0.12f) * bx::cos(seed * 0.14f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.65f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.75f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    // Balanced distribution of all resource types
+                    float typeNoise = bx::sin(seed * 1.1f);
+                    ResourceType resourceType;
+                    if (typeNoise < -0.3f) resourceType = ResourceType::COPPER;
+                    else if (typeNoise < 0.3f) resourceType = ResourceType::IRON;
+                    else resourceType = ResourceType::STONE;
+
+                    float worldY = chunk.getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
+
+                    chunk.resourceSpawns.push_back({worldX, worldY, worldZ, resourceType});
+                }
+            }
+            break;
+
+        case BiomeType::SWAMP:
+            // Swamp has mainly iron and occasional stone
+            density = 0.2f; // Lower density in swamps
+            for (int attempts = 0; attempts < 5; attempts++) {
+                float seed = (chunkX * 61.0f + chunkZ * 59.0f + attempts * 37.0f);
+                float noiseValue = bx::sin(seed * 0.18f) * bx::cos(seed * 0.09f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.55f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.85f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    ResourceType resourceType = (bx::sin(seed * 1.2f) > 0.4f) ? ResourceType::IRON : ResourceType::STONE;
+                    float worldY = chunk.getHeightAt(worldX, worldZ) + 0.5f - 5.0f;
+
+                    chunk.resourceSpawns.push_back({worldX, worldY, worldZ, resourceType});
+                }
+            }
+            break;
+    }
+}
+
+void ChunkManager::generateNPCSpawns(TerrainChunk& chunk) {
+    const int chunkX = chunk.chunkX;
+    const int chunkZ = chunk.chunkZ;
+    BiomeType chunkBiome = getBiomeForChunk(chunkX, chunkZ);
+
+    // World coordinates for this chunk
+    float chunkWorldX = chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+    float chunkWorldZ = chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+
+    // Generate NPCs based on biome (lower density than resources)
+    float density = 0.1f; // Much lower base density than resources
+
+    // Biome-specific NPC generation
+    switch (chunkBiome) {
+        case BiomeType::GRASSLAND:
+            // Grasslands have the most NPCs (villages)
+            density = 0.15f;
+            for (int attempts = 0; attempts < 3; attempts++) {
+                float seed = (chunkX * 89.0f + chunkZ * 67.0f + attempts * 43.0f);
+                float noiseValue = bx::sin(seed * 0.08f) * bx::cos(seed * 0.12f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.5f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.6f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    NPCType npcType;
+                    float typeNoise = bx::sin(seed * 1.3f);
+                    if (typeNoise < -0.2f) npcType = NPCType::MERCHANT;
+                    else if (typeNoise < 0.4f) npcType = NPCType::VILLAGER;
+                    else npcType = NPCType::WANDERER;
+
+                    float worldY = chunk.getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
+
+                    chunk.npcSpawns.push_back({worldX, worldY, worldZ, npcType});
+                }
+            }
+            break;
+
+        case BiomeType::DESERT:
+            // Desert has wanderers and occasional merchants
+            density = 0.08f;
+            for (int attempts = 0; attempts < 2; attempts++) {
+                float seed = (chunkX * 97.0f + chunkZ * 73.0f + attempts * 47.0f);
+                float noiseValue = bx::sin(seed * 0.1f) * bx::cos(seed * 0.09f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.4f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.7f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    NPCType npcType = (bx::sin(seed * 0.9f) > 0.3f) ? NPCType::WANDERER : NPCType::MERCHANT;
+                    float worldY = chunk.getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
+
+                    chunk.npcSpawns.push_back({worldX, worldY, worldZ, npcType});
+                }
+            }
+            break;
+
+        case BiomeType::MOUNTAINS:
+            // Mountains have few NPCs, mostly wanderers
+            density = 0.05f;
+            for (int attempts = 0; attempts < 2; attempts++) {
+                float seed = (chunkX * 83.0f + chunkZ * 79.0f + attempts * 53.0f);
+                float noiseValue = bx::sin(seed * 0.15f) * bx::cos(seed * 0.07f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.6f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.8f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    NPCType npcType = NPCType::WANDERER; // Only wanderers in mountains
+                    float worldY = chunk.getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
+
+                    chunk.npcSpawns.push_back({worldX, worldY, worldZ, npcType});
+                }
+            }
+            break;
+
+        case BiomeType::SWAMP:
+            // Swamps have very few NPCs
+            density = 0.03f;
+            for (int attempts = 0; attempts < 1; attempts++) {
+                float seed = (chunkX * 101.0f + chunkZ * 103.0f + attempts * 59.0f);
+                float noiseValue = bx::sin(seed * 0.18f) * bx::cos(seed * 0.06f);
+
+                if (noiseValue > (1.0f - density)) {
+                    float offsetX = (bx::sin(seed * 0.3f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float offsetZ = (bx::cos(seed * 0.9f) * 0.5f + 0.5f) * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+                    float worldX = chunkWorldX + offsetX;
+                    float worldZ = chunkWorldZ + offsetZ;
+
+                    NPCType npcType = NPCType::WANDERER; // Only wanderers in swamps
+                    float worldY = chunk.getHeightAt(worldX, worldZ) - 5.0f + 0.1f; // Mannequin spawn on ground
+
+                    chunk.npcSpawns.push_back({worldX, worldY, worldZ, npcType});
+                }
+            }
+            break;
+    }
+}
+
+void ChunkManager::setResourceNodesPointer(std::vector<ResourceNode>* nodes) {
+    worldResourceNodes = nodes;
+}
+
+void ChunkManager::setNPCsPointer(std::vector<std::unique_ptr<NPC>>* npcs) {
+    worldNPCs = npcs;
+}
+
+void ChunkManager::setPlayerPointer(Player* playerPtr) {
+    player = playerPtr;
+}
+
+void ChunkManager::forceInitialChunkLoad(float playerX, float playerZ) {
+    playerChunkX = (int)bx::floor(playerX / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
+    playerChunkZ = (int)bx::floor(playerZ / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
+
+    playerPosX = playerX;
+    playerPosZ = playerZ;
+    playerVelocityX = 0.0f;
+    playerVelocityZ = 0.0f;
+    prefetchChunkX = playerChunkX;
+    prefetchChunkZ = playerChunkZ;
+    loadedChunks.setOrigin(playerChunkX - ChunkGrid::WINDOW_SIZE / 2, playerChunkZ - ChunkGrid::WINDOW_SIZE / 2);
+
+    std::cout << "Force loading initial chunks around player at chunk (" << playerChunkX << ", " << playerChunkZ << ")" << std::endl;
+
+    // Request chunks in render distance
+    refreshStreamRequests();
+
+    // The player needs terrain under their feet before the first frame. The surrounding
+    // chunks are at the front of the request queue, so keep dispatching and waiting on
+    // them, uploading without the per-frame budget. The rest of the view streams in over
+    // the following frames.
+    bool waiting = true;
+    while (waiting) {
+        dispatchStreamRequests();
+        waiting = false;
+        for (auto& pair : pendingChunks) {
+            const PendingChunk& pending = pair.second;
+            if (bx::abs(pending.chunkX - playerChunkX) <= 1 && bx::abs(pending.chunkZ - playerChunkZ) <= 1) {
+                pending.result.wait();
+                waiting = true;
+            }
+        }
+        collectFinishedChunks();
+        processUploadQueue(std::numeric_limits<float>::max());
+    }
+}
+
+void ChunkManager::updateChunksAroundPlayer(float playerX, float playerZ, float velocityX, float velocityZ) {
+    auto start = std::chrono::steady_clock::now();
+    const float chunkWorldSize = TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+
+    playerPosX = playerX;
+    playerPosZ = playerZ;
+    playerVelocityX = velocityX;
+    playerVelocityZ = velocityZ;
+
+    // Pick up chunks the workers have finished
+    collectFinishedChunks();
+
+    // Calculate which chunk the player is in, and where they will be in PREFETCH_SECONDS
+    int newPlayerChunkX = (int)bx::floor(playerX / chunkWorldSize);
+    int newPlayerChunkZ = (int)bx::floor(playerZ / chunkWorldSize);
+    const float maxAhead = PREFETCH_MAX_CHUNKS * chunkWorldSize;
+    float aheadX = bx::clamp(velocityX * PREFETCH_SECONDS, -maxAhead, maxAhead);
+    float aheadZ = bx::clamp(velocityZ * PREFETCH_SECONDS, -maxAhead, maxAhead);
+    int newPrefetchChunkX = (int)bx::floor((playerX + aheadX) / chunkWorldSize);
+    int newPrefetchChunkZ = (int)bx::floor((playerZ + aheadZ) / chunkWorldSize);
+
+    // Re-plan only when the player or the prefetch centre moved to a new chunk
+    bool playerMoved = newPlayerChunkX != playerChunkX || newPlayerChunkZ != playerChunkZ;
+    bool prefetchMoved = newPrefetchChunkX != prefetchChunkX || newPrefetchChunkZ != prefetchChunkZ;
+    if (playerMoved || prefetchMoved) {
+        playerChunkX = newPlayerChunkX;
+        playerChunkZ = newPlayerChunkZ;
+        prefetchChunkX = newPrefetchChunkX;
+        prefetchChunkZ = newPrefetchChunkZ;
+        loadedChunks.setOrigin(playerChunkX - ChunkGrid::WINDOW_SIZE / 2, playerChunkZ - ChunkGrid::WINDOW_SIZE / 2);
+
+        if (playerMoved) {
+            std::cout << "Player entered chunk (" << playerChunkX << ", " << playerChunkZ << ")" << std::endl;
+        }
+
+        cancelStaleRequests();
+        unloadDistantChunks();
+        refreshStreamRequests();
+    }
+
+    dispatchStreamRequests();
+
+    // Upload the most urgent chunks with whatever is left of the frame budget
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    processUploadQueue(STREAMING_BUDGET_MS - elapsed);
+
+    // Rebuild path clusters around whatever loaded or unloaded this frame
+    pathFinder.update();
+    lastStreamingMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+float ChunkManager::getHeightAt(float worldX, float worldZ) const {
+    int chunkX = (int)bx::floor(worldX / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
+    int chunkZ = (int)bx::floor(worldZ / (TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE));
+
+    if (const TerrainChunk* chunk = loadedChunks.find(chunkX, chunkZ)) {
+        return chunk->getHeightAt(worldX, worldZ);
+    }
+
+    // Not resident: evaluate the heightfield directly instead of forcing a chunk build
+    return heightTiles.getHeightAt(worldX, worldZ);
+}
+
+bool ChunkManager::raycast(const bx::Vec3& origin, const bx::Vec3& direction, float maxDistance, bx::Vec3& hitPoint) const {
+    const float chunkWorldSize = TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // Grid walk over the chunks the ray passes through, nearest first
+    int chunkX = (int)bx::floor(origin.x / chunkWorldSize);
+    int chunkZ = (int)bx::floor(origin.z / chunkWorldSize);
+    int stepX = direction.x > 0.0f ? 1 : -1;
+    int stepZ = direction.z > 0.0f ? 1 : -1;
+    float tDeltaX = direction.x != 0.0f ? chunkWorldSize / bx::abs(direction.x) : infinity;
+    float tDeltaZ = direction.z != 0.0f ? chunkWorldSize / bx::abs(direction.z) : infinity;
+    float tNextX = direction.x != 0.0f ? ((chunkX + (stepX > 0 ? 1 : 0)) * chunkWorldSize - origin.x) / direction.x : infinity;
+    float tNextZ = direction.z != 0.0f ? ((chunkZ + (stepZ > 0 ? 1 : 0)) * chunkWorldSize - origin.z) / direction.z : infinity;
+
+    float t = 0.0f;
+    while (t < maxDistance) {
+        float tExit = bx::min(bx::min(tNextX, tNextZ), maxDistance);
+
+        // Unloaded chunks have no terrain to hit
+        const TerrainChunk* chunk = loadedChunks.find(chunkX, chunkZ);
+        float tHit;
+        if (chunk && chunk->raycast(origin, direction, t, tExit, tHit)) {
+            hitPoint = { origin.x + direction.x * tHit, origin.y + direction.y * tHit, origin.z + direction.z * tHit };
+            return true;
+        }
+
+        if (tNextX < tNextZ) {
+            t = tNextX;
+            tNextX += tDeltaX;
+            chunkX += stepX;
+        } else {
+            t = tNextZ;
+            tNextZ += tDeltaZ;
+            chunkZ += stepZ;
+        }
+    }
+    return false;
+}
+
+ChunkManager::DeformResult ChunkManager::deformTerrain(const TerrainBrush& brush) {
+    auto start = std::chrono::steady_clock::now();
+    DeformResult result;
+    if (brush.radius <= 0.0f) return result;
+
+    // Chunk holding world grid coordinate g, and g's index inside it
+    auto toChunk = [](int g) { return (int)std::floor((float)g / TerrainChunk::CHUNK_SIZE); };
+
+    // World grid vertices under the brush
+    const float scale = TerrainChunk::SCALE;
+    const int gridX0 = (int)std::ceil((brush.x - brush.radius) / scale);
+    const int gridX1 = (int)std::floor((brush.x + brush.radius) / scale);
+    const int gridZ0 = (int)std::ceil((brush.z - brush.radius) / scale);
+    const int gridZ1 = (int)std::floor((brush.z + brush.radius) / scale);
+    const int width = gridX1 - gridX0 + 1;
+    const int depth = gridZ1 - gridZ0 + 1;
+    if (width <= 0 || depth <= 0) return result;
+
+    // New heights over the whole rectangle, computed once so every chunk holding a border
+    // vertex stores the same value. NaN marks vertices the brush leaves alone.
+    std::vector<float> editedHeights((size_t)width * depth, std::numeric_limits<float>::quiet_NaN());
+    const float radiusSquared = brush.radius * brush.radius;
+    for (int gridZ = gridZ0; gridZ <= gridZ1; gridZ++) {
+        for (int gridX = gridX0; gridX <= gridX1; gridX++) {
+            float dx = gridX * scale - brush.x;
+            float dz = gridZ * scale - brush.z;
+            float distanceSquared = dx * dx + dz * dz;
+            if (distanceSquared >= radiusSquared) continue;
+
+            // Border vertices belong to up to four chunks, all of which must be loaded
+            int chunkX = toChunk(gridX), chunkZ = toChunk(gridZ);
+            int localX = gridX - chunkX * TerrainChunk::CHUNK_SIZE;
+            int localZ = gridZ - chunkZ * TerrainChunk::CHUNK_SIZE;
+            bool allLoaded = true;
+            for (int ownerZ = localZ == 0 ? chunkZ - 1 : chunkZ; ownerZ <= chunkZ && allLoaded; ownerZ++) {
+                for (int ownerX = localX == 0 ? chunkX - 1 : chunkX; ownerX <= chunkX; ownerX++) {
+                    if (!loadedChunks.contains(ownerX, ownerZ)) {
+                        allLoaded = false;
+                        break;
+                    }
+                }
+            }
+            if (!allLoaded) continue;
+
+            float current = loadedChunks.find(chunkX, chunkZ)->getVertexHeight(localX, localZ);
+            float falloff = 1.0f - distanceSquared / radiusSquared;
+            falloff *= falloff;
+            float height = brush.mode == TerrainBrush::Mode::RAISE
+                ? current + brush.amount * falloff
+                : current + (brush.targetHeight - current) * bx::clamp(brush.amount * falloff, 0.0f, 1.0f);
+            editedHeights[(size_t)(gridZ - gridZ0) * width + (gridX - gridX0)] = height;
+            result.verticesChanged++;
+        }
+    }
+    if (result.verticesChanged == 0) return result;
+
+    // Hand each chunk the part of the rectangle it holds, trimmed to the edited vertices
+    std::vector<float> chunkHeights;
+    for (int chunkZ = toChunk(gridZ0 - 1); chunkZ <= toChunk(gridZ1); chunkZ++) {
+        for (int chunkX = toChunk(gridX0 - 1); chunkX <= toChunk(gridX1); chunkX++) {
+            TerrainChunk* chunk = loadedChunks.find(chunkX, chunkZ);
+            if (!chunk) continue;
+
+            const int baseX = chunkX * TerrainChunk::CHUNK_SIZE;
+            const int baseZ = chunkZ * TerrainChunk::CHUNK_SIZE;
+            int x0 = TerrainChunk::CHUNK_SIZE, z0 = TerrainChunk::CHUNK_SIZE, x1 = -1, z1 = -1;
+            for (int z = std::max(0, gridZ0 - baseZ); z <= std::min(TerrainChunk::CHUNK_SIZE, gridZ1 - baseZ); z++) {
+                for (int x = std::max(0, gridX0 - baseX); x <= std::min(TerrainChunk::CHUNK_SIZE, gridX1 - baseX); x++) {
+                    if (std::isnan(editedHeights[(size_t)(baseZ + z - gridZ0) * width + (baseX + x - gridX0)])) continue;
+                    x0 = std::min(x0, x);
+                    z0 = std::min(z0, z);
+                    x1 = std::max(x1, x);
+                    z1 = std::max(z1, z);
+                }
+            }
+            if (x1 < 0) continue;
+
+            chunkHeights.clear();
+            for (int z = z0; z <= z1; z++) {
+                for (int x = x0; x <= x1; x++) {
+                    float height = editedHeights[(size_t)(baseZ + z - gridZ0) * width + (baseX + x - gridX0)];
+                    chunkHeights.push_back(std::isnan(height) ? chunk->getVertexHeight(x, z) : height);
+                }
+            }
+            chunk->setHeights(x0, z0, x1, z1, chunkHeights.data());
+            pathFinder.addChunk(chunkX, chunkZ, chunk->walkCosts);
+            result.chunksChanged++;
+        }
+    }
+
+    // Resource nodes sit on the terrain; NPCs and the player follow it every frame anyway
+    resourceGrid.queryRadius(brush.x, brush.z, brush.radius, [this](ResourceNode* node) {
+        node->position.y = getHeightAt(node->position.x, node->position.z) + 0.5f - 5.0f;
+        TerrainChunk* owner = loadedChunks.find(node->chunkX, node->chunkZ);
+        if (owner && node->spawnIndex >= 0 && node->spawnIndex < (int)owner->resourceSpawns.size()) {
+            owner->resourceSpawns[node->spawnIndex].y = node->position.y;
+            owner->spawnsChanged = true;
+        }
+    });
+
+    result.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void ChunkManager::renderChunks(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, const Frustum* frustum) {
+    if (!bgfx::isValid(lodIndexBuffers[0][0])) {
+        createLodIndexBuffers();
+    }
+
+    // Blend the biome layers per vertex when the terrain shader and texture arrays are available,
+    // otherwise draw each chunk with the texture of its dominant biome
+    const bool blendBiomes = bgfx::isValid(biomeBlendProgram) && bgfx::isValid(biomeArraySampler) &&
+                             bgfx::isValid(getBiomeTextureArray());
+    const bgfx::ProgramHandle terrainProgram = blendBiomes ? biomeBlendProgram : program;
+
+    // Test every loaded chunk against the frustum in one batch
+    chunkBounds.clear();
+    for (const TerrainChunk* chunk : loadedChunks) {
+        bx::Vec3 boundsMin(bx::InitNone), boundsMax(bx::InitNone);
+        chunk->getBounds(boundsMin, boundsMax);
+        chunkBounds.add(boundsMin.x, boundsMin.y, boundsMin.z, boundsMax.x, boundsMax.y, boundsMax.z);
+    }
+    if (frustum) {
+        chunkBounds.cull(*frustum, chunkVisibility);
+    } else {
+        chunkVisibility.assign(chunkBounds.size(), 1);
+    }
+    size_t chunkIndex = 0;
+    for (TerrainChunk* chunk : loadedChunks) {
+        chunk->inFrustum = chunkVisibility[chunkIndex++] != 0;
+    }
+    chunkCullStats = CullStats();
+
+    trianglesSubmitted = 0;
+    int renderedChunks = 0;
+    int skippedChunks = 0;
+    static int debugFrameCount = 0;
+    bool shouldDebug = (debugFrameCount % 300 == 0); // Debug every 5 seconds at 60fps
+
+    if (shouldDebug) {
+        std::cout << "\n=== CHUNK RENDER DEBUG ===" << std::endl;
+        std::cout << "Total loaded chunks: " << loadedChunks.size() << std::endl;
+    }
+
+    for (TerrainChunk* chunk : loadedChunks) {
+        // Debug chunk info
+        if (shouldDebug) {
+            float worldX = chunk->chunkX * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+            float worldZ = chunk->chunkZ * TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+            std::cout << "Chunk (" << chunk->chunkX << ", " << chunk->chunkZ << ") -> World pos ("
+                      << worldX << ", " << worldZ << ") - " << chunk->getBiomeName();
+        }
+
+        // Skip chunks with invalid buffers
+        if (!chunk->isReady()) {
+            if (shouldDebug) {
+                std::cout << " - SKIPPED (invalid vertex buffer)" << std::endl;
+            }
+            skippedChunks++;
+            continue;
+        }
+
+        if (!chunk->inFrustum) {
+            if (shouldDebug) {
+                std::cout << " - CULLED" << std::endl;
+            }
+            chunkCullStats.culled++;
+            continue;
+        }
+        chunkCullStats.submitted++;
+
+        if (adaptiveMeshing) {
+            // Rebuild the adaptive mesh only when its error bound changed
+            float maxError = getAdaptiveErrorForChunk(chunk->chunkX, chunk->chunkZ);
+            if (chunk->adaptiveMaxError != maxError) {
+                chunk->updateAdaptiveBuffer(maxError);
+            }
+
+            if (shouldDebug) {
+                std::cout << " - RENDERED (adaptive, " << chunk->adaptiveTriangleCount << " tris)" << std::endl;
+            }
+
+            float chunkMatrix[16];
+            bx::mtxTranslate(chunkMatrix, 0.0f, -5.0f, 0.0f); // Same terrain offset as before
+
+            uint64_t terrainState = BGFX_STATE_DEFAULT;
+            terrainState &= ~BGFX_STATE_CULL_MASK;
+            bgfx::setState(terrainState);
+
+            bgfx::setTransform(chunkMatrix);
+            if (blendBiomes) {
+                bgfx::setTexture(0, biomeArraySampler, biomeTextureArray);
+            } else {
+                bgfx::setTexture(0, texUniform, getBiomeTexture(chunk->biome));
+            }
+            bgfx::setVertexBuffer(0, chunk->vbh);
+            bgfx::setIndexBuffer(chunk->adaptiveIbh, 0, chunk->adaptiveTriangleCount * 3);
+            bgfx::submit(0, terrainProgram);
+            trianglesSubmitted += chunk->adaptiveTriangleCount;
+            renderedChunks++;
+            continue;
+        }
+
+        // Pick the LOD and stitch any edge that borders a coarser neighbour
+        int lod = getChunkLod(chunk->chunkX, chunk->chunkZ);
+        uint8_t stitchMask = 0;
+        if (getChunkLod(chunk->chunkX, chunk->chunkZ - 1) > lod) stitchMask |= TerrainChunk::STITCH_NORTH;
+        if (getChunkLod(chunk->chunkX + 1, chunk->chunkZ) > lod) stitchMask |= TerrainChunk::STITCH_EAST;
+        if (getChunkLod(chunk->chunkX, chunk->chunkZ + 1) > lod) stitchMask |= TerrainChunk::STITCH_SOUTH;
+        if (getChunkLod(chunk->chunkX - 1, chunk->chunkZ) > lod) stitchMask |= TerrainChunk::STITCH_WEST;
+
+        if (shouldDebug) {
+            std::cout << " - RENDERED (LOD " << lod << ", stitch " << (int)stitchMask << ")" << std::endl;
+        }
+
+        // Create transform matrix for chunk
+        float chunkMatrix[16], translation[16];
+        bx::mtxTranslate(translation, 0.0f, -5.0f, 0.0f); // Same terrain offset as before
+        bx::mtxIdentity(chunkMatrix);
+        bx::mtxMul(chunkMatrix, chunkMatrix, translation);
+
+        // Set terrain rendering state
+        uint64_t terrainState = BGFX_STATE_DEFAULT;
+        terrainState &= ~BGFX_STATE_CULL_MASK;
+        bgfx::setState(terrainState);
+
+        // Render this chunk with the shared biome layers (or its biome's own texture)
+        bgfx::setTransform(chunkMatrix);
+        if (blendBiomes) {
+            bgfx::setTexture(0, biomeArraySampler, biomeTextureArray);
+        } else {
+            bgfx::setTexture(0, texUniform, getBiomeTexture(chunk->biome));
+        }
+        bgfx::setVertexBuffer(0, chunk->vbh);
+        bgfx::setIndexBuffer(lodIndexBuffers[lod][stitchMask]);
+        bgfx::submit(0, terrainProgram);
+        trianglesSubmitted += lodTriangleCounts[lod][stitchMask];
+        renderedChunks++;
+    }
+
+    if (shouldDebug) {
+        MemoryStats memory = getMemoryStats();
+        std::cout << "Rendered: " << renderedChunks << ", Skipped: " << skippedChunks
+                  << ", Culled: " << chunkCullStats.culled << ", Triangles: " << trianglesSubmitted << std::endl;
+        if (memory.chunkCount > 0) {
+            std::cout << "Terrain memory: CPU " << memory.cpuBytes / 1024 << " KB ("
+                      << memory.cpuBytes / memory.chunkCount / 1024 << " KB/chunk), GPU "
+                      << memory.gpuBytes / 1024 << " KB" << std::endl;
+        }
+        if (loadStats.generatedChunks > 0 || loadStats.cachedChunks > 0) {
+            ChunkCache::Stats cacheStats = chunkCache.getStats();
+            std::cout << "Chunk loads: " << loadStats.generatedChunks << " generated ("
+                      << (loadStats.generatedChunks ? loadStats.generateMilliseconds / loadStats.generatedChunks : 0.0)
+                      << " ms avg), " << loadStats.cachedChunks << " cached ("
+                      << (loadStats.cachedChunks ? loadStats.cacheMilliseconds / loadStats.cachedChunks : 0.0)
+                      << " ms avg), cache writes " << cacheStats.writes << ", rejected " << cacheStats.rejected << std::endl;
+        }
+        std::cout << "=========================" << std::endl;
+    }
+
+    debugFrameCount++;
+}
+
+void ChunkManager::renderWater(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, bgfx::TextureHandle waterTexture) {
+    // Visible water chunks in row order (the chunk bounds contain its water plane)
+    waterChunks.clear();
+    for (const TerrainChunk* chunk : loadedChunks) {
+        if (chunk->hasWater && chunk->inFrustum) {
+            waterChunks.emplace_back(chunk->chunkZ, chunk->chunkX);
+        }
+    }
+    std::sort(waterChunks.begin(), waterChunks.end());
+
+    // One quad per run of neighbouring chunks along x
+    waterQuadCount = 0;
+    for (size_t i = 0; i < waterChunks.size(); i++) {
+        if (i == 0 || waterChunks[i].first != waterChunks[i - 1].first || waterChunks[i].second != waterChunks[i - 1].second + 1) {
+            waterQuadCount++;
+        }
+    }
+    if (waterQuadCount == 0) return;
+
+    const uint32_t vertexCount = waterQuadCount * 4;
+    const uint32_t indexCount = waterQuadCount * 6;
+    const bgfx::VertexLayout& terrainLayout = getTerrainLayout();
+    if (!bgfx::getAvailTransientVertexBuffer(vertexCount, terrainLayout) || !bgfx::getAvailTransientIndexBuffer(indexCount)) {
+        return;
+    }
+    bgfx::TransientVertexBuffer tvb;
+    bgfx::TransientIndexBuffer tib;
+    bgfx::allocTransientVertexBuffer(&tvb, vertexCount, terrainLayout);
+    bgfx::allocTransientIndexBuffer(&tib, indexCount);
+    TerrainVertex* vertices = (TerrainVertex*)tvb.data;
+    uint16_t* indices = (uint16_t*)tib.data;
+
+    // Texture coordinates come from world position (one repeat per chunk, as before),
+    // so merged quads tile the texture the same way separate chunks did
+    const float chunkWorldSize = TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+    const float waterY = SEA_LEVEL - 5.0f; // Match the terrain offset
+    auto corner = [&](int chunkX, int chunkZ) {
+        TerrainVertex vertex;
+        vertex.x = chunkX * chunkWorldSize;
+        vertex.y = waterY;
+        vertex.z = chunkZ * chunkWorldSize;
+        vertex.u = (float)chunkX;
+        vertex.v = (float)chunkZ;
+        vertex.biomeWeights = 0;
+        return vertex;
+    };
+
+    uint16_t quad = 0;
+    size_t runStart = 0;
+    for (size_t i = 0; i < waterChunks.size(); i++) {
+        bool runEnds = i + 1 == waterChunks.size() || waterChunks[i + 1].first != waterChunks[i].first ||
+                       waterChunks[i + 1].second != waterChunks[i].second + 1;
+        if (!runEnds) continue;
+
+        int chunkZ = waterChunks[i].first;
+        int firstX = waterChunks[runStart].second;
+        int lastX = waterChunks[i].second;
+        TerrainVertex* v = vertices + quad * 4;
+        v[0] = corner(firstX, chunkZ);
+        v[1] = corner(lastX + 1, chunkZ);
+        v[2] = corner(firstX, chunkZ + 1);
+        v[3] = corner(lastX + 1, chunkZ + 1);
+
+        uint16_t base = quad * 4;
+        uint16_t* index = indices + quad * 6;
+        index[0] = base;
+        index[1] = base + 2;
+        index[2] = base + 1;
+        index[3] = base + 1;
+        index[4] = base + 2;
+        index[5] = base + 3;
+
+        quad++;
+        runStart = i + 1;
+    }
+
+    // Set water state before rendering
+    uint64_t waterState = BGFX_STATE_DEFAULT;
+    waterState |= BGFX_STATE_BLEND_ALPHA;
+    waterState &= ~BGFX_STATE_CULL_MASK;
+    bgfx::setState(waterState);
+
+    // Render water surface with transparency (positions are already in world space)
+    float waterMatrix[16];
+    bx::mtxIdentity(waterMatrix);
+    bgfx::setTransform(waterMatrix);
+    if (bgfx::isValid(waterTexture) && bgfx::isValid(texUniform)) {
+        bgfx::setTexture(0, texUniform, waterTexture);
+    }
+    bgfx::setVertexBuffer(0, &tvb);
+    bgfx::setIndexBuffer(&tib);
+    bgfx::submit(0, program);
+}
+
+ChunkManager::MemoryStats ChunkManager::getMemoryStats() const {
+    MemoryStats stats;
+    for (const TerrainChunk* chunk : loadedChunks) {
+        stats.chunkCount++;
+        stats.cpuBytes += chunk->getCpuMemoryBytes();
+        stats.gpuBytes += chunk->getGpuMemoryBytes();
+    }
+    for (const auto& chunk : warmChunks) {
+        stats.warmChunkCount++;
+        stats.warmCpuBytes += chunk->getCpuMemoryBytes();
+        stats.warmGpuBytes += chunk->getGpuMemoryBytes();
+    }
+    ChunkPool::Stats pool = chunkPool.getStats();
+    stats.pooledChunkCount = pool.pooledChunks;
+    stats.pooledCpuBytes = pool.pooledCpuBytes;
+    stats.pooledGpuBytes = pool.pooledGpuBytes;
+    return stats;
+}
+
+void ChunkManager::setResidencyBudget(size_t cpuBytes, size_t gpuBytes) {
+    cpuBudgetBytes = cpuBytes;
+    gpuBudgetBytes = gpuBytes;
+    trimWarmChunks();
+}
+
+ChunkManager::ResidencyStats ChunkManager::getResidencyStats() const {
+    ResidencyStats stats;
+    stats.warmChunks = warmChunks.size();
+    stats.warmHits = warmHits;
+    stats.warmEvictions = warmEvictions;
+    stats.pool = chunkPool.getStats();
+    stats.buffers = TerrainChunk::getBufferStats();
+    return stats;
+}
+
+std::vector<std::string> ChunkManager::getLoadedChunkInfo() const {
+    std::vector<std::string> info;
+    for (const TerrainChunk* chunk : loadedChunks) {
+        info.push_back(std::to_string(chunk->chunkX) + "," + std::to_string(chunk->chunkZ) +
+                      " (" + chunk->getBiomeName() + ")");
+    }
+    return info;
+}
+
+// Everything isInLoadRange keeps (player square, prefetch square offset by up to
+// PREFETCH_MAX_CHUNKS + 1 after rounding) has to fit in the chunk grid window
+static_assert(2 * (ChunkManager::RENDER_DISTANCE + 1) + 1 + ChunkManager::PREFETCH_MAX_CHUNKS + 1 <= ChunkGrid::WINDOW_SIZE,
+              "Chunk load range exceeds the ChunkGrid window");
+
+bool ChunkManager::isInLoadRange(int chunkX, int chunkZ) const {
+    // Render distance around the player or the prefetch centre, plus a 1-chunk hysteresis
+    return (bx::abs(chunkX - playerChunkX) <= RENDER_DISTANCE + 1 && bx::abs(chunkZ - playerChunkZ) <= RENDER_DISTANCE + 1) ||
+           (bx::abs(chunkX - prefetchChunkX) <= RENDER_DISTANCE + 1 && bx::abs(chunkZ - prefetchChunkZ) <= RENDER_DISTANCE + 1);
+}
+
+float ChunkManager::getStreamPriority(int chunkX, int chunkZ) const {
+    // Distance from the player to the chunk centre, in chunks
+    const float chunkWorldSize = TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+    float dx = (chunkX + 0.5f) - playerPosX / chunkWorldSize;
+    float dz = (chunkZ + 0.5f) - playerPosZ / chunkWorldSize;
+    float distance = bx::sqrt(dx * dx + dz * dz);
+
+    // The ring under the player always comes first
+    const float nearDistance = 1.5f;
+    float speed = bx::sqrt(playerVelocityX * playerVelocityX + playerVelocityZ * playerVelocityZ);
+    if (distance <= nearDistance || speed <= 0.0f) {
+        return distance;
+    }
+
+    // Beyond it, chunks in the direction of travel are pulled forward
+    float alignment = bx::max(0.0f, (dx * playerVelocityX + dz * playerVelocityZ) / (distance * speed));
+    return nearDistance + (distance - nearDistance) * (1.0f - HEADING_PRIORITY_WEIGHT * alignment);
+}
+
+void ChunkManager::refreshStreamRequests() {
+    // Everything already loaded, building or waiting for upload is skipped
+    std::unordered_set<uint64_t> awaitingUpload;
+    for (const auto& queuedChunk : uploadQueue) {
+        awaitingUpload.insert(getChunkKey(queuedChunk->chunkX, queuedChunk->chunkZ));
+    }
+
+    // Wanted: the render square around the player and the one around the prefetch centre
+    requestQueue.clear();
+    int minX = bx::min(playerChunkX, prefetchChunkX) - RENDER_DISTANCE;
+    int maxX = bx::max(playerChunkX, prefetchChunkX) + RENDER_DISTANCE;
+    int minZ = bx::min(playerChunkZ, prefetchChunkZ) - RENDER_DISTANCE;
+    int maxZ = bx::max(playerChunkZ, prefetchChunkZ) + RENDER_DISTANCE;
+    for (int z = minZ; z <= maxZ; z++) {
+        for (int x = minX; x <= maxX; x++) {
+            bool aroundPlayer = bx::abs(x - playerChunkX) <= RENDER_DISTANCE && bx::abs(z - playerChunkZ) <= RENDER_DISTANCE;
+            bool aroundPrefetch = bx::abs(x - prefetchChunkX) <= RENDER_DISTANCE && bx::abs(z - prefetchChunkZ) <= RENDER_DISTANCE;
+            if (!aroundPlayer && !aroundPrefetch) continue;
+
+            uint64_t key = getChunkKey(x, z);
+            if (loadedChunks.contains(x, z) || pendingChunks.count(key) || awaitingUpload.count(key)) {
+                continue;
+            }
+            if (restoreWarmChunk(x, z)) {
+                continue;
+            }
+            requestQueue.push_back({x, z, getStreamPriority(x, z)});
+        }
+    }
+
+    // Most urgent last so dispatch can pop from the back
+    std::sort(requestQueue.begin(), requestQueue.end(), [](const StreamRequest& a, const StreamRequest& b) {
+        return a.priority > b.priority;
+    });
+
+    std::cout << "Requested " << requestQueue.size() << " chunks around player chunk (" << playerChunkX << ", " << playerChunkZ
+              << "), prefetching around (" << prefetchChunkX << ", " << prefetchChunkZ << "). Loaded: " << loadedChunks.size()
+              << ", pending: " << getPendingChunkCount() << std::endl;
+}
+
+void ChunkManager::cancelStaleRequests() {
+    // Queued requests are just dropped; refreshStreamRequests rebuilds the rest
+    size_t queuedBefore = requestQueue.size();
+    requestQueue.erase(std::remove_if(requestQueue.begin(), requestQueue.end(),
+                                      [this](const StreamRequest& request) { return !isInLoadRange(request.chunkX, request.chunkZ); }),
+                       requestQueue.end());
+    cancelledRequests += (int)(queuedBefore - requestQueue.size());
+
+    // Jobs already handed to the workers are flagged: one that hasn't started returns
+    // immediately, one that is running finishes and its chunk goes back to the pool
+    for (auto it = pendingChunks.begin(); it != pendingChunks.end();) {
+        if (!isInLoadRange(it->second.chunkX, it->second.chunkZ)) {
+            it->second.cancelled->store(true);
+            cancelledRequests++;
+            cancelledJobs.push_back(std::move(it->second.result));
+            it = pendingChunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ChunkManager::dispatchStreamRequests() {
+    // Keep only a couple of jobs per worker in the pool, so later re-prioritization and
+    // cancellation still apply to most of the queue
+    const size_t maxInFlight = std::max<size_t>(2, workerPool.getThreadCount() * 2);
+    ChunkCache* cache = &chunkCache;
+    ChunkPool* pool = &chunkPool;
+
+    while (!requestQueue.empty() && pendingChunks.size() < maxInFlight) {
+        StreamRequest request = requestQueue.back();
+        requestQueue.pop_back();
+
+        int x = request.chunkX;
+        int z = request.chunkZ;
+        PendingChunk pending;
+        pending.chunkX = x;
+        pending.chunkZ = z;
+        pending.cancelled = std::make_shared<std::atomic<bool>>(false);
+        std::shared_ptr<std::atomic<bool>> cancelled = pending.cancelled;
+        pending.result = workerPool.submit([x, z, cache, cancelled, pool]() { return buildChunk(x, z, cache, cancelled.get(), pool); });
+        pendingChunks.emplace(getChunkKey(x, z), std::move(pending));
+    }
+}
+
+ChunkManager::StreamingStats ChunkManager::getStreamingStats() const {
+    StreamingStats stats;
+    stats.queued = (int)requestQueue.size();
+    stats.inFlight = (int)pendingChunks.size();
+    stats.awaitingUpload = (int)uploadQueue.size();
+    stats.cancelled = cancelledRequests;
+    stats.lastFrameMilliseconds = lastStreamingMilliseconds;
+    return stats;
+}
+
+void ChunkManager::unloadDistantChunks() {
+    // Unload if outside render distance + buffer (collected first, the grid can't change mid-iteration)
+    std::vector<TerrainChunk*> distantChunks;
+    for (TerrainChunk* chunk : loadedChunks) {
+        if (!isInLoadRange(chunk->chunkX, chunk->chunkZ)) {
+            distantChunks.push_back(chunk);
+        }
+    }
+    if (distantChunks.empty()) return;
+
+    // Their entities go with them: state into the spawn lists, the record to the cache,
+    // then out of the world vectors
+    syncChunkEntities(distantChunks);
+    removeChunkEntities(distantChunks);
+    // Saved like before, but kept warm so turning back doesn't rebuild them
+    for (TerrainChunk* chunk : distantChunks) {
+        std::cout << "Unloading chunk (" << chunk->chunkX << ", " << chunk->chunkZ << ")" << std::endl;
+        saveChunk(*chunk);
+        pathFinder.removeChunk(chunk->chunkX, chunk->chunkZ);
+        uint64_t key = getChunkKey(chunk->chunkX, chunk->chunkZ);
+        warmChunks.push_front(loadedChunks.remove(chunk->chunkX, chunk->chunkZ));
+        warmChunkIndex[key] = warmChunks.begin();
+    }
+    trimWarmChunks();
+
+    // Generated chunks that went out of range before their upload are recycled
+    for (auto queued = uploadQueue.begin(); queued != uploadQueue.end();) {
+        if (!isInLoadRange((*queued)->chunkX, (*queued)->chunkZ)) {
+            chunkPool.release(std::move(*queued));
+            queued = uploadQueue.erase(queued);
+        } else {
+            ++queued;
+        }
+    }
+}
+
+void ChunkManager::collectFinishedChunks() {
+    for (auto it = pendingChunks.begin(); it != pendingChunks.end();) {
+        PendingChunk& pending = it->second;
+        if (pending.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        std::unique_ptr<TerrainChunk> chunk = pending.result.get();
+        if (chunk) {
+            if (chunk->loadedFromCache) {
+                loadStats.cachedChunks++;
+                loadStats.cacheMilliseconds += chunk->buildMilliseconds;
+            } else {
+                loadStats.generatedChunks++;
+                loadStats.generateMilliseconds += chunk->buildMilliseconds;
+            }
+        }
+        if (chunk && isInLoadRange(chunk->chunkX, chunk->chunkZ)) {
+            uploadQueue.push_back(std::move(chunk));
+        } else {
+            chunkPool.release(std::move(chunk));
+        }
+        it = pendingChunks.erase(it);
+    }
+
+    // Cancelled jobs that ran anyway
+    for (auto job = cancelledJobs.begin(); job != cancelledJobs.end();) {
+        if (job->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            chunkPool.release(job->get());
+            job = cancelledJobs.erase(job);
+        } else {
+            ++job;
+        }
+    }
+}
+
+void ChunkManager::processUploadQueue(float budgetMilliseconds) {
+    // Always upload at least one chunk so streaming progresses on slow frames
+    auto start = std::chrono::steady_clock::now();
+    while (!uploadQueue.empty()) {
+        auto best = uploadQueue.begin();
+        float bestPriority = getStreamPriority((*best)->chunkX, (*best)->chunkZ);
+        for (auto it = std::next(uploadQueue.begin()); it != uploadQueue.end(); ++it) {
+            float priority = getStreamPriority((*it)->chunkX, (*it)->chunkZ);
+            if (priority < bestPriority) {
+                best = it;
+                bestPriority = priority;
+            }
+        }
+
+        std::unique_ptr<TerrainChunk> chunk = std::move(*best);
+        uploadQueue.erase(best);
+        uploadChunk(std::move(chunk));
+
+        float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= budgetMilliseconds) break;
+    }
+}
+
+void ChunkManager::uploadChunk(std::unique_ptr<TerrainChunk> chunk) {
+    chunk->createBuffers();
+    chunkPool.releaseVertices(chunk->vertices);
+    TerrainChunk& stored = *chunk;
+    storeLoadedChunk(std::move(chunk));
+    instantiateChunkEntities(stored);
+}
+
+bool ChunkManager::restoreWarmChunk(int chunkX, int chunkZ) {
+    auto found = warmChunkIndex.find(getChunkKey(chunkX, chunkZ));
+    if (found == warmChunkIndex.end()) return false;
+
+    // Buffers and spawn state are as they were at unload; only the entities need recreating
+    std::unique_ptr<TerrainChunk> chunk = std::move(*found->second);
+    warmChunks.erase(found->second);
+    warmChunkIndex.erase(found);
+    warmHits++;
+
+    std::cout << "Restoring warm chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
+    TerrainChunk& stored = *chunk;
+    storeLoadedChunk(std::move(chunk));
+    instantiateChunkEntities(stored);
+    return true;
+}
+
+void ChunkManager::trimWarmChunks() {
+    MemoryStats memory = getMemoryStats();
+    size_t cpuBytes = memory.cpuBytes + memory.warmCpuBytes + memory.pooledCpuBytes;
+    size_t gpuBytes = memory.gpuBytes + memory.warmGpuBytes + memory.pooledGpuBytes;
+    if (cpuBytes <= cpuBudgetBytes && gpuBytes <= gpuBudgetBytes) return;
+
+    // Pooled chunks only save allocations, so they go before any warm chunk
+    chunkPool.trim(cpuBytes > cpuBudgetBytes ? cpuBytes - cpuBudgetBytes : 0,
+                   gpuBytes > gpuBudgetBytes ? gpuBytes - gpuBudgetBytes : 0);
+    ChunkPool::Stats pool = chunkPool.getStats();
+    cpuBytes -= memory.pooledCpuBytes - pool.pooledCpuBytes;
+    gpuBytes -= memory.pooledGpuBytes - pool.pooledGpuBytes;
+
+    // Then least recently unloaded first. Pooling them would keep their bytes resident, so
+    // they are freed outright.
+    while (!warmChunks.empty() && (cpuBytes > cpuBudgetBytes || gpuBytes > gpuBudgetBytes)) {
+        std::unique_ptr<TerrainChunk> chunk = std::move(warmChunks.back());
+        warmChunks.pop_back();
+        warmChunkIndex.erase(getChunkKey(chunk->chunkX, chunk->chunkZ));
+        cpuBytes -= chunk->getCpuMemoryBytes();
+        gpuBytes -= chunk->getGpuMemoryBytes();
+        warmEvictions++;
+    }
+}
+
+void ChunkManager::instantiateChunkEntities(const TerrainChunk& stored) {
+    // Instantiate the spawns the worker decided on (or restored from the cache). They stay
+    // in the world vectors until the chunk unloads.
+    if (worldResourceNodes) {
+        for (size_t i = 0; i < stored.resourceSpawns.size(); i++) {
+            const ResourceSpawn& spawn = stored.resourceSpawns[i];
+            worldResourceNodes->emplace_back(spawn.x, spawn.y, spawn.z, spawn.type, 100);
+            ResourceNode& node = worldResourceNodes->back();
+            node.health = spawn.health;
+            node.isActive = spawn.isActive;
+            node.chunkX = stored.chunkX;
+            node.chunkZ = stored.chunkZ;
+            node.spawnIndex = (int)i;
+        }
+        if (!stored.resourceSpawns.empty()) {
+            std::cout << "Generated " << stored.resourceSpawns.size() << " resource nodes in "
+                      << stored.getBiomeName() << " chunk (" << stored.chunkX << ", " << stored.chunkZ << ")" << std::endl;
+            rebuildResourceGrid();
+        }
+    }
+    if (worldNPCs) {
+        for (size_t i = 0; i < stored.npcSpawns.size(); i++) {
+            const NPCSpawn& spawn = stored.npcSpawns[i];
+            auto npc = std::make_unique<NPC>(spawn.x, spawn.y, spawn.z, spawn.type);
+            if (spawn.health >= 0) {
+                npc->health = spawn.health;
+                npc->isActive = spawn.isActive;
+                npc->updateHealthColor();
+            }
+            npc->chunkX = stored.chunkX;
+            npc->chunkZ = stored.chunkZ;
+            npc->spawnIndex = (int)i;
+            npcGrid.insert(npc.get(), npc->position.x, npc->position.z);
+            worldNPCs->push_back(std::move(npc));
+        }
+        if (!stored.npcSpawns.empty()) {
+            std::cout << "Generated " << stored.npcSpawns.size() << " NPCs in "
+                      << stored.getBiomeName() << " chunk (" << stored.chunkX << ", " << stored.chunkZ << ")" << std::endl;
+        }
+    }
+}
+
+void ChunkManager::storeLoadedChunk(std::unique_ptr<TerrainChunk> chunk) {
+    pathFinder.addChunk(chunk->chunkX, chunk->chunkZ, chunk->walkCosts);
+    std::unique_ptr<TerrainChunk> displaced = loadedChunks.insert(std::move(chunk));
+
+    // Only possible if the load range outgrew the grid window; keep its state rather than lose it
+    if (displaced) {
+        std::cerr << "Chunk grid slot collision, unloading chunk (" << displaced->chunkX << ", " << displaced->chunkZ << ")" << std::endl;
+        std::vector<TerrainChunk*> displacedChunks = {displaced.get()};
+        syncChunkEntities(displacedChunks);
+        saveChunk(*displaced);
+        removeChunkEntities(displacedChunks);
+        pathFinder.removeChunk(displaced->chunkX, displaced->chunkZ);
+        chunkPool.release(std::move(displaced));
+    }
+}
+
+void ChunkManager::syncChunkEntities(const std::vector<TerrainChunk*>& chunks) {
+    std::unordered_map<uint64_t, TerrainChunk*> owners;
+    for (TerrainChunk* chunk : chunks) {
+        owners[getChunkKey(chunk->chunkX, chunk->chunkZ)] = chunk;
+    }
+
+    if (worldResourceNodes) {
+        for (const ResourceNode& node : *worldResourceNodes) {
+            if (node.spawnIndex < 0) continue;
+            auto owner = owners.find(getChunkKey(node.chunkX, node.chunkZ));
+            if (owner == owners.end() || node.spawnIndex >= (int)owner->second->resourceSpawns.size()) continue;
+
+            ResourceSpawn& spawn = owner->second->resourceSpawns[node.spawnIndex];
+            if (spawn.health != node.health || spawn.isActive != node.isActive) {
+                spawn.health = node.health;
+                spawn.isActive = node.isActive;
+                owner->second->spawnsChanged = true;
+            }
+        }
+    }
+
+    if (worldNPCs) {
+        for (const auto& npc : *worldNPCs) {
+            if (!npc || npc->spawnIndex < 0) continue;
+            auto owner = owners.find(getChunkKey(npc->chunkX, npc->chunkZ));
+            if (owner == owners.end() || npc->spawnIndex >= (int)owner->second->npcSpawns.size()) continue;
+
+            // NPCs come back where they were left; tiny wander steps don't warrant a rewrite
+            NPCSpawn& spawn = owner->second->npcSpawns[npc->spawnIndex];
+            float dx = npc->position.x - spawn.x;
+            float dz = npc->position.z - spawn.z;
+            if (dx * dx + dz * dz > 0.25f || spawn.health != npc->health || spawn.isActive != npc->isActive) {
+                spawn.x = npc->position.x;
+                spawn.y = npc->position.y;
+                spawn.z = npc->position.z;
+                spawn.health = npc->health;
+                spawn.isActive = npc->isActive;
+                owner->second->spawnsChanged = true;
+            }
+        }
+    }
+}
+
+void ChunkManager::removeChunkEntities(const std::vector<TerrainChunk*>& chunks) {
+    std::unordered_set<uint64_t> keys;
+    for (const TerrainChunk* chunk : chunks) {
+        keys.insert(getChunkKey(chunk->chunkX, chunk->chunkZ));
+    }
+    auto isOwned = [&keys](int spawnIndex, int chunkX, int chunkZ) {
+        return spawnIndex >= 0 && keys.count(getChunkKey(chunkX, chunkZ)) != 0;
+    };
+
+    if (worldResourceNodes) {
+        worldResourceNodes->erase(std::remove_if(worldResourceNodes->begin(), worldResourceNodes->end(),
+                                                 [&isOwned](const ResourceNode& node) {
+                                                     return isOwned(node.spawnIndex, node.chunkX, node.chunkZ);
+                                                 }),
+                                  worldResourceNodes->end());
+        rebuildResourceGrid();
+    }
+
+    if (worldNPCs) {
+        // Nothing may keep pointing at an NPC that is about to be freed
+        for (const auto& npc : *worldNPCs) {
+            if (!npc || !isOwned(npc->spawnIndex, npc->chunkX, npc->chunkZ)) continue;
+            npcGrid.remove(npc.get(), npc->position.x, npc->position.z);
+            if (player && player->combatTarget == npc.get()) {
+                player->combatTarget = nullptr;
+                player->inCombat = false;
+            }
+        }
+        worldNPCs->erase(std::remove_if(worldNPCs->begin(), worldNPCs->end(),
+                                        [&isOwned](const std::unique_ptr<NPC>& npc) {
+                                            return npc && isOwned(npc->spawnIndex, npc->chunkX, npc->chunkZ);
+                                        }),
+                         worldNPCs->end());
+    }
+}
+
+void ChunkManager::rebuildResourceGrid() {
+    // Nodes are stored by value, so any insert or erase can move them all
+    resourceGrid.clear();
+    if (!worldResourceNodes) return;
+    for (ResourceNode& node : *worldResourceNodes) {
+        resourceGrid.insert(&node, node.position.x, node.position.z);
+    }
+}
+
+void ChunkManager::saveChunk(TerrainChunk& chunk) {
+    // Unchanged cached chunks already match their record
+    if (chunk.loadedFromCache && !chunk.spawnsChanged && !chunk.heightsEdited) return;
+
+    std::vector<uint8_t> record;
+    chunk.writeCacheRecord(record);
+    if (chunkCache.write(chunk.chunkX, chunk.chunkZ, getChunkKey(chunk.chunkX, chunk.chunkZ), record)) {
+        chunk.loadedFromCache = true;
+        chunk.spawnsChanged = false;
+        chunk.heightsEdited = false;
+    }
+}
+
+// Legacy function for single biome textures (kept for compatibility)
+bgfx::TextureHandle create_biome_texture(BiomeType biome) {
+    std::cout << "Creating " << (biome == BiomeType::DESERT ? "sand" :
+                                biome == BiomeType::GRASSLAND ? "light green" :
+                                biome == BiomeType::SWAMP ? "dark green" : "brown-gray")
+              << " texture for biome..." << std::endl;
+
+    const bgfx::Memory* texMem = bgfx::alloc(BIOME_TEXTURE_SIZE * BIOME_TEXTURE_SIZE * 4);
+    generate_biome_texture_pixels(biome, texMem->data);
+
+    uint64_t textureFlags = BGFX_TEXTURE_NONE;
+    textureFlags |= BGFX_SAMPLER_MIN_ANISOTROPIC;
+    textureFlags |= BGFX_SAMPLER_MAG_ANISOTROPIC;
+
+    return bgfx::createTexture2D(BIOME_TEXTURE_SIZE, BIOME_TEXTURE_SIZE, false, 1, bgfx::TextureFormat::RGBA8, textureFlags, texMem);
+}
+
+void generate_biome_texture_pixels(BiomeType biome, uint8_t* data) {
+    const uint32_t textureWidth = BIOME_TEXTURE_SIZE;
+    const uint32_t textureHeight = BIOME_TEXTURE_SIZE;
+
+    // Base colors for each biome
+    uint8_t baseR, baseG, baseB;
+    uint8_t minR, maxR, minG, maxG, minB, maxB;
+
+    switch (biome) {
+        case BiomeType::DESERT:
+            // Sandy colors
+            baseR = 220; baseG = 185; baseB = 140;
+            minR = 160; maxR = 240; minG = 130; maxG = 210; minB = 100; maxB = 170;
+            break;
+        case BiomeType::GRASSLAND:
+            // Light green colors
+            baseR = 100; baseG = 180; baseB = 80;
+            minR = 80; maxR = 140; minG = 150; maxG = 220; minB = 60; maxB = 120;
+            break;
+        case BiomeType::SWAMP:
+            // Dark green colors
+            baseR = 60; baseG = 120; baseB = 50;
+            minR = 40; maxR = 90; minG = 90; maxG = 150; minB = 30; maxB = 80;
+            break;
+        case BiomeType::MOUNTAINS:
+            // Brown-gray colors
+            baseR = 140; baseG = 120; baseB = 100;
+            minR = 100; maxR = 180; minG = 90; maxG = 150; minB = 70; maxB = 130;
+            break;
+    }
+
+    // Create grain patterns
+    std::vector<float> grainPattern(textureWidth * textureHeight, 0.0f);
+
+    int grainCount = (biome == BiomeType::SWAMP || biome == BiomeType::GRASSLAND) ? 150 : 200;
+
+    for (int i = 0; i < grainCount; ++i) {
+        int grainX = rand() % textureWidth;
+        int grainY = rand() % textureHeight;
+        int grainSize = 3 + (rand() % 4);
+        float grainIntensity = 0.7f + (float)(rand() % 30) / 100.0f;
+
+        for (int y = -grainSize; y <= grainSize; ++y) {
+            for (int x = -grainSize; x <= grainSize; ++x) {
+                int posX = grainX + x;
+                int posY = grainY + y;
+
+                if (posX >= 0 && posX < textureWidth && posY >= 0 && posY < textureHeight) {
+                    float dist = std::sqrt(x*x + y*y);
+                    if (dist <= grainSize) {
+                        float effect = grainIntensity * (1.0f - dist/grainSize);
+                        grainPattern[posY * textureWidth + posX] += effect;
+                    }
+                }
+            }
+        }
+    }
+
+    // Generate texture pixels with biome-specific patterns
+    for (uint32_t y = 0; y < textureHeight; ++y) {
+        for (uint32_t x = 0; x < textureWidth; ++x) {
+            uint32_t offset = (y * textureWidth + x) * 4;
+
+            uint8_t r = baseR, g = baseG, b = baseB;
+            uint8_t microNoise = (uint8_t)((rand() % 20) - 10);
+
+            float grainValue = bx::clamp(grainPattern[y * textureWidth + x], 0.0f, 1.0f);
+            float darkening = 1.0f - (grainValue * 0.3f);
+
+            // Biome-specific patterns
+            float patternFactor = 1.0f;
+            switch (biome) {
+                case BiomeType::DESERT:
+                    // Horizontal sand dune patterns
+                    patternFactor = ((y / 12) % 2) == 0 ? 0.9f : 1.0f;
+                    break;
+                case BiomeType::GRASSLAND:
+                    // Subtle grass blade patterns
+                    patternFactor = ((x / 8 + y / 6) % 3) == 0 ? 0.95f : 1.0f;
+                    break;
+                case BiomeType::SWAMP:
+                    // Wet, muddy texture with darker spots
+                    patternFactor = ((x / 10 + y / 8) % 4) == 0 ? 0.8f : 1.0f;
+                    break;
+                case BiomeType::MOUNTAINS:
+                    // Rocky, uneven texture
+                    patternFactor = ((x / 6 + y / 9) % 3) == 0 ? 0.85f : 1.0f;
+                    break;
+            }
+
+            r = (uint8_t)bx::clamp((r * darkening * patternFactor) + microNoise, (float)minR, (float)maxR);
+            g = (uint8_t)bx::clamp((g * darkening * patternFactor) + microNoise, (float)minG, (float)maxG);
+            b = (uint8_t)bx::clamp((b * darkening * patternFactor) + microNoise, (float)minB, (float)maxB);
+
+            data[offset + 0] = r;
+            data[offset + 1] = g;
+            data[offset + 2] = b;
+            data[offset + 3] = 255;
+        }
+    }
+}
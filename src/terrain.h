@@ -0,0 +1,662 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <bx/math.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
+#include "resources.h"
+#include "npcs.h"
+#include "thread_pool.h"
+#include "chunk_cache.h"
+#include "frustum.h"
+#include "height_pyramid.h"
+#include "height_tile_cache.h"
+#include "pathfinding.h"
+
+// Biome system
+enum class BiomeType {
+    DESERT,      // Flat, sandy, minimal height variation
+    MOUNTAINS,   // High elevation, steep terrain
+    SWAMP,       // Low, flat, some water areas
+    GRASSLAND    // Rolling hills, moderate variation
+};
+
+static constexpr int BIOME_COUNT = 4;
+static constexpr uint32_t BIOME_TEXTURE_SIZE = 256;
+
+// Procedural texture for a single biome
+bgfx::TextureHandle create_biome_texture(BiomeType biome);
+
+// Fill BIOME_TEXTURE_SIZE^2 RGBA8 pixels for a biome (one layer of the terrain texture array)
+void generate_biome_texture_pixels(BiomeType biome, uint8_t* data);
+
+// Terrain system
+struct TerrainVertex {
+    float x, y, z;
+    float u, v;
+    uint32_t biomeWeights;  // RGBA8 blend weights, channel n = BiomeType n
+};
+
+// Global ocean/water constants
+static constexpr float SEA_LEVEL = 1.0f;  // Y coordinate for water surface
+static constexpr float OCEAN_DEPTH_SCALE = 0.3f;  // How much to flatten terrain underwater
+
+// Entity spawns decided during chunk generation, instantiated on the main thread
+struct ResourceSpawn {
+    float x, y, z;
+    ResourceType type;
+    int health = 100;       // Mining state, persisted in the chunk cache
+    bool isActive = true;
+};
+
+struct NPCSpawn {
+    float x, y, z;          // Spawn point, replaced by the last position when the chunk is saved
+    NPCType type;
+    int health = -1;        // Persisted combat state, -1 = full health for the type
+    bool isActive = true;
+};
+
+// Compact CPU copy of a chunk heightfield: uint16 samples with a per-chunk min/scale
+struct HeightTile {
+    std::vector<uint16_t> samples;
+    float minHeight = 0.0f;
+    float heightScale = 0.0f;  // World units per quantization step
+
+    void build(const std::vector<TerrainVertex>& vertices);
+    // Requantize from full-precision heights. margin widens the range on both sides so
+    // later edits of about that size still fit without another requantization.
+    void build(const std::vector<float>& heights, float margin);
+    // Store one height; false, leaving the sample alone, if it is outside the tile's range
+    bool setHeight(int index, float height);
+    float getHeight(int index) const { return minHeight + samples[index] * heightScale; }
+    float getMaxHeight() const { return minHeight + 65535.0f * heightScale; }
+    size_t getMemoryBytes() const { return samples.capacity() * sizeof(uint16_t); }
+
+private:
+    template <typename F>
+    void quantize(size_t count, F heightAt, float margin);
+};
+
+class TerrainChunk {
+public:
+    static constexpr int CHUNK_SIZE = 64;
+    static constexpr float SCALE = 0.5f;
+    static constexpr float HEIGHT_SCALE = 3.0f;
+
+    // Geomipmap LODs: level n samples every (1 << n)th vertex of the full grid
+    static constexpr int LOD_COUNT = 4;
+
+    // Edges whose neighbour is one LOD coarser; their odd vertices are welded away
+    static constexpr uint8_t STITCH_NORTH = 1;  // -Z edge (z == 0)
+    static constexpr uint8_t STITCH_EAST = 2;   // +X edge (x == CHUNK_SIZE)
+    static constexpr uint8_t STITCH_SOUTH = 4;  // +Z edge (z == CHUNK_SIZE)
+    static constexpr uint8_t STITCH_WEST = 8;   // -X edge (x == 0)
+    static constexpr int STITCH_VARIANTS = 16;
+
+    // Adaptive meshes hide cracks between chunks with skirts hanging below each edge
+    static constexpr int SKIRT_VERTEX_COUNT = 4 * (CHUNK_SIZE + 1);
+    static constexpr float SKIRT_DEPTH = 2.0f;
+
+    // Fixed buffer sizes, so a recycled chunk can overwrite its buffers in place. The index
+    // capacity is a full-detail RTIN mesh plus skirts, the most generateAdaptiveIndices returns.
+    static constexpr uint32_t VERTEX_BUFFER_COUNT = (CHUNK_SIZE + 1) * (CHUNK_SIZE + 1) + SKIRT_VERTEX_COUNT;
+    static constexpr uint32_t MAX_ADAPTIVE_INDEX_COUNT = CHUNK_SIZE * CHUNK_SIZE * 6 + 4 * CHUNK_SIZE * 6;
+
+    // Extra range given to the height tile when an edit pushes a height outside it
+    static constexpr float EDIT_HEIGHT_MARGIN = 4.0f;
+
+    // Version of the chunk cache records; bump when generation or the record layout changes
+    static constexpr uint32_t CACHE_VERSION = 2;
+
+    BiomeType biome;
+    int chunkX, chunkZ;  // Chunk coordinates in world space
+    std::vector<TerrainVertex> vertices;  // Only kept until createBuffers() uploads them
+    HeightTile heightTile;                // Used for all CPU height queries
+    HeightPyramid heightPyramid;          // Min/max bounds over heightTile for raycasts
+    std::vector<uint8_t> walkCosts;       // PathFinder cost grid derived from heightTile
+    bgfx::DynamicVertexBufferHandle vbh;  // VERTEX_BUFFER_COUNT vertices, kept across reset()
+
+    // Water is drawn by ChunkManager as one merged surface; chunks only carry the flag
+    bool hasWater;  // Any vertex below SEA_LEVEL
+
+    // Adaptive (RTIN) meshing: per-vertex error hierarchy in heightTile steps and the current index buffer
+    std::vector<uint16_t> errors;
+    bgfx::DynamicIndexBufferHandle adaptiveIbh;  // MAX_ADAPTIVE_INDEX_COUNT capacity, first adaptiveTriangleCount * 3 used
+    uint32_t adaptiveTriangleCount;
+    float adaptiveMaxError;  // Error the current adaptiveIbh was built for, < 0 if none
+
+    // Spawn lists filled by ChunkManager::generateSpawns
+    std::vector<ResourceSpawn> resourceSpawns;
+    std::vector<NPCSpawn> npcSpawns;
+
+    // Result of the last frustum test in ChunkManager::renderChunks (reused for water)
+    bool inFrustum = true;
+
+    // How the chunk was produced, for cold/warm load timing
+    bool loadedFromCache = false;
+
+    // Entity state copied into the spawn lists since the record was last written
+    bool spawnsChanged = false;
+    // Heights edited since the record was last written
+    bool heightsEdited = false;
+    float buildMilliseconds = 0.0f;
+
+    // Stage costs of the last generate(), for the world generation benchmark
+    struct GenerationTimings {
+        float heightMilliseconds = 0.0f;      // Biome heights and the vertex grid
+        float derivedMilliseconds = 0.0f;     // Height tile, height pyramid and walk costs
+        float errorMilliseconds = 0.0f;       // RTIN error hierarchy the adaptive indices come from
+        float waterMilliseconds = 0.0f;
+        float validationMilliseconds = 0.0f;
+    };
+    GenerationTimings generationTimings;
+
+    TerrainChunk(int cx, int cz, BiomeType biomeType);
+    ~TerrainChunk();
+
+    // Turn this object into a fresh chunk at another position. CPU arrays keep their
+    // capacity and the GPU buffers are kept for the next createBuffers(). Worker safe.
+    void reset(int cx, int cz, BiomeType biomeType);
+
+    // CPU-only generation, safe to run on a worker thread
+    void generate();
+
+    // Restore a chunk from a cache record instead of generate(). Rebuilds the vertex grid
+    // from the height tile; returns false if the record doesn't belong to this chunk.
+    bool loadFromCache(const std::vector<uint8_t>& record);
+
+    // Height tile, water flag and spawn state as a cache record
+    void writeCacheRecord(std::vector<uint8_t>& out) const;
+
+    // GPU upload, main thread only. Creates the vertex buffer on the first upload and
+    // updates it in place after that.
+    void createBuffers();
+
+    size_t getCpuMemoryBytes() const;
+    size_t getGpuMemoryBytes() const { return gpuMemoryBytes; }
+
+    // A chunk is ready to render once its buffers have been uploaded
+    bool isReady() const { return uploaded; }
+
+    // GPU buffer churn across all chunks, main thread only
+    struct BufferStats {
+        uint64_t created = 0;
+        uint64_t destroyed = 0;
+        uint64_t updated = 0;  // In-place uploads into existing buffers
+    };
+    static const BufferStats& getBufferStats() { return bufferStats; }
+
+    // Index list for one LOD/stitch variant over the full vertex grid.
+    // Every chunk shares the same topology, so ChunkManager builds these once.
+    static std::vector<uint16_t> generateIndices(int lod, uint8_t stitchMask);
+
+    // Error-bounded right-triangulated irregular network over the full grid, plus
+    // skirt triangles along the edges. Needs buildErrorHierarchy() first.
+    std::vector<uint16_t> generateAdaptiveIndices(float maxError) const;
+
+    // Compute the RTIN error hierarchy from the height tile (worker safe)
+    void buildErrorHierarchy();
+
+    // Refill adaptiveIbh for a new error bound, main thread only
+    void updateAdaptiveBuffer(float maxError);
+
+    // Grid vertex i along an edge (0 north, 1 east, 2 south, 3 west); skirt rows use the same order
+    static uint16_t getEdgeVertexIndex(int edge, int i);
+
+    const char* getBiomeName() const;
+    float getHeightAt(float worldX, float worldZ) const;
+
+    // Height of grid vertex (x, z), x and z in [0, CHUNK_SIZE]
+    float getVertexHeight(int x, int z) const { return heightTile.getHeight(z * (CHUNK_SIZE + 1) + x); }
+
+    // Terrain edit, main thread only. heights holds the new heights of grid vertices
+    // [x0, x1] x [z0, z1], row-major. The height pyramid, walk costs, error hierarchy and
+    // water flag follow, and an uploaded chunk rewrites just the edited vertex rows (and
+    // the skirts along them) and its adaptive indices. The caller re-registers walkCosts.
+    void setHeights(int x0, int z0, int x1, int z1, const float* heights);
+
+    // World-space bounds as rendered: terrain is drawn 5 units down and skirts hang below
+    void getBounds(bx::Vec3& boundsMin, bx::Vec3& boundsMax) const;
+
+    // Nearest hit of a world-space ray with t in [tMin, tMax], against the full-resolution
+    // height grid 5 units down rather than the LOD/RTIN mesh that is drawn
+    bool raycast(const bx::Vec3& origin, const bx::Vec3& direction, float tMin, float tMax, float& tHit) const;
+
+private:
+    size_t gpuMemoryBytes = 0;
+    bool uploaded = false;  // vbh holds this chunk's vertices
+
+    static BufferStats bufferStats;
+
+    void generateBiomeTerrain();
+    void buildVerticesFromTile();
+    void uploadVertexRows(int z0, int z1);
+    void checkForWater();
+    void validateChunkGeometry();
+};
+
+// Loaded chunks in a fixed WINDOW_SIZE x WINDOW_SIZE array, indexed by chunk coordinates
+// modulo the window (toroidal), so lookups need no hashing. The streaming range is smaller
+// than the window, so loaded chunks never share a slot; lookups still check coordinates.
+// Iteration runs row by row from the window origin, i.e. in spatial order.
+class ChunkGrid {
+public:
+    static constexpr int WINDOW_SIZE = 32;  // Slots per side, must be a power of two
+    static constexpr int SLOT_COUNT = WINDOW_SIZE * WINDOW_SIZE;
+
+    ChunkGrid() : slots(SLOT_COUNT) {}
+
+    // Coherent queries (player, NPCs, ray walks) mostly repeat the last chunk found
+    TerrainChunk* find(int chunkX, int chunkZ) const {
+        if (lastHit && lastHit->chunkX == chunkX && lastHit->chunkZ == chunkZ) {
+            return lastHit;
+        }
+        TerrainChunk* chunk = slots[getSlot(chunkX, chunkZ)].get();
+        if (!chunk || chunk->chunkX != chunkX || chunk->chunkZ != chunkZ) {
+            return nullptr;
+        }
+        lastHit = chunk;
+        return chunk;
+    }
+    bool contains(int chunkX, int chunkZ) const { return find(chunkX, chunkZ) != nullptr; }
+
+    // Store a chunk in its slot; returns whatever occupied the slot before (normally nothing)
+    std::unique_ptr<TerrainChunk> insert(std::unique_ptr<TerrainChunk> chunk);
+    std::unique_ptr<TerrainChunk> remove(int chunkX, int chunkZ);
+    void clear();
+    size_t size() const { return count; }
+
+    // First chunk of the iteration order; ChunkManager keeps the player in the middle
+    void setOrigin(int chunkX, int chunkZ) { originX = chunkX; originZ = chunkZ; }
+
+    class Iterator {
+    public:
+        Iterator(const ChunkGrid* grid, int index) : grid(grid), index(index) { skipEmpty(); }
+        TerrainChunk* operator*() const { return grid->slots[grid->getWindowSlot(index)].get(); }
+        Iterator& operator++() { index++; skipEmpty(); return *this; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+
+    private:
+        void skipEmpty() {
+            while (index < SLOT_COUNT && !grid->slots[grid->getWindowSlot(index)]) index++;
+        }
+        const ChunkGrid* grid;
+        int index;
+    };
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, SLOT_COUNT); }
+
+private:
+    static int getSlot(int chunkX, int chunkZ) {
+        return (chunkZ & (WINDOW_SIZE - 1)) * WINDOW_SIZE + (chunkX & (WINDOW_SIZE - 1));
+    }
+    int getWindowSlot(int index) const {
+        return getSlot(originX + index % WINDOW_SIZE, originZ + index / WINDOW_SIZE);
+    }
+
+    std::vector<std::unique_ptr<TerrainChunk>> slots;
+    size_t count = 0;
+    int originX = 0, originZ = 0;
+    mutable TerrainChunk* lastHit = nullptr;
+};
+
+// Chunk objects and vertex arrays kept for reuse, so streaming doesn't allocate per chunk.
+// Pooled chunks keep their GPU buffers, which the next upload overwrites. Workers take
+// from the pool; chunks only go back on the main thread, because one that doesn't fit is
+// destroyed along with its buffers.
+class ChunkPool {
+public:
+    static constexpr size_t MAX_CHUNKS = 32;
+    static constexpr size_t MAX_VERTEX_ARRAYS = 16;
+
+    // A chunk reset to the given position, recycled when one is available (worker safe)
+    std::unique_ptr<TerrainChunk> acquire(int chunkX, int chunkZ, BiomeType biome);
+    void release(std::unique_ptr<TerrainChunk> chunk);
+
+    // An empty vertex array, with its capacity if recycled (worker safe). release takes
+    // the contents of vertices and leaves it empty.
+    std::vector<TerrainVertex> acquireVertices();
+    void releaseVertices(std::vector<TerrainVertex>& vertices);
+
+    // Main thread, before bgfx::shutdown
+    void clear();
+
+    // Main thread: destroy pooled chunks, longest pooled first, until at least cpuBytes and
+    // gpuBytes are freed or the pool is empty
+    void trim(size_t cpuBytes, size_t gpuBytes);
+
+    struct Stats {
+        uint64_t chunksAllocated = 0;
+        uint64_t chunksReused = 0;
+        uint64_t vertexArraysAllocated = 0;
+        uint64_t vertexArraysReused = 0;
+        size_t pooledChunks = 0;
+        size_t pooledCpuBytes = 0;  // Pooled chunks and vertex arrays
+        size_t pooledGpuBytes = 0;  // Buffers the pooled chunks keep for their next use
+    };
+    Stats getStats() const;
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<TerrainChunk>> chunks;
+    std::vector<std::vector<TerrainVertex>> vertexArrays;
+    Stats stats;
+};
+
+// Chunk management system
+class ChunkManager {
+public:
+    static constexpr int RENDER_DISTANCE = 8; // Chunks in each direction (17x17 grid)
+    static constexpr float STREAMING_BUDGET_MS = 2.0f; // Main-thread collect/upload time per frame (at least one upload)
+    static constexpr float PREFETCH_SECONDS = 3.0f; // How far ahead of the player's movement to load
+    static constexpr int PREFETCH_MAX_CHUNKS = 4; // Cap on the prefetch offset, in chunks
+    static constexpr float HEADING_PRIORITY_WEIGHT = 0.5f; // Chunks straight ahead count as this much closer
+    static constexpr int LOD_RING_WIDTH = 2; // Chunk rings per LOD step, keeps neighbours within one LOD
+    static constexpr size_t DEFAULT_CPU_BUDGET_BYTES = 48 * 1024 * 1024; // Loaded + warm chunks
+    static constexpr size_t DEFAULT_GPU_BUDGET_BYTES = 96 * 1024 * 1024;
+
+    ChunkManager();
+    ~ChunkManager();
+
+    // Release all GPU resources, must be called before bgfx::shutdown
+    void shutdown();
+
+    // Set pointer to global resource nodes vector
+    void setResourceNodesPointer(std::vector<ResourceNode>* nodes);
+
+    // Set pointer to global NPCs vector
+    void setNPCsPointer(std::vector<std::unique_ptr<NPC>>* npcs);
+
+    // The player's combat target is cleared when the NPC it points at is unloaded
+    void setPlayerPointer(Player* player);
+
+    // Walkability graph over the loaded chunks, for NPC and click-to-move paths
+    const PathFinder& getPathFinder() const { return pathFinder; }
+
+    // Chunk build workers, shared with per-frame jobs so the game runs one pool of threads
+    ThreadPool& getWorkerPool() { return workerPool; }
+
+    // Spatial indexes over the chunk entities in the world vectors, kept up to date as
+    // chunks load and unload. NPCs move their own entries in NPC::update.
+    SpatialGrid<NPC>& getNPCGrid() { return npcGrid; }
+    const SpatialGrid<ResourceNode>& getResourceGrid() const { return resourceGrid; }
+
+    // Force initial chunk loading around player position (blocks until all chunks are ready)
+    void forceInitialChunkLoad(float playerX, float playerZ);
+
+    // Update chunks around player position, called once per frame. The velocity (world
+    // units per second) orders requests by heading and prefetches chunks ahead of it.
+    void updateChunksAroundPlayer(float playerX, float playerZ, float velocityX = 0.0f, float velocityZ = 0.0f);
+
+    // Get height at world coordinates from appropriate chunk. Positions outside the loaded
+    // chunks fall back to the coarse analytic heightfield, so any position can be queried.
+    float getHeightAt(float worldX, float worldZ) const;
+
+    // First point where a world-space ray meets the loaded terrain's full-resolution height
+    // grid, 5 units down where the terrain is drawn. The LOD/RTIN mesh on screen can differ
+    // from it by up to its error bound. Walks the chunks along the ray and descends each
+    // chunk's height pyramid.
+    bool raycast(const bx::Vec3& origin, const bx::Vec3& direction, float maxDistance, bx::Vec3& hitPoint) const;
+
+    // Loaded chunk at chunk coordinates, or nullptr
+    const TerrainChunk* findChunk(int chunkX, int chunkZ) const { return loadedChunks.find(chunkX, chunkZ); }
+
+    // Terrain editing brush. Position and radius are in world units and heights are as
+    // getHeightAt returns them. The effect fades out smoothly towards the radius.
+    struct TerrainBrush {
+        enum class Mode {
+            RAISE,    // Add amount at the centre (negative digs)
+            FLATTEN   // Pull heights towards targetHeight, amount (0..1) of the way at the centre
+        };
+        Mode mode = Mode::RAISE;
+        float x = 0.0f, z = 0.0f;
+        float radius = 4.0f;
+        float amount = 1.0f;
+        float targetHeight = SEA_LEVEL;
+    };
+
+    struct DeformResult {
+        int chunksChanged = 0;
+        int verticesChanged = 0;  // World grid vertices; border vertices count once
+        float milliseconds = 0.0f;
+    };
+
+    // Apply a brush to the loaded terrain. Shared border vertices get one new height that
+    // every chunk holding them stores, and vertices shared with a chunk that isn't loaded
+    // are left alone so the border still matches when it loads. Height and ray queries,
+    // walk costs, resource nodes in the brush and the GPU buffers are up to date when this
+    // returns; edited chunks are written to the cache when they unload.
+    DeformResult deformTerrain(const TerrainBrush& brush);
+
+    // Resident memory of the loaded terrain, of the warm chunks kept after unloading and of
+    // the chunk pool
+    struct MemoryStats {
+        size_t chunkCount = 0;
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+        size_t warmChunkCount = 0;
+        size_t warmCpuBytes = 0;
+        size_t warmGpuBytes = 0;
+        size_t pooledChunkCount = 0;
+        size_t pooledCpuBytes = 0;
+        size_t pooledGpuBytes = 0;
+    };
+    MemoryStats getMemoryStats() const;
+
+    // Memory the loaded, warm and pooled chunks may use together. Chunks that leave the load
+    // range stay warm (GPU buffers and CPU state intact) and come back without a rebuild.
+    // Over budget, the pool's spare chunks and buffers are freed first, then the least
+    // recently unloaded warm chunks. Loaded chunks are never evicted, so a budget below
+    // their footprint just disables the warm set and the pool.
+    void setResidencyBudget(size_t cpuBytes, size_t gpuBytes);
+
+    struct ResidencyStats {
+        size_t warmChunks = 0;
+        uint64_t warmHits = 0;       // Chunks restored from the warm set instead of rebuilt
+        uint64_t warmEvictions = 0;  // Warm chunks freed to stay within the budget
+        ChunkPool::Stats pool;
+        TerrainChunk::BufferStats buffers;
+    };
+    ResidencyStats getResidencyStats() const;
+
+    // Chunk build times split by source: generated (cold) or read from the cache (warm)
+    struct LoadStats {
+        int generatedChunks = 0;
+        double generateMilliseconds = 0.0;
+        int cachedChunks = 0;
+        double cacheMilliseconds = 0.0;
+    };
+    const LoadStats& getLoadStats() const { return loadStats; }
+
+    // Request queue state for the debug overlay
+    struct StreamingStats {
+        int queued = 0;           // Wanted, not yet handed to the workers
+        int inFlight = 0;         // Building on the workers
+        int awaitingUpload = 0;   // Built, waiting for their GPU upload
+        int cancelled = 0;        // Requests dropped because they went out of range (total)
+        float lastFrameMilliseconds = 0.0f;  // Main-thread collect + upload time last frame
+    };
+    StreamingStats getStreamingStats() const;
+    ChunkCache::Stats getCacheStats() const { return chunkCache.getStats(); }
+    HeightTileCache::Stats getHeightTileStats() const { return heightTiles.getStats(); }
+
+    // Terrain program that blends the biome texture array by the per-vertex weights.
+    // Without it (or without texture array support) chunks use program/texUniform
+    // from renderChunks with one texture per biome.
+    void setBiomeBlendProgram(bgfx::ProgramHandle program, bgfx::UniformHandle biomeSampler);
+
+    // Render all loaded chunks, skipping those outside the frustum when one is given
+    void renderChunks(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, const Frustum* frustum = nullptr);
+    int getTrianglesSubmitted() const { return trianglesSubmitted; }
+    const CullStats& getChunkCullStats() const { return chunkCullStats; }
+
+    // Switch between geomipmapped and adaptive (RTIN) chunk meshes. maxError is in
+    // world units, or in pixels when screenSpace is set (converted from chunk distance).
+    void setAdaptiveMeshing(bool enabled, float maxError = 0.05f, bool screenSpace = false);
+    bool isAdaptiveMeshing() const { return adaptiveMeshing; }
+
+    // Projection used to turn a pixel error into a world error
+    void setScreenErrorProjection(float fovYDegrees, float viewportHeight);
+
+    // LOD a chunk is drawn at, from its ring distance to the player's chunk
+    int getChunkLod(int chunkX, int chunkZ) const;
+
+    // Render water for all visible chunks that have water as a single draw. Rows of
+    // neighbouring water chunks are merged into one quad each, built into transient buffers.
+    void renderWater(bgfx::ProgramHandle program, bgfx::UniformHandle texUniform, bgfx::TextureHandle waterTexture);
+    int getWaterQuadCount() const { return waterQuadCount; }
+
+    // Get chunk info for debugging
+    std::vector<std::string> getLoadedChunkInfo() const;
+    size_t getPendingChunkCount() const { return requestQueue.size() + pendingChunks.size() + uploadQueue.size(); }
+
+    // Helper function to convert chunk coordinates to unique key
+    static uint64_t getChunkKey(int chunkX, int chunkZ);
+
+    // Determine biome for a chunk based on its world coordinates
+    static BiomeType getBiomeForChunk(int chunkX, int chunkZ);
+
+    // Get biome at any world position (used for blending)
+    static BiomeType getBiomeAtWorldPos(float worldX, float worldZ);
+
+    // Helper function to get biome name
+    static const char* getBiomeName(BiomeType biome);
+
+    // Full CPU-side chunk build (terrain + spawn lists), as run on the workers.
+    // Uses the cached record when there is one, otherwise generates from scratch.
+    // Returns nullptr without doing any work if cancelled is set when the job starts.
+    // The chunk object and its vertex array come from pool when one is given.
+    static std::unique_ptr<TerrainChunk> buildChunk(int chunkX, int chunkZ, ChunkCache* cache = nullptr,
+                                                    const std::atomic<bool>* cancelled = nullptr,
+                                                    ChunkPool* pool = nullptr);
+
+    // Decide procedural resource nodes and NPCs for a generated chunk
+    static void generateSpawns(TerrainChunk& chunk);
+
+private:
+    struct PendingChunk {
+        int chunkX, chunkZ;
+        std::future<std::unique_ptr<TerrainChunk>> result;
+        std::shared_ptr<std::atomic<bool>> cancelled;  // Set when the chunk is no longer wanted
+    };
+
+    // A wanted chunk; lower priority values are built and uploaded first
+    struct StreamRequest {
+        int chunkX, chunkZ;
+        float priority;
+    };
+
+    ChunkGrid loadedChunks;
+    std::vector<StreamRequest> requestQueue;                        // Wanted, sorted so the most urgent is last
+    std::unordered_map<uint64_t, PendingChunk> pendingChunks;       // Generating on workers
+    std::deque<std::unique_ptr<TerrainChunk>> uploadQueue;          // Generated, waiting for GPU upload
+    std::vector<std::future<std::unique_ptr<TerrainChunk>>> cancelledJobs;  // Collected so their chunks are recycled here
+    std::vector<ResourceNode>* worldResourceNodes = nullptr; // Pointer to global resource nodes
+    std::vector<std::unique_ptr<NPC>>* worldNPCs = nullptr; // Pointer to global NPCs
+    int playerChunkX = 0;
+    int playerChunkZ = 0;
+
+    // Streaming focus: player position/velocity and the chunk the prefetch is centred on
+    float playerPosX = 0.0f;
+    float playerPosZ = 0.0f;
+    float playerVelocityX = 0.0f;
+    float playerVelocityZ = 0.0f;
+    int prefetchChunkX = 0;
+    int prefetchChunkZ = 0;
+    int cancelledRequests = 0;
+    float lastStreamingMilliseconds = 0.0f;
+
+    // Water chunks gathered by renderWater, reused between frames
+    std::vector<std::pair<int, int>> waterChunks;
+    int waterQuadCount = 0;
+
+    Player* player = nullptr;
+    SpatialGrid<NPC> npcGrid;
+    SpatialGrid<ResourceNode> resourceGrid;  // Rebuilt whenever the node vector changes
+
+    void rebuildResourceGrid();
+
+    LoadStats loadStats;
+
+    // Shared terrain topology and textures
+    bgfx::IndexBufferHandle lodIndexBuffers[TerrainChunk::LOD_COUNT][TerrainChunk::STITCH_VARIANTS];
+    uint32_t lodTriangleCounts[TerrainChunk::LOD_COUNT][TerrainChunk::STITCH_VARIANTS] = {};
+    // Per-frame chunk culling scratch
+    BoxBounds chunkBounds;
+    std::vector<uint8_t> chunkVisibility;
+    CullStats chunkCullStats;
+
+    bgfx::TextureHandle biomeTextures[BIOME_COUNT];
+    bgfx::TextureHandle biomeTextureArray = BGFX_INVALID_HANDLE;
+    bool biomeTextureArrayFailed = false;
+    bgfx::ProgramHandle biomeBlendProgram = BGFX_INVALID_HANDLE;  // Owned by the caller
+    bgfx::UniformHandle biomeArraySampler = BGFX_INVALID_HANDLE;
+    int trianglesSubmitted = 0;
+
+    // Adaptive meshing settings
+    bool adaptiveMeshing = false;
+    float adaptiveMaxError = 0.05f;
+    bool adaptiveScreenSpace = false;
+    float pixelsToWorldAtUnitDistance = 2.0f * 0.57735f / 600.0f; // 2*tan(30deg) / viewport height
+
+    float getAdaptiveErrorForChunk(int chunkX, int chunkZ) const;
+
+    void createLodIndexBuffers();
+    bgfx::TextureHandle getBiomeTexture(BiomeType biome);
+    bgfx::TextureHandle getBiomeTextureArray();
+
+    static void generateResourceSpawns(TerrainChunk& chunk);
+    static void generateNPCSpawns(TerrainChunk& chunk);
+
+    bool isInLoadRange(int chunkX, int chunkZ) const;
+    float getStreamPriority(int chunkX, int chunkZ) const;
+    void refreshStreamRequests();
+    void cancelStaleRequests();
+    void dispatchStreamRequests();
+    void unloadDistantChunks();
+    void collectFinishedChunks();
+    void uploadChunk(std::unique_ptr<TerrainChunk> chunk);
+    void storeLoadedChunk(std::unique_ptr<TerrainChunk> chunk);
+    void instantiateChunkEntities(const TerrainChunk& chunk);
+    void processUploadQueue(float budgetMilliseconds);
+
+    // Warm set: chunks unloaded with their buffers intact, most recently unloaded first
+    bool restoreWarmChunk(int chunkX, int chunkZ);
+    void trimWarmChunks();
+    std::list<std::unique_ptr<TerrainChunk>> warmChunks;
+    std::unordered_map<uint64_t, std::list<std::unique_ptr<TerrainChunk>>::iterator> warmChunkIndex;
+    size_t cpuBudgetBytes = DEFAULT_CPU_BUDGET_BYTES;
+    size_t gpuBudgetBytes = DEFAULT_GPU_BUDGET_BYTES;
+    uint64_t warmHits = 0;
+    uint64_t warmEvictions = 0;
+    ChunkPool chunkPool;
+
+    // Chunk entities live in the world vectors while their chunk is loaded. Syncing copies
+    // their state back into the chunks' spawn lists; removing drops them from the world vectors.
+    void syncChunkEntities(const std::vector<TerrainChunk*>& chunks);
+    void removeChunkEntities(const std::vector<TerrainChunk*>& chunks);
+
+    // Store the chunk in the cache if it is new or its spawn state changed
+    void saveChunk(TerrainChunk& chunk);
+
+    // Region files under the working directory, read by the workers
+    ChunkCache chunkCache{"world_cache", TerrainChunk::CACHE_VERSION};
+
+    // Heights for positions outside the loaded chunks
+    mutable HeightTileCache heightTiles{TerrainChunk::SCALE};
+
+    // Clusters are built on workerPool, which is only used once the constructor has run
+    PathFinder pathFinder{workerPool};
+
+    // Declared last so workers are joined before the queues above are destroyed
+    ThreadPool workerPool;
+};
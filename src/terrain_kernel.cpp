@@ -0,0 +1,471 @@
+#include "terrain_kernel.h"
+#include "terrain.h"
+#include "simd.h"
+#include <bx/math.h>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace TerrainKernel {
+
+namespace {
+
+// Global noise function that works across chunk boundaries
+float referenceGlobalNoise(float worldX, float worldZ) {
+    // Multiple octaves of noise for better variation
+    float noise = 0.0f;
+
+    // Large scale features (octave 1)
+    noise += bx::sin(worldX * 0.01f) * bx::cos(worldZ * 0.012f) * 1.0f;
+
+    // Medium scale features (octave 2)
+    noise += bx::sin(worldX * 0.03f + worldZ * 0.02f) * 0.5f;
+
+    // Fine detail (octave 3)
+    noise += bx::sin(worldX * 0.08f) * bx::cos(worldZ * 0.075f) * 0.25f;
+
+    // Very fine detail (octave 4)
+    noise += bx::sin(worldX * 0.15f + worldZ * 0.12f) * 0.125f;
+
+    return noise * 0.4f; // Scale down total amplitude
+}
+
+// Biome weights exactly as referenceBiomeHeight computes them, in BiomeType order
+void referenceBiomeWeights(float worldX, float worldZ, float* outWeights) {
+    float biomeNoise = bx::sin(worldX * 0.001f) * bx::cos(worldZ * 0.0008f);
+    biomeNoise += bx::sin(worldX * 0.0005f + worldZ * 0.0007f) * 0.3f;
+
+    float swampWeight = 1.0f - bx::clamp((biomeNoise + 0.3f) / 0.4f, 0.0f, 1.0f);
+    float desertWeight = bx::max(0.0f, 1.0f - bx::abs(biomeNoise + 0.2f) / 0.2f);
+    float grasslandWeight = bx::max(0.0f, 1.0f - bx::abs(biomeNoise - 0.05f) / 0.3f);
+    float mountainWeight = bx::clamp((biomeNoise - 0.1f) / 0.3f, 0.0f, 1.0f);
+
+    float totalWeight = swampWeight + desertWeight + grasslandWeight + mountainWeight;
+    if (totalWeight <= 0.0f) totalWeight = 1.0f;
+    outWeights[(int)BiomeType::DESERT] = desertWeight / totalWeight;
+    outWeights[(int)BiomeType::MOUNTAINS] = mountainWeight / totalWeight;
+    outWeights[(int)BiomeType::SWAMP] = swampWeight / totalWeight;
+    outWeights[(int)BiomeType::GRASSLAND] = grasslandWeight / totalWeight;
+}
+
+float referenceBiomeHeight(float baseNoise, float worldX, float worldZ) {
+    const float HEIGHT_SCALE = TerrainChunk::HEIGHT_SCALE;
+
+    // Add secondary global noise layers for more detail (using world coordinates)
+    float detailNoise1 = bx::sin(worldX * 0.05f) * bx::cos(worldZ * 0.04f);
+    float detailNoise2 = bx::sin(worldX * 0.12f + worldZ * 0.1f);
+    float fineNoise = bx::sin(worldX * 0.25f) * bx::cos(worldZ * 0.22f);
+
+    // Calculate biome influence at this exact world position for smooth blending
+    float biomeNoise = bx::sin(worldX * 0.001f) * bx::cos(worldZ * 0.0008f);
+    biomeNoise += bx::sin(worldX * 0.0005f + worldZ * 0.0007f) * 0.3f;
+
+    // Add ocean areas using large-scale noise
+    float oceanNoise = bx::sin(worldX * 0.0003f) * bx::cos(worldZ * 0.0004f);
+    oceanNoise += bx::sin(worldX * 0.0002f + worldZ * 0.0003f) * 0.5f;
+    bool isOceanArea = oceanNoise < -0.6f;  // Specific areas are oceans
+
+    // Calculate weights for each biome based on distance from thresholds
+    float swampWeight = 1.0f - bx::clamp((biomeNoise + 0.3f) / 0.4f, 0.0f, 1.0f);  // Strong below -0.3
+    float desertWeight = bx::max(0.0f, 1.0f - bx::abs(biomeNoise + 0.2f) / 0.2f);    // Peak at -0.2
+    float grasslandWeight = bx::max(0.0f, 1.0f - bx::abs(biomeNoise - 0.05f) / 0.3f); // Peak at 0.05
+    float mountainWeight = bx::clamp((biomeNoise - 0.1f) / 0.3f, 0.0f, 1.0f);        // Strong above 0.2
+
+    // Normalize weights so they sum to 1.0
+    float totalWeight = swampWeight + desertWeight + grasslandWeight + mountainWeight;
+    if (totalWeight > 0.0f) {
+        swampWeight /= totalWeight;
+        desertWeight /= totalWeight;
+        grasslandWeight /= totalWeight;
+        mountainWeight /= totalWeight;
+    }
+
+    // Calculate height for each biome type
+    // Swamps: Low wetlands, oscillating around sea level for patches of water and land
+    float swampVariation = bx::sin(worldX * 0.08f) * bx::cos(worldZ * 0.07f) * 0.8f; // Create patchy wetlands
+    float swampHeight = baseNoise * HEIGHT_SCALE * 0.2f + swampVariation + detailNoise2 * HEIGHT_SCALE * 0.1f + 0.5f;
+
+    // Deserts: Dry, above sea level with dunes
+    float desertHeight = baseNoise * HEIGHT_SCALE * 1.2f + detailNoise1 * HEIGHT_SCALE * 0.3f + fineNoise * HEIGHT_SCALE * 0.1f + 3.0f;
+
+    // Grasslands: Rolling hills, can have some low areas near water
+    float grasslandHeight = baseNoise * HEIGHT_SCALE * 1.5f + detailNoise1 * HEIGHT_SCALE * 0.8f + detailNoise2 * HEIGHT_SCALE * 0.4f + fineNoise * HEIGHT_SCALE * 0.2f + 2.0f;
+
+    // Mountains: High elevation, only deep valleys might have water
+    float mountainHeight = (baseNoise + 0.2f) * HEIGHT_SCALE * 2.5f + detailNoise1 * HEIGHT_SCALE * 1.2f + detailNoise2 * HEIGHT_SCALE * 0.6f + fineNoise * HEIGHT_SCALE * 0.3f + 10.0f;
+
+    // Blend heights based on biome weights for seamless transitions
+    float blendedHeight = swampHeight * swampWeight + desertHeight * desertWeight + grasslandHeight * grasslandWeight + mountainHeight * mountainWeight;
+
+    // If this is an ocean area, create underwater terrain
+    if (isOceanArea) {
+        // Ocean floor is below sea level
+        float oceanDepth = 3.0f + baseNoise * 2.0f + detailNoise1 * 0.5f;
+        blendedHeight = SEA_LEVEL - oceanDepth;
+    }
+
+    // Apply underwater flattening - terrain below sea level gets progressively flatter
+    if (blendedHeight < SEA_LEVEL) {
+        float depthBelowSeaLevel = SEA_LEVEL - blendedHeight;
+        float flatteningFactor = 1.0f - bx::min(depthBelowSeaLevel * OCEAN_DEPTH_SCALE, 0.8f);
+        blendedHeight = SEA_LEVEL - (depthBelowSeaLevel * flatteningFactor);
+    }
+
+    return blendedHeight;
+}
+
+// Per-biome height terms, in BiomeType order:
+// height = baseNoise * base + detailNoise1 * detail1 + detailNoise2 * detail2
+//        + fineNoise * fine + swampVariation * variation + offset
+// A biome's blend weight is non-zero only for biome noise strictly inside
+// (supportMin, supportMax); see biomeWeight below.
+struct BiomeTerms {
+    float supportMin, supportMax;
+    float base, detail1, detail2, fine, variation, offset;
+};
+
+constexpr float HS = TerrainChunk::HEIGHT_SCALE;
+constexpr float UNBOUNDED = std::numeric_limits<float>::infinity();
+constexpr BiomeTerms kBiomeTerms[BIOME_COUNT] = {
+    { -0.4f, 0.0f, HS * 1.2f, HS * 0.3f, 0.0f, HS * 0.1f, 0.0f, 3.0f },                      // DESERT
+    { 0.1f, UNBOUNDED, HS * 2.5f, HS * 1.2f, HS * 0.6f, HS * 0.3f, 0.0f, 0.2f * HS * 2.5f + 10.0f }, // MOUNTAINS
+    { -UNBOUNDED, 0.1f, HS * 0.2f, 0.0f, HS * 0.1f, 0.0f, 0.8f, 0.5f },                      // SWAMP
+    { -0.25f, 0.35f, HS * 1.5f, HS * 0.8f, HS * 0.4f, HS * 0.2f, 0.0f, 2.0f },               // GRASSLAND
+};
+
+constexpr int kAllBiomes = (1 << BIOME_COUNT) - 1;
+
+constexpr bool anyBiomeUses(int biomeMask, float BiomeTerms::*term) {
+    for (int biome = 0; biome < BIOME_COUNT; biome++) {
+        if ((biomeMask & (1 << biome)) && kBiomeTerms[biome].*term != 0.0f) return true;
+    }
+    return false;
+}
+
+constexpr int singleBiome(int biomeMask) {
+    for (int biome = 0; biome < BIOME_COUNT; biome++) {
+        if (biomeMask == (1 << biome)) return biome;
+    }
+    return -1;
+}
+
+// Largest slope of the biome and ocean noise along each axis: the sum over their terms of
+// frequency times amplitude. Used to bound the noise over a region from its centre.
+constexpr float kBiomeNoiseSlopeX = 0.001f + 0.0005f * 0.3f;
+constexpr float kBiomeNoiseSlopeZ = 0.0008f + 0.0007f * 0.3f;
+constexpr float kOceanNoiseSlopeX = 0.0003f + 0.0002f * 0.5f;
+constexpr float kOceanNoiseSlopeZ = 0.0004f + 0.0003f * 0.5f;
+
+// Covers the difference between bx trig and the polynomial trig of the batched kernels
+constexpr float kClassifySlack = 1e-3f;
+
+// Same expressions as referenceBiomeWeights, before normalization
+template <int Biome, typename V>
+V biomeWeight(V biomeNoise) {
+    using namespace Simd;
+    const V zero(0.0f);
+    const V one(1.0f);
+    if constexpr (Biome == (int)BiomeType::SWAMP) {
+        return one - clamp((biomeNoise + V(0.3f)) / V(0.4f), zero, one);
+    } else if constexpr (Biome == (int)BiomeType::DESERT) {
+        return max(zero, one - abs(biomeNoise + V(0.2f)) / V(0.2f));
+    } else if constexpr (Biome == (int)BiomeType::GRASSLAND) {
+        return max(zero, one - abs(biomeNoise - V(0.05f)) / V(0.3f));
+    } else {
+        return clamp((biomeNoise - V(0.1f)) / V(0.3f), zero, one);
+    }
+}
+
+template <int Biome, typename V>
+V biomeHeight(V baseNoise, V detailNoise1, V detailNoise2, V fineNoise, V swampVariation) {
+    constexpr BiomeTerms terms = kBiomeTerms[Biome];
+    V height = baseNoise * V(terms.base) + V(terms.offset);
+    if constexpr (terms.detail1 != 0.0f) height = height + detailNoise1 * V(terms.detail1);
+    if constexpr (terms.detail2 != 0.0f) height = height + detailNoise2 * V(terms.detail2);
+    if constexpr (terms.fine != 0.0f) height = height + fineNoise * V(terms.fine);
+    if constexpr (terms.variation != 0.0f) height = height + swampVariation * V(terms.variation);
+    return height;
+}
+
+// f(std::integral_constant<int, biome>) for every biome in BiomeMask, in BiomeType order
+template <int BiomeMask, typename F, int... Biomes>
+void forEachBiome(F&& f, std::integer_sequence<int, Biomes...>) {
+    auto visit = [&](auto biome) {
+        if constexpr ((BiomeMask >> decltype(biome)::value) & 1) f(biome);
+    };
+    (visit(std::integral_constant<int, Biomes>()), ...);
+}
+
+template <int BiomeMask, typename F>
+void forEachBiome(F&& f) {
+    forEachBiome<BiomeMask>(f, std::make_integer_sequence<int, BIOME_COUNT>());
+}
+
+// Noise terms that only depend on worldX, evaluated once per column
+struct ColumnTerms {
+    std::vector<float> worldX;
+    std::vector<float> sin001, sin008, sin005, sin025, sin0001, sin0003;
+
+    void resize(int count) {
+        for (auto* v : { &worldX, &sin001, &sin008, &sin005, &sin025, &sin0001, &sin0003 }) {
+            v->resize(count);
+        }
+    }
+};
+
+// Same maths as referenceGlobalNoise + referenceBiomeHeight, reorganised so that the
+// single-axis sin/cos factors are shared along rows and columns and the remaining
+// diagonal terms are evaluated W vertices at a time with polynomial trig.
+//
+// BiomeMask and Ocean come from classifyRegion: biomes outside the mask have zero weight
+// everywhere in the region, so their terms, and any noise only they use, are compiled out.
+// A single biome needs no biome noise at all since its normalized weight is 1. Within a
+// blend, biome terms are still skipped when no lane in the batch has weight for them.
+template <typename V, int BiomeMask, OceanCoverage Ocean>
+void generateHeightsBatched(int gridX0, int gridZ0, int size, float scale, float* outHeights, float* outBiomeWeights) {
+    using namespace Simd;
+    constexpr int W = V::kWidth;
+    constexpr int kSingleBiome = singleBiome(BiomeMask);
+    constexpr bool kNeedsBiomeHeights = Ocean != OceanCoverage::FULL;
+    constexpr bool kNeedsDetail1 = (kNeedsBiomeHeights && anyBiomeUses(BiomeMask, &BiomeTerms::detail1)) || Ocean != OceanCoverage::NONE;
+    constexpr bool kNeedsDetail2 = kNeedsBiomeHeights && anyBiomeUses(BiomeMask, &BiomeTerms::detail2);
+    constexpr bool kNeedsFine = kNeedsBiomeHeights && anyBiomeUses(BiomeMask, &BiomeTerms::fine);
+    constexpr bool kNeedsVariation = kNeedsBiomeHeights && anyBiomeUses(BiomeMask, &BiomeTerms::variation);
+    // Blend weights feed the heights unless there is one biome or nothing but ocean
+    const bool needsWeights = kSingleBiome < 0 && (kNeedsBiomeHeights || outBiomeWeights);
+    const int paddedSize = (size + W - 1) / W * W;
+
+    ColumnTerms columns;
+    columns.resize(paddedSize);
+    for (int x = 0; x < paddedSize; x++) {
+        columns.worldX[x] = (gridX0 + x) * scale;
+    }
+    for (int x = 0; x < paddedSize; x += W) {
+        V wx = V::load(&columns.worldX[x]);
+        sin(wx * V(0.01f)).store(&columns.sin001[x]);
+        sin(wx * V(0.08f)).store(&columns.sin008[x]);
+        if (kNeedsDetail1) sin(wx * V(0.05f)).store(&columns.sin005[x]);
+        if (kNeedsFine) sin(wx * V(0.25f)).store(&columns.sin025[x]);
+        if (needsWeights) sin(wx * V(0.001f)).store(&columns.sin0001[x]);
+        if (Ocean == OceanCoverage::PARTIAL) sin(wx * V(0.0003f)).store(&columns.sin0003[x]);
+    }
+
+    std::vector<float> row(paddedSize);
+    std::vector<float> rowWeights[kBiomeWeightCount];
+    if (outBiomeWeights) {
+        for (int biome = 0; biome < kBiomeWeightCount; biome++) {
+            // A single biome's weights are the same everywhere
+            rowWeights[biome].assign(paddedSize, biome == kSingleBiome ? 1.0f : 0.0f);
+        }
+    }
+    const V zero(0.0f);
+    const V one(1.0f);
+    const V seaLevel(SEA_LEVEL);
+
+    for (int z = 0; z < size; z++) {
+        const float worldZ = (gridZ0 + z) * scale;
+        const V wz(worldZ);
+
+        // Noise terms that only depend on worldZ, shared by the whole row
+        const V cos012 = cos(ScalarFloat(worldZ * 0.012f)).v;
+        const V cos075 = cos(ScalarFloat(worldZ * 0.075f)).v;
+        const V cos04 = cos(ScalarFloat(worldZ * 0.04f)).v;
+        const V cos022 = cos(ScalarFloat(worldZ * 0.22f)).v;
+        const V cos0008 = cos(ScalarFloat(worldZ * 0.0008f)).v;
+        const V cos0004 = cos(ScalarFloat(worldZ * 0.0004f)).v;
+        const V cos007 = cos(ScalarFloat(worldZ * 0.07f)).v;
+
+        for (int x = 0; x < paddedSize; x += W) {
+            const V wx = V::load(&columns.worldX[x]);
+            const V sin008 = V::load(&columns.sin008[x]);
+
+            V baseNoise = V::load(&columns.sin001[x]) * cos012;
+            baseNoise = baseNoise + sin(wx * V(0.03f) + wz * V(0.02f)) * V(0.5f);
+            baseNoise = baseNoise + sin008 * cos075 * V(0.25f);
+            baseNoise = baseNoise + sin(wx * V(0.15f) + wz * V(0.12f)) * V(0.125f);
+            baseNoise = baseNoise * V(0.4f);
+
+            const V detailNoise1 = kNeedsDetail1 ? V::load(&columns.sin005[x]) * cos04 : zero;
+            const V fineNoise = kNeedsFine ? V::load(&columns.sin025[x]) * cos022 : zero;
+
+            V weights[BIOME_COUNT] = { zero, zero, zero, zero };
+            if (needsWeights) {
+                V biomeNoise = V::load(&columns.sin0001[x]) * cos0008;
+                biomeNoise = biomeNoise + sin(wx * V(0.0005f) + wz * V(0.0007f)) * V(0.3f);
+
+                V totalWeight = zero;
+                forEachBiome<BiomeMask>([&](auto biome) {
+                    constexpr int b = decltype(biome)::value;
+                    weights[b] = biomeWeight<b>(biomeNoise);
+                    totalWeight = totalWeight + weights[b];
+                });
+                totalWeight = select(greaterThan(totalWeight, zero), totalWeight, one);
+                forEachBiome<BiomeMask>([&](auto biome) {
+                    constexpr int b = decltype(biome)::value;
+                    weights[b] = weights[b] / totalWeight;
+                });
+
+                if (outBiomeWeights) {
+                    forEachBiome<BiomeMask>([&](auto biome) {
+                        constexpr int b = decltype(biome)::value;
+                        weights[b].store(&rowWeights[b][x]);
+                    });
+                }
+            }
+
+            V height = zero;
+            if constexpr (kNeedsBiomeHeights) {
+                const V detailNoise2 = kNeedsDetail2 ? sin(wx * V(0.12f) + wz * V(0.1f)) : zero;
+                const V swampVariation = kNeedsVariation ? sin008 * cos007 : zero;
+                if constexpr (kSingleBiome >= 0) {
+                    height = biomeHeight<kSingleBiome>(baseNoise, detailNoise1, detailNoise2, fineNoise, swampVariation);
+                } else {
+                    forEachBiome<BiomeMask>([&](auto biome) {
+                        constexpr int b = decltype(biome)::value;
+                        if (any(greaterThan(weights[b], zero))) {
+                            height = height + biomeHeight<b>(baseNoise, detailNoise1, detailNoise2, fineNoise, swampVariation) * weights[b];
+                        }
+                    });
+                }
+            }
+
+            // Ocean areas replace the blended height with an ocean floor
+            if constexpr (Ocean == OceanCoverage::FULL) {
+                height = seaLevel - (V(3.0f) + baseNoise * V(2.0f) + detailNoise1 * V(0.5f));
+            } else if constexpr (Ocean == OceanCoverage::PARTIAL) {
+                V oceanNoise = V::load(&columns.sin0003[x]) * cos0004;
+                oceanNoise = oceanNoise + sin(wx * V(0.0002f) + wz * V(0.0003f)) * V(0.5f);
+                const auto isOcean = lessThan(oceanNoise, V(-0.6f));
+                if (any(isOcean)) {
+                    V oceanDepth = V(3.0f) + baseNoise * V(2.0f) + detailNoise1 * V(0.5f);
+                    height = select(isOcean, seaLevel - oceanDepth, height);
+                }
+            }
+
+            // Underwater flattening
+            const auto isUnderwater = lessThan(height, seaLevel);
+            if (any(isUnderwater)) {
+                V depthBelowSeaLevel = seaLevel - height;
+                V flatteningFactor = one - min(depthBelowSeaLevel * V(OCEAN_DEPTH_SCALE), V(0.8f));
+                height = select(isUnderwater, seaLevel - depthBelowSeaLevel * flatteningFactor, height);
+            }
+
+            height.store(&row[x]);
+        }
+
+        std::memcpy(outHeights + z * size, row.data(), size * sizeof(float));
+
+        if (outBiomeWeights) {
+            float* outRow = outBiomeWeights + (size_t)z * size * kBiomeWeightCount;
+            for (int x = 0; x < size; x++) {
+                for (int biome = 0; biome < kBiomeWeightCount; biome++) {
+                    outRow[x * kBiomeWeightCount + biome] = rowWeights[biome][x];
+                }
+            }
+        }
+    }
+}
+
+using BatchedKernel = void (*)(int, int, int, float, float*, float*);
+
+// One specialization per biome mask (mask 0 never occurs and falls back to all biomes)
+template <OceanCoverage Ocean, int... Masks>
+constexpr std::array<BatchedKernel, sizeof...(Masks)> makeKernelTable(std::integer_sequence<int, Masks...>) {
+    return { &generateHeightsBatched<Simd::SimdFloat, Masks == 0 ? kAllBiomes : Masks, Ocean>... };
+}
+
+constexpr auto kLandKernels = makeKernelTable<OceanCoverage::NONE>(std::make_integer_sequence<int, kAllBiomes + 1>());
+constexpr auto kCoastKernels = makeKernelTable<OceanCoverage::PARTIAL>(std::make_integer_sequence<int, kAllBiomes + 1>());
+
+} // namespace
+
+RegionClass classifyRegion(int gridX0, int gridZ0, int size, float scale) {
+    const float halfX = (size - 1) * scale * 0.5f;
+    const float halfZ = (size - 1) * scale * 0.5f;
+    const float centreX = gridX0 * scale + halfX;
+    const float centreZ = gridZ0 * scale + halfZ;
+
+    float biomeNoise = bx::sin(centreX * 0.001f) * bx::cos(centreZ * 0.0008f);
+    biomeNoise += bx::sin(centreX * 0.0005f + centreZ * 0.0007f) * 0.3f;
+    const float biomeRange = kBiomeNoiseSlopeX * halfX + kBiomeNoiseSlopeZ * halfZ + kClassifySlack;
+
+    float oceanNoise = bx::sin(centreX * 0.0003f) * bx::cos(centreZ * 0.0004f);
+    oceanNoise += bx::sin(centreX * 0.0002f + centreZ * 0.0003f) * 0.5f;
+    const float oceanRange = kOceanNoiseSlopeX * halfX + kOceanNoiseSlopeZ * halfZ + kClassifySlack;
+
+    RegionClass region;
+    for (int biome = 0; biome < BIOME_COUNT; biome++) {
+        if (biomeNoise - biomeRange < kBiomeTerms[biome].supportMax && biomeNoise + biomeRange > kBiomeTerms[biome].supportMin) {
+            region.biomeMask |= 1 << biome;
+        }
+    }
+    if (oceanNoise + oceanRange < -0.6f) {
+        region.ocean = OceanCoverage::FULL;
+    } else if (oceanNoise - oceanRange >= -0.6f) {
+        region.ocean = OceanCoverage::NONE;
+    }
+    return region;
+}
+
+void generateHeights(int gridX0, int gridZ0, int size, float scale, float* outHeights, Path path, float* outBiomeWeights) {
+    switch (path) {
+        case Path::REFERENCE:
+            for (int z = 0; z < size; z++) {
+                for (int x = 0; x < size; x++) {
+                    outHeights[z * size + x] = referenceHeight((gridX0 + x) * scale, (gridZ0 + z) * scale);
+                }
+            }
+            if (outBiomeWeights) {
+                generateBiomeWeights(gridX0, gridZ0, size, scale, outBiomeWeights);
+            }
+            break;
+        case Path::SCALAR:
+            generateHeightsBatched<Simd::ScalarFloat, kAllBiomes, OceanCoverage::PARTIAL>(gridX0, gridZ0, size, scale, outHeights, outBiomeWeights);
+            break;
+        case Path::GENERIC:
+            generateHeightsBatched<Simd::SimdFloat, kAllBiomes, OceanCoverage::PARTIAL>(gridX0, gridZ0, size, scale, outHeights, outBiomeWeights);
+            break;
+        case Path::SIMD: {
+            const RegionClass region = classifyRegion(gridX0, gridZ0, size, scale);
+            if (region.ocean == OceanCoverage::FULL) {
+                generateHeightsBatched<Simd::SimdFloat, kAllBiomes, OceanCoverage::FULL>(gridX0, gridZ0, size, scale, outHeights, outBiomeWeights);
+            } else if (region.ocean == OceanCoverage::NONE) {
+                kLandKernels[region.biomeMask](gridX0, gridZ0, size, scale, outHeights, outBiomeWeights);
+            } else {
+                kCoastKernels[region.biomeMask](gridX0, gridZ0, size, scale, outHeights, outBiomeWeights);
+            }
+            break;
+        }
+    }
+}
+
+void generateBiomeWeights(int gridX0, int gridZ0, int size, float scale, float* outBiomeWeights) {
+    generateBiomeWeights(gridX0, gridZ0, size, size, scale, outBiomeWeights);
+}
+
+void generateBiomeWeights(int gridX0, int gridZ0, int width, int height, float scale, float* outBiomeWeights) {
+    for (int z = 0; z < height; z++) {
+        for (int x = 0; x < width; x++) {
+            referenceBiomeWeights((gridX0 + x) * scale, (gridZ0 + z) * scale,
+                                  outBiomeWeights + ((size_t)z * width + x) * kBiomeWeightCount);
+        }
+    }
+}
+
+float referenceHeight(float worldX, float worldZ) {
+    return referenceBiomeHeight(referenceGlobalNoise(worldX, worldZ), worldX, worldZ);
+}
+
+bool isOceanEdge(float worldX, float worldZ) {
+    float oceanNoise = bx::sin(worldX * 0.0003f) * bx::cos(worldZ * 0.0004f);
+    oceanNoise += bx::sin(worldX * 0.0002f + worldZ * 0.0003f) * 0.5f;
+    return bx::abs(oceanNoise + 0.6f) < 1e-4f;
+}
+
+const char* getSimdName() {
+    return Simd::SimdFloat::kName;
+}
+
+} // namespace TerrainKernel
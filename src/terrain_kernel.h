@@ -0,0 +1,58 @@
+#pragma once
+
+// Batched heightfield evaluation for terrain chunks
+namespace TerrainKernel {
+
+enum class Path {
+    REFERENCE,  // Original per-vertex bx::sin/cos code, kept for verification
+    SCALAR,     // Batched kernel, one vertex per step
+    GENERIC,    // Batched kernel at SIMD width evaluating every biome and the ocean mask everywhere
+    SIMD        // Batched kernel, widest SIMD width available (AVX2/SSE2/NEON), specialized
+                // for the biomes and ocean coverage classifyRegion finds in the region
+};
+
+// Largest height difference allowed between the batched kernels and REFERENCE
+constexpr float kMaxHeightError = 1e-3f;
+
+// Number of blend weights per vertex, one per BiomeType in enum order
+constexpr int kBiomeWeightCount = 4;
+
+enum class OceanCoverage {
+    NONE,     // Ocean noise stays above the threshold everywhere
+    PARTIAL,  // The region may cross a coastline
+    FULL      // Ocean floor everywhere
+};
+
+// What can occur over a grid region, from bounds on the biome and ocean noise over its
+// extent. Conservative: a biome in the mask may still end up with zero weight.
+struct RegionClass {
+    int biomeMask = 0;  // Bit n set if BiomeType n can have non-zero weight
+    OceanCoverage ocean = OceanCoverage::PARTIAL;
+};
+
+// Same region arguments as generateHeights
+RegionClass classifyRegion(int gridX0, int gridZ0, int size, float scale);
+
+// Fill size*size heights (row-major, z rows) for grid vertices
+// worldX = (gridX0 + x) * scale, worldZ = (gridZ0 + z) * scale
+// outBiomeWeights, if given, receives the normalized biome blend weights the heights
+// were mixed with: kBiomeWeightCount per vertex, in BiomeType order.
+void generateHeights(int gridX0, int gridZ0, int size, float scale, float* outHeights, Path path = Path::SIMD,
+                     float* outBiomeWeights = nullptr);
+
+// Biome blend weights alone, same layout as generateHeights (used when heights come from the cache)
+void generateBiomeWeights(int gridX0, int gridZ0, int size, float scale, float* outBiomeWeights);
+// The same over width x height vertices, row-major (edited rows of a chunk)
+void generateBiomeWeights(int gridX0, int gridZ0, int width, int height, float scale, float* outBiomeWeights);
+
+// Height of a single world position using the reference path
+float referenceHeight(float worldX, float worldZ);
+
+// True where the ocean mask sits within rounding of its threshold. Heights jump there,
+// so the batched paths may legitimately land on the other side of the step.
+bool isOceanEdge(float worldX, float worldZ);
+
+// Name of the instruction set the SIMD path was compiled for
+const char* getSimdName();
+
+} // namespace TerrainKernel
@@ -0,0 +1,28 @@
+// Single-header library implementations, compiled once and shared by every target that
+// links model.cpp (the game and the headless benchmark)
+
+// Define STB_IMAGE_IMPLEMENTATION before including to create the implementation
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Define TINYGLTF_IMPLEMENTATION and required flags once in the project
+#define TINYGLTF_IMPLEMENTATION
+#define TINYGLTF_NO_STB_IMAGE
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include "tiny_gltf.h"
+
+// Provide stub implementations for TinyGLTF image functions since we disabled STB_IMAGE in TinyGLTF
+namespace tinygltf {
+    bool LoadImageData(Image* image, const int image_idx, std::string* err, std::string* warn,
+                      int req_width, int req_height, const unsigned char* bytes, int size, void* user_data) {
+        // This is handled by our custom image loader in the model loading code
+        return false; // Return false to indicate we're not handling it here
+    }
+    
+    bool WriteImageData(const std::string* basepath, const std::string* filename,
+                       const Image* image, bool embedImages, const FsCallbacks* fs, 
+                       const URICallbacks* uri_cb, std::string* out_uri, void* user_data) {
+        // We don't support writing images
+        return false;
+    }
+}
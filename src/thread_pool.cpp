@@ -0,0 +1,47 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    if (numThreads == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        numThreads = cores > 1 ? cores - 1 : 1;
+    }
+
+    workers.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        // Drop jobs that never started - their futures report broken_promise
+        jobs.clear();
+    }
+    queueCondition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getQueuedJobCount() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return jobs.size();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
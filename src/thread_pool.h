@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads for background jobs (terrain generation etc.)
+class ThreadPool {
+public:
+    // 0 threads = one per hardware core, leaving one for the main thread
+    explicit ThreadPool(size_t numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a job and get a future for its result
+    template <typename F>
+    auto submit(F&& job) -> std::future<decltype(job())> {
+        return enqueue(std::forward<F>(job), false);
+    }
+
+    // Same, but ahead of every queued job, for work the main thread is waiting on
+    template <typename F>
+    auto submitUrgent(F&& job) -> std::future<decltype(job())> {
+        return enqueue(std::forward<F>(job), true);
+    }
+
+    size_t getThreadCount() const { return workers.size(); }
+    size_t getQueuedJobCount() const;
+
+private:
+    template <typename F>
+    auto enqueue(F&& job, bool urgent) -> std::future<decltype(job())> {
+        using Result = decltype(job());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (urgent) {
+                jobs.emplace_front([task]() { (*task)(); });
+            } else {
+                jobs.emplace_back([task]() { (*task)(); });
+            }
+        }
+        queueCondition.notify_one();
+        return result;
+    }
+
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    mutable std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping = false;
+};
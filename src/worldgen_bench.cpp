@@ -0,0 +1,1720 @@
+// Headless world generation benchmark. Times terrain generation per stage, the chunk
+// cache, the CPU-side height/ray/proximity/path queries, terrain edits and a long
+// streaming walk, plus batched NPC animation at 1k and 10k instances across thread counts,
+// animation LOD cost and error and a CPU check of the packed GPU skinning palette, and
+// reports everything as JSON so generation cost can be tracked between commits.
+//
+// Correctness checks (parallel against serial generation, batched kernels against the
+// reference, cached heights and checksums, rays, grid queries, paths against flat A*,
+// edited seams, growth over the walk, packed skinning palettes) run along the way; the exit
+// code is 1 if any of them fails.
+//
+// The edits and the walk run through a real ChunkManager, so bgfx is initialized with the
+// Noop renderer; nothing else touches the GPU and no window is opened.
+//
+//   worldgen_bench [--size N] [--threads T] [--rays R] [--walk-minutes M] [--anim-assets dir]
+//                  [--json path] [--verbose]
+
+#include "terrain.h"
+#include "terrain_kernel.h"
+#include "height_tile_cache.h"
+#include "pathfinding.h"
+#include "spatial_grid.h"
+#include "thread_pool.h"
+#include "ozz_animation.h"
+#include "animation_stage.h"
+#include "skin_palette.h"
+#include <bgfx/bgfx.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Options {
+    int size = 9;             // Chunks per side of the generated region
+    int threads = 0;          // Worker threads, 0 = ThreadPool default
+    int rays = 5000;          // Rays for the pyramid vs brute force comparison
+    float walkMinutes = 30.0f;
+    std::string animAssets = "build/assets";  // Where skeleton.ozz and the NPC clips live
+    std::string jsonPath;
+    bool verbose = false;
+};
+
+// Minimal writer for nested objects of numbers, number arrays and strings
+class JsonWriter {
+public:
+    void beginObject(const char* key = nullptr) {
+        writeKey(key);
+        out << "{";
+        firstInScope.push_back(true);
+    }
+    void endObject() {
+        firstInScope.pop_back();
+        out << "\n" << std::string(firstInScope.size() * 2, ' ') << "}";
+    }
+    void value(const char* key, double number) {
+        writeKey(key);
+        writeNumber(number);
+    }
+    void value(const char* key, const std::string& text) {
+        writeKey(key);
+        out << "\"" << text << "\"";
+    }
+    void values(const char* key, const std::vector<double>& numbers) {
+        writeKey(key);
+        out << "[";
+        for (size_t i = 0; i < numbers.size(); i++) {
+            out << (i ? ", " : "");
+            writeNumber(numbers[i]);
+        }
+        out << "]";
+    }
+    std::string str() const { return out.str() + "\n"; }
+
+private:
+    void writeKey(const char* key) {
+        if (firstInScope.empty()) return;
+        out << (firstInScope.back() ? "\n" : ",\n") << std::string(firstInScope.size() * 2, ' ');
+        firstInScope.back() = false;
+        if (key) out << "\"" << key << "\": ";
+    }
+    void writeNumber(double number) {
+        if (std::isfinite(number)) {
+            out << number;
+        } else {
+            out << "null";
+        }
+    }
+
+    std::ostringstream out;
+    std::vector<bool> firstInScope;
+};
+
+// Correctness checks made alongside the timings. Each result is written into its section
+// of the report and into the closing "checks" summary; any failure makes the bench exit
+// non-zero, so a regression can't hide behind a number nobody reads.
+class Checks {
+public:
+    bool expect(JsonWriter& json, const char* section, const char* name, bool passed) {
+        json.value(name, std::string(passed ? "pass" : "fail"));
+        results.push_back({std::string(section) + "." + name, passed});
+        return passed;
+    }
+    int getFailureCount() const {
+        return (int)std::count_if(results.begin(), results.end(), [](const auto& result) { return !result.second; });
+    }
+    void write(JsonWriter& json) const {
+        json.beginObject("checks");
+        for (const auto& [name, passed] : results) {
+            json.value(name.c_str(), std::string(passed ? "pass" : "fail"));
+        }
+        json.value("failed", getFailureCount());
+        json.endObject();
+    }
+    void printFailures(std::ostream& out) const {
+        for (const auto& [name, passed] : results) {
+            if (!passed) out << "Check failed: " << name << std::endl;
+        }
+    }
+
+private:
+    std::vector<std::pair<std::string, bool>> results;
+};
+
+// Swallows the per-chunk logging while timing
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+double getPeakRssKilobytes() {
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024.0;  // Bytes on macOS
+#else
+    return (double)usage.ru_maxrss;   // Kilobytes on Linux
+#endif
+}
+
+// Resident set size now, unlike the peak, so growth over a long run shows up
+double getCurrentRssKilobytes() {
+#ifdef __APPLE__
+    mach_task_basic_info info = {};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) return 0.0;
+    return info.resident_size / 1024.0;
+#else
+    // Second field of statm is resident pages
+    std::ifstream statm("/proc/self/statm");
+    long totalPages = 0, residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) return 0.0;
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024.0);
+#endif
+}
+
+constexpr float CHUNK_WORLD_SIZE = TerrainChunk::CHUNK_SIZE * TerrainChunk::SCALE;
+constexpr float ADAPTIVE_MAX_ERROR = 0.05f;  // World units, the in-game default
+constexpr double RAY_T_EPSILON = 1e-3;       // Ray hits against exact triangles or heights
+constexpr double WALK_GROWTH_TOLERANCE = 0.1;  // Last minute of the walk over the first
+
+// The generated region, kept for the query benchmarks
+struct Region {
+    int minChunk = 0;
+    int size = 0;
+    std::vector<std::unique_ptr<TerrainChunk>> chunks;
+    std::unordered_map<uint64_t, const TerrainChunk*> byKey;
+
+    float getMinWorld() const { return minChunk * CHUNK_WORLD_SIZE; }
+    float getWorldSize() const { return size * CHUNK_WORLD_SIZE; }
+    const TerrainChunk* find(float worldX, float worldZ) const {
+        int chunkX = (int)std::floor(worldX / CHUNK_WORLD_SIZE);
+        int chunkZ = (int)std::floor(worldZ / CHUNK_WORLD_SIZE);
+        auto found = byKey.find(ChunkManager::getChunkKey(chunkX, chunkZ));
+        return found != byKey.end() ? found->second : nullptr;
+    }
+};
+
+// Everything a chunk build hands to the rest of the game, compared bit for bit
+bool chunksMatch(const TerrainChunk& a, const TerrainChunk& b) {
+    auto sameResource = [](const ResourceSpawn& first, const ResourceSpawn& second) {
+        return first.x == second.x && first.y == second.y && first.z == second.z && first.type == second.type &&
+               first.health == second.health && first.isActive == second.isActive;
+    };
+    auto sameNPC = [](const NPCSpawn& first, const NPCSpawn& second) {
+        return first.x == second.x && first.y == second.y && first.z == second.z && first.type == second.type &&
+               first.health == second.health && first.isActive == second.isActive;
+    };
+    return a.chunkX == b.chunkX && a.chunkZ == b.chunkZ && a.biome == b.biome &&
+           a.heightTile.samples == b.heightTile.samples && a.heightTile.minHeight == b.heightTile.minHeight &&
+           a.heightTile.heightScale == b.heightTile.heightScale && a.walkCosts == b.walkCosts &&
+           a.hasWater == b.hasWater &&
+           std::equal(a.resourceSpawns.begin(), a.resourceSpawns.end(), b.resourceSpawns.begin(),
+                      b.resourceSpawns.end(), sameResource) &&
+           std::equal(a.npcSpawns.begin(), a.npcSpawns.end(), b.npcSpawns.begin(), b.npcSpawns.end(), sameNPC);
+}
+
+void benchGeneration(const Options& options, Region& region, JsonWriter& json, Checks& checks) {
+    struct BiomeTotals {
+        int chunks = 0;
+        double milliseconds = 0.0;
+        double indexMilliseconds = 0.0;
+        double adaptiveTriangles = 0.0;
+    };
+    BiomeTotals biomes[BIOME_COUNT];
+    TerrainChunk::GenerationTimings stages;
+    double buildMilliseconds = 0.0;
+    double indexMilliseconds = 0.0;
+    size_t vertexCount = 0;
+    size_t resourceSpawns = 0;
+    size_t npcSpawns = 0;
+
+    region.size = options.size;
+    region.minChunk = -options.size / 2;
+    for (int z = region.minChunk; z < region.minChunk + region.size; z++) {
+        for (int x = region.minChunk; x < region.minChunk + region.size; x++) {
+            std::unique_ptr<TerrainChunk> chunk = ChunkManager::buildChunk(x, z);
+            buildMilliseconds += chunk->buildMilliseconds;
+            stages.heightMilliseconds += chunk->generationTimings.heightMilliseconds;
+            stages.derivedMilliseconds += chunk->generationTimings.derivedMilliseconds;
+            stages.errorMilliseconds += chunk->generationTimings.errorMilliseconds;
+            stages.waterMilliseconds += chunk->generationTimings.waterMilliseconds;
+            stages.validationMilliseconds += chunk->generationTimings.validationMilliseconds;
+            vertexCount += chunk->vertices.size();
+            resourceSpawns += chunk->resourceSpawns.size();
+            npcSpawns += chunk->npcSpawns.size();
+
+            // Indices are built at draw time, but cost the same per chunk
+            auto indexStart = Clock::now();
+            std::vector<uint16_t> indices = chunk->generateAdaptiveIndices(ADAPTIVE_MAX_ERROR);
+            double chunkIndexMilliseconds = millisecondsSince(indexStart);
+            indexMilliseconds += chunkIndexMilliseconds;
+
+            BiomeTotals& biome = biomes[(int)chunk->biome];
+            biome.chunks++;
+            biome.milliseconds += chunk->buildMilliseconds;
+            biome.indexMilliseconds += chunkIndexMilliseconds;
+            biome.adaptiveTriangles += indices.size() / 3;
+
+            // Only the height data is needed from here on
+            std::vector<TerrainVertex>().swap(chunk->vertices);
+            region.byKey[ChunkManager::getChunkKey(x, z)] = chunk.get();
+            region.chunks.push_back(std::move(chunk));
+        }
+    }
+
+    const double chunkCount = (double)region.chunks.size();
+    json.beginObject("generation");
+    json.value("chunks", chunkCount);
+    json.value("msPerChunk", buildMilliseconds / chunkCount);
+    json.value("verticesPerSecond", vertexCount / (buildMilliseconds / 1000.0));
+    json.beginObject("stageMsPerChunk");
+    json.value("height", stages.heightMilliseconds / chunkCount);
+    json.value("derived", stages.derivedMilliseconds / chunkCount);
+    json.value("errors", stages.errorMilliseconds / chunkCount);
+    json.value("indices", indexMilliseconds / chunkCount);
+    json.value("water", stages.waterMilliseconds / chunkCount);
+    json.value("validation", stages.validationMilliseconds / chunkCount);
+    json.endObject();
+    json.beginObject("spawns");
+    json.value("resources", (double)resourceSpawns);
+    json.value("npcs", (double)npcSpawns);
+    json.endObject();
+
+    // Adaptive mesh size against the full-resolution grid, per biome
+    json.beginObject("biomes");
+    for (int b = 0; b < BIOME_COUNT; b++) {
+        if (biomes[b].chunks == 0) continue;
+        json.beginObject(ChunkManager::getBiomeName((BiomeType)b));
+        json.value("chunks", biomes[b].chunks);
+        json.value("msPerChunk", biomes[b].milliseconds / biomes[b].chunks);
+        json.value("adaptiveIndexMsPerChunk", biomes[b].indexMilliseconds / biomes[b].chunks);
+        json.value("adaptiveTriangles", biomes[b].adaptiveTriangles / biomes[b].chunks);
+        json.value("uniformTriangles", TerrainChunk::CHUNK_SIZE * TerrainChunk::CHUNK_SIZE * 2);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+
+    // Same region on the worker pool: serial vs parallel wall time, and every chunk built
+    // there must match the serial one exactly
+    ThreadPool pool(options.threads);
+    auto parallelStart = Clock::now();
+    std::vector<std::future<std::unique_ptr<TerrainChunk>>> results;
+    for (const auto& chunk : region.chunks) {
+        int x = chunk->chunkX, z = chunk->chunkZ;
+        results.push_back(pool.submit([x, z]() { return ChunkManager::buildChunk(x, z); }));
+    }
+    std::vector<std::unique_ptr<TerrainChunk>> parallelChunks;
+    for (auto& result : results) {
+        parallelChunks.push_back(result.get());
+    }
+    double parallelMilliseconds = millisecondsSince(parallelStart);
+    int mismatchedChunks = 0;
+    for (size_t i = 0; i < parallelChunks.size(); i++) {
+        if (!chunksMatch(*parallelChunks[i], *region.chunks[i])) mismatchedChunks++;
+    }
+
+    json.beginObject("parallel");
+    json.value("threads", (double)pool.getThreadCount());
+    json.value("serialMs", buildMilliseconds);
+    json.value("parallelMs", parallelMilliseconds);
+    json.value("speedup", buildMilliseconds / parallelMilliseconds);
+    json.value("mismatchedChunks", mismatchedChunks);
+    checks.expect(json, "parallel", "matchesSerial", mismatchedChunks == 0);
+    json.endObject();
+}
+
+// REFERENCE is the per-vertex bx::sin/cos code the kernel replaced, so its rate is the
+// "before" number and the batched paths are "after"
+void benchKernel(const Region& region, JsonWriter& json, Checks& checks) {
+    const int gridSize = TerrainChunk::CHUNK_SIZE + 1;
+    const TerrainKernel::Path paths[] = {TerrainKernel::Path::REFERENCE, TerrainKernel::Path::SCALAR,
+                                         TerrainKernel::Path::GENERIC, TerrainKernel::Path::SIMD};
+    const char* names[] = {"reference", "scalar", "generic", "simd"};
+    constexpr int PATH_COUNT = 4;
+    std::vector<std::vector<float>> heights(PATH_COUNT);
+    double verticesPerSecond[PATH_COUNT] = {};
+
+    for (int p = 0; p < PATH_COUNT; p++) {
+        heights[p].resize(region.chunks.size() * gridSize * gridSize);
+        auto start = Clock::now();
+        for (size_t i = 0; i < region.chunks.size(); i++) {
+            const TerrainChunk& chunk = *region.chunks[i];
+            TerrainKernel::generateHeights(chunk.chunkX * TerrainChunk::CHUNK_SIZE, chunk.chunkZ * TerrainChunk::CHUNK_SIZE,
+                                           gridSize, TerrainChunk::SCALE, &heights[p][i * gridSize * gridSize], paths[p]);
+        }
+        verticesPerSecond[p] = heights[p].size() / (millisecondsSince(start) / 1000.0);
+    }
+
+    // Batched paths against the reference, away from the ocean mask step
+    double maxError[PATH_COUNT] = {};
+    for (size_t i = 0; i < region.chunks.size(); i++) {
+        const TerrainChunk& chunk = *region.chunks[i];
+        for (int z = 0; z < gridSize; z++) {
+            for (int x = 0; x < gridSize; x++) {
+                float worldX = (chunk.chunkX * TerrainChunk::CHUNK_SIZE + x) * TerrainChunk::SCALE;
+                float worldZ = (chunk.chunkZ * TerrainChunk::CHUNK_SIZE + z) * TerrainChunk::SCALE;
+                if (TerrainKernel::isOceanEdge(worldX, worldZ)) continue;
+                size_t index = i * gridSize * gridSize + z * gridSize + x;
+                for (int p = 1; p < PATH_COUNT; p++) {
+                    maxError[p] = std::max(maxError[p], (double)std::fabs(heights[p][index] - heights[0][index]));
+                }
+            }
+        }
+    }
+
+    json.beginObject("kernel");
+    json.value("simd", std::string(TerrainKernel::getSimdName()));
+    json.beginObject("verticesPerSecond");
+    for (int p = 0; p < PATH_COUNT; p++) {
+        json.value(names[p], verticesPerSecond[p]);
+    }
+    json.endObject();
+    json.value("maxErrorScalar", maxError[1]);
+    json.value("maxErrorGeneric", maxError[2]);
+    json.value("maxErrorSimd", maxError[3]);
+    json.value("maxErrorAllowed", TerrainKernel::kMaxHeightError);
+    checks.expect(json, "kernel", "scalarWithinEpsilon", maxError[1] <= TerrainKernel::kMaxHeightError);
+    checks.expect(json, "kernel", "genericWithinEpsilon", maxError[2] <= TerrainKernel::kMaxHeightError);
+    checks.expect(json, "kernel", "simdWithinEpsilon", maxError[3] <= TerrainKernel::kMaxHeightError);
+    json.endObject();
+}
+
+// Name of the specialized kernel classifyRegion picks for a region
+std::string getRegionClassName(const TerrainKernel::RegionClass& region) {
+    if (region.ocean == TerrainKernel::OceanCoverage::FULL) return "ocean";
+    if (region.ocean == TerrainKernel::OceanCoverage::PARTIAL) return "coast";
+    int biomeCount = 0;
+    int lastBiome = 0;
+    for (int biome = 0; biome < BIOME_COUNT; biome++) {
+        if (region.biomeMask & (1 << biome)) {
+            biomeCount++;
+            lastBiome = biome;
+        }
+    }
+    if (biomeCount > 1) return "blend" + std::to_string(biomeCount);
+    std::string name = ChunkManager::getBiomeName((BiomeType)lastBiome);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return name;
+}
+
+// Specialized (SIMD) against generic kernel for each kind of region. The generated
+// region rarely covers them all, so chunks are sampled on a coarse grid across the world.
+void benchKernelSpecializations(JsonWriter& json, Checks& checks) {
+    constexpr int SAMPLES_PER_CLASS = 16;
+    constexpr int SAMPLE_STEP = 7;       // Chunks between samples
+    constexpr int SAMPLE_EXTENT = 420;   // Chunks each side of the origin
+    constexpr int REPEATS = 4;
+    const int gridSize = TerrainChunk::CHUNK_SIZE + 1;
+
+    std::map<std::string, std::vector<std::pair<int, int>>> samples;
+    std::map<std::string, int> classCounts;
+    int sampledChunks = 0;
+    for (int chunkZ = -SAMPLE_EXTENT; chunkZ <= SAMPLE_EXTENT; chunkZ += SAMPLE_STEP) {
+        for (int chunkX = -SAMPLE_EXTENT; chunkX <= SAMPLE_EXTENT; chunkX += SAMPLE_STEP) {
+            TerrainKernel::RegionClass region = TerrainKernel::classifyRegion(
+                chunkX * TerrainChunk::CHUNK_SIZE, chunkZ * TerrainChunk::CHUNK_SIZE, gridSize, TerrainChunk::SCALE);
+            std::string name = getRegionClassName(region);
+            classCounts[name]++;
+            auto& chunks = samples[name];
+            if (chunks.size() < SAMPLES_PER_CLASS) chunks.push_back({chunkX, chunkZ});
+            sampledChunks++;
+        }
+    }
+
+    std::vector<float> generic(gridSize * gridSize), specialized(gridSize * gridSize);
+    auto timePath = [&](const std::vector<std::pair<int, int>>& chunks, TerrainKernel::Path path, std::vector<float>& out) {
+        auto start = Clock::now();
+        for (int repeat = 0; repeat < REPEATS; repeat++) {
+            for (const auto& [chunkX, chunkZ] : chunks) {
+                TerrainKernel::generateHeights(chunkX * TerrainChunk::CHUNK_SIZE, chunkZ * TerrainChunk::CHUNK_SIZE,
+                                               gridSize, TerrainChunk::SCALE, out.data(), path);
+            }
+        }
+        return (double)chunks.size() * REPEATS * gridSize * gridSize / (millisecondsSince(start) / 1000.0);
+    };
+
+    json.beginObject("kernelSpecializations");
+    json.value("sampledChunks", sampledChunks);
+    for (const auto& [name, chunks] : samples) {
+        double genericRate = timePath(chunks, TerrainKernel::Path::GENERIC, generic);
+        double specializedRate = timePath(chunks, TerrainKernel::Path::SIMD, specialized);
+
+        double maxError = 0.0;
+        for (const auto& [chunkX, chunkZ] : chunks) {
+            TerrainKernel::generateHeights(chunkX * TerrainChunk::CHUNK_SIZE, chunkZ * TerrainChunk::CHUNK_SIZE,
+                                           gridSize, TerrainChunk::SCALE, generic.data(), TerrainKernel::Path::GENERIC);
+            TerrainKernel::generateHeights(chunkX * TerrainChunk::CHUNK_SIZE, chunkZ * TerrainChunk::CHUNK_SIZE,
+                                           gridSize, TerrainChunk::SCALE, specialized.data(), TerrainKernel::Path::SIMD);
+            for (int i = 0; i < gridSize * gridSize; i++) {
+                float worldX = (chunkX * TerrainChunk::CHUNK_SIZE + i % gridSize) * TerrainChunk::SCALE;
+                float worldZ = (chunkZ * TerrainChunk::CHUNK_SIZE + i / gridSize) * TerrainChunk::SCALE;
+                if (TerrainKernel::isOceanEdge(worldX, worldZ)) continue;
+                maxError = std::max(maxError, (double)std::fabs(specialized[i] - generic[i]));
+            }
+        }
+
+        json.beginObject(name.c_str());
+        json.value("share", classCounts[name] / (double)sampledChunks);
+        json.value("genericVerticesPerSecond", genericRate);
+        json.value("specializedVerticesPerSecond", specializedRate);
+        json.value("speedup", specializedRate / genericRate);
+        json.value("maxErrorVsGeneric", maxError);
+        // Both are within kMaxHeightError of the reference, so of each other within twice that
+        checks.expect(json, ("kernelSpecializations." + name).c_str(), "withinEpsilon",
+                      maxError <= 2.0 * TerrainKernel::kMaxHeightError);
+        json.endObject();
+    }
+    json.endObject();
+}
+
+// True if the cache refuses a stored record once one byte of it is flipped on disk
+bool cacheRejectsFlippedByte(const TerrainChunk& chunk, const std::filesystem::path& directory) {
+    std::vector<uint8_t> record;
+    chunk.writeCacheRecord(record);
+    const uint64_t key = ChunkManager::getChunkKey(chunk.chunkX, chunk.chunkZ);
+    {
+        ChunkCache cache(directory.string(), TerrainChunk::CACHE_VERSION);
+        if (!cache.write(chunk.chunkX, chunk.chunkZ, key, record)) return false;
+    }
+
+    // The directory holds just this chunk's region file; find the record in it and damage
+    // a byte in the middle
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        auto found = std::search(bytes.begin(), bytes.end(), record.begin(), record.end());
+        if (found == bytes.end()) continue;
+        size_t offset = (size_t)(found - bytes.begin()) + record.size() / 2;
+        file.clear();
+        file.seekp((std::streamoff)offset);
+        file.put((char)(bytes[offset] ^ 0x01));
+    }
+
+    ChunkCache cache(directory.string(), TerrainChunk::CACHE_VERSION);
+    std::vector<uint8_t> readBack;
+    return !cache.read(chunk.chunkX, chunk.chunkZ, key, readBack) && cache.getStats().rejected == 1;
+}
+
+void benchCache(const Region& region, const std::filesystem::path& scratch, JsonWriter& json, Checks& checks) {
+    ChunkCache cache((scratch / "cache").string(), TerrainChunk::CACHE_VERSION);
+    double coldMilliseconds = 0.0, warmMilliseconds = 0.0, writeMilliseconds = 0.0;
+    int warmHits = 0, mismatchedChunks = 0;
+
+    // Cold: nothing cached, generate and store like ChunkManager::saveChunk
+    std::vector<uint8_t> record;
+    for (const auto& existing : region.chunks) {
+        std::unique_ptr<TerrainChunk> chunk = ChunkManager::buildChunk(existing->chunkX, existing->chunkZ, &cache);
+        coldMilliseconds += chunk->buildMilliseconds;
+        auto writeStart = Clock::now();
+        chunk->writeCacheRecord(record);
+        cache.write(chunk->chunkX, chunk->chunkZ, ChunkManager::getChunkKey(chunk->chunkX, chunk->chunkZ), record);
+        writeMilliseconds += millisecondsSince(writeStart);
+    }
+
+    // Warm: every chunk comes back from its record, with the heights it was generated with
+    for (const auto& existing : region.chunks) {
+        std::unique_ptr<TerrainChunk> chunk = ChunkManager::buildChunk(existing->chunkX, existing->chunkZ, &cache);
+        warmMilliseconds += chunk->buildMilliseconds;
+        if (chunk->loadedFromCache) warmHits++;
+        bool matches = true;
+        for (int z = 0; z <= TerrainChunk::CHUNK_SIZE && matches; z++) {
+            for (int x = 0; x <= TerrainChunk::CHUNK_SIZE && matches; x++) {
+                matches = chunk->getVertexHeight(x, z) == existing->getVertexHeight(x, z);
+            }
+        }
+        if (!matches) mismatchedChunks++;
+    }
+
+    const double chunkCount = (double)region.chunks.size();
+    json.beginObject("cache");
+    json.value("coldMsPerChunk", coldMilliseconds / chunkCount);
+    json.value("warmMsPerChunk", warmMilliseconds / chunkCount);
+    json.value("writeMsPerChunk", writeMilliseconds / chunkCount);
+    json.value("warmHitRate", warmHits / chunkCount);
+    checks.expect(json, "cache", "warmHeightsMatch", mismatchedChunks == 0);
+    checks.expect(json, "cache", "rejectsFlippedByte", cacheRejectsFlippedByte(*region.chunks.front(), scratch / "corrupt"));
+    json.endObject();
+}
+
+void benchHeightQueries(const Region& region, JsonWriter& json) {
+    const int queryCount = 200000;
+    std::mt19937 random(1);
+    // Kept just inside the far edge so every point has a chunk
+    std::uniform_real_distribution<float> coordinate(region.getMinWorld(), region.getMinWorld() + region.getWorldSize() - 0.01f);
+    std::vector<float> points(queryCount * 2);
+    for (float& value : points) {
+        value = coordinate(random);
+    }
+
+    // Loaded chunk heights (the in-game path) are the ground truth
+    std::vector<float> exact(queryCount);
+    auto exactStart = Clock::now();
+    for (int i = 0; i < queryCount; i++) {
+        exact[i] = region.find(points[i * 2], points[i * 2 + 1])->getHeightAt(points[i * 2], points[i * 2 + 1]);
+    }
+    double exactMilliseconds = millisecondsSince(exactStart);
+
+    // The coarse fallback for unloaded positions: first pass builds tiles, second reuses them
+    HeightTileCache fallback(TerrainChunk::SCALE);
+    double fallbackMilliseconds[2] = {};
+    double errorSum = 0.0, maxError = 0.0;
+    for (int pass = 0; pass < 2; pass++) {
+        auto start = Clock::now();
+        for (int i = 0; i < queryCount; i++) {
+            float height = fallback.getHeightAt(points[i * 2], points[i * 2 + 1]);
+            if (pass == 1) {
+                double error = std::fabs(height - exact[i]);
+                errorSum += error;
+                maxError = std::max(maxError, error);
+            }
+        }
+        fallbackMilliseconds[pass] = millisecondsSince(start);
+    }
+    HeightTileCache::Stats stats = fallback.getStats();
+
+    json.beginObject("heightQueries");
+    json.value("queries", queryCount);
+    json.value("loadedNsPerQuery", exactMilliseconds * 1e6 / queryCount);
+    json.value("fallbackColdNsPerQuery", fallbackMilliseconds[0] * 1e6 / queryCount);
+    json.value("fallbackWarmNsPerQuery", fallbackMilliseconds[1] * 1e6 / queryCount);
+    json.value("fallbackMeanError", errorSum / queryCount);
+    json.value("fallbackMaxError", maxError);
+    json.value("tiles", (double)stats.tiles);
+    json.value("tileHits", (double)stats.hits);
+    json.value("tileMisses", (double)stats.misses);
+    json.endObject();
+}
+
+// Height queries through a hashed chunk lookup (ChunkManager::loadedChunks used to be an
+// unordered_map) against ChunkGrid, which getHeightAt goes through now, last-hit path
+// included. The same points are used scattered at random and as short coherent walks, the
+// way the player and NPCs query. Chunks are lent to the grid and handed back afterwards.
+void benchChunkLookup(Region& region, JsonWriter& json, Checks& checks) {
+    constexpr int QUERY_COUNT = 200000;
+    constexpr int WALK_STEPS = 100;
+    constexpr float WALK_STEP = 0.25f;  // About a frame of NPC movement
+    const int windowChunks = std::min(region.size, ChunkGrid::WINDOW_SIZE);
+    const float minWorld = region.getMinWorld();
+    const float maxWorld = minWorld + windowChunks * CHUNK_WORLD_SIZE - 0.01f;
+
+    ChunkGrid grid;
+    std::vector<std::pair<size_t, std::pair<int, int>>> lent;  // Region index and chunk coordinates
+    for (size_t i = 0; i < region.chunks.size(); i++) {
+        int chunkX = region.chunks[i]->chunkX, chunkZ = region.chunks[i]->chunkZ;
+        if (chunkX - region.minChunk >= windowChunks || chunkZ - region.minChunk >= windowChunks) continue;
+        grid.insert(std::move(region.chunks[i]));
+        lent.push_back({i, {chunkX, chunkZ}});
+    }
+
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> coordinate(minWorld, maxWorld);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::vector<float> scattered(QUERY_COUNT * 2), walks(QUERY_COUNT * 2);
+    for (float& value : scattered) {
+        value = coordinate(random);
+    }
+    for (int i = 0; i < QUERY_COUNT; i += WALK_STEPS) {
+        float x = coordinate(random), z = coordinate(random), heading = angle(random);
+        for (int step = i; step < std::min(i + WALK_STEPS, QUERY_COUNT); step++) {
+            x = std::clamp(x + std::cos(heading) * WALK_STEP, minWorld, maxWorld);
+            z = std::clamp(z + std::sin(heading) * WALK_STEP, minWorld, maxWorld);
+            walks[step * 2] = x;
+            walks[step * 2 + 1] = z;
+        }
+    }
+
+    // Region::byKey still points at the lent chunks, which never move
+    auto findHashed = [&region](int chunkX, int chunkZ) -> const TerrainChunk* {
+        auto found = region.byKey.find(ChunkManager::getChunkKey(chunkX, chunkZ));
+        return found != region.byKey.end() ? found->second : nullptr;
+    };
+    auto findInGrid = [&grid](int chunkX, int chunkZ) -> const TerrainChunk* { return grid.find(chunkX, chunkZ); };
+    auto timeQueries = [](const std::vector<float>& points, auto&& find, std::vector<float>& heights) {
+        auto start = Clock::now();
+        for (int i = 0; i < QUERY_COUNT; i++) {
+            float x = points[i * 2], z = points[i * 2 + 1];
+            const TerrainChunk* chunk = find((int)std::floor(x / CHUNK_WORLD_SIZE), (int)std::floor(z / CHUNK_WORLD_SIZE));
+            heights[i] = chunk ? chunk->getHeightAt(x, z) : -1e9f;
+        }
+        return QUERY_COUNT / (millisecondsSince(start) / 1000.0);
+    };
+
+    json.beginObject("chunkLookup");
+    json.value("queries", QUERY_COUNT);
+    json.value("chunks", (double)lent.size());
+    std::vector<float> hashedHeights(QUERY_COUNT), gridHeights(QUERY_COUNT);
+    for (const auto& [name, points] : {std::make_pair("scattered", &scattered), std::make_pair("coherent", &walks)}) {
+        double hashedRate = timeQueries(*points, findHashed, hashedHeights);
+        double gridRate = timeQueries(*points, findInGrid, gridHeights);
+        json.beginObject(name);
+        json.value("hashedQueriesPerSecond", hashedRate);
+        json.value("gridQueriesPerSecond", gridRate);
+        json.value("speedup", gridRate / hashedRate);
+        checks.expect(json, (std::string("chunkLookup.") + name).c_str(), "heightsMatch", hashedHeights == gridHeights);
+        json.endObject();
+    }
+    json.endObject();
+
+    for (const auto& [index, coordinates] : lent) {
+        region.chunks[index] = grid.remove(coordinates.first, coordinates.second);
+    }
+}
+
+// Moller-Trumbore, two-sided
+bool intersectTriangle(const bx::Vec3& origin, const bx::Vec3& direction, const bx::Vec3& a, const bx::Vec3& b,
+                       const bx::Vec3& c, float& t) {
+    bx::Vec3 e1 = bx::sub(b, a);
+    bx::Vec3 e2 = bx::sub(c, a);
+    bx::Vec3 p = bx::cross(direction, e2);
+    float det = bx::dot(e1, p);
+    if (std::fabs(det) < 1e-12f) return false;
+    float invDet = 1.0f / det;
+    bx::Vec3 s = bx::sub(origin, a);
+    float u = bx::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+    bx::Vec3 q = bx::cross(s, e1);
+    float v = bx::dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    t = bx::dot(e2, q) * invDet;
+    return true;
+}
+
+// Every full-resolution triangle of the chunk (5 units down), same split as the uniform mesh;
+// what TerrainChunk::raycast hits, not the LOD/RTIN mesh that is drawn
+bool bruteForceRaycast(const TerrainChunk& chunk, const bx::Vec3& origin, const bx::Vec3& direction, float tMax, float& tHit) {
+    const int gridSize = TerrainChunk::CHUNK_SIZE + 1;
+    auto vertex = [&chunk, gridSize](int x, int z) {
+        return bx::Vec3{chunk.chunkX * CHUNK_WORLD_SIZE + x * TerrainChunk::SCALE,
+                        chunk.heightTile.getHeight(z * gridSize + x) - 5.0f,
+                        chunk.chunkZ * CHUNK_WORLD_SIZE + z * TerrainChunk::SCALE};
+    };
+    bool hit = false;
+    tHit = tMax;
+    for (int z = 0; z < TerrainChunk::CHUNK_SIZE; z++) {
+        for (int x = 0; x < TerrainChunk::CHUNK_SIZE; x++) {
+            bx::Vec3 topLeft = vertex(x, z), topRight = vertex(x + 1, z);
+            bx::Vec3 bottomLeft = vertex(x, z + 1), bottomRight = vertex(x + 1, z + 1);
+            float t;
+            if (intersectTriangle(origin, direction, topLeft, bottomLeft, topRight, t) && t >= 0.0f && t <= tHit) {
+                tHit = t;
+                hit = true;
+            }
+            if (intersectTriangle(origin, direction, topRight, bottomLeft, bottomRight, t) && t >= 0.0f && t <= tHit) {
+                tHit = t;
+                hit = true;
+            }
+        }
+    }
+    return hit;
+}
+
+void benchRaycast(const Options& options, const Region& region, JsonWriter& json, Checks& checks) {
+    std::mt19937 random(2);
+    std::uniform_int_distribution<size_t> pickChunk(0, region.chunks.size() - 1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float maxDistance = 200.0f;
+
+    int hits = 0, mismatches = 0;
+    double maxTError = 0.0, pyramidMilliseconds = 0.0, bruteMilliseconds = 0.0;
+    for (int i = 0; i < options.rays; i++) {
+        const TerrainChunk& chunk = *region.chunks[pickChunk(random)];
+        bx::Vec3 origin = {(chunk.chunkX + unit(random)) * CHUNK_WORLD_SIZE, 20.0f + unit(random) * 20.0f,
+                           (chunk.chunkZ + unit(random)) * CHUNK_WORLD_SIZE};
+
+        // Mostly camera-like rays, with some straight down and some grazing ones
+        bx::Vec3 direction = {0.0f, -1.0f, 0.0f};
+        if (i % 10 != 0) {
+            float angle = unit(random) * 6.2831853f;
+            float down = i % 10 == 1 ? 0.02f + unit(random) * 0.05f : 0.2f + unit(random);
+            direction = bx::normalize(bx::Vec3{std::cos(angle), -down, std::sin(angle)});
+        }
+
+        float pyramidT = 0.0f, bruteT = 0.0f;
+        auto pyramidStart = Clock::now();
+        bool pyramidHit = chunk.raycast(origin, direction, 0.0f, maxDistance, pyramidT);
+        pyramidMilliseconds += millisecondsSince(pyramidStart);
+        auto bruteStart = Clock::now();
+        bool bruteHit = bruteForceRaycast(chunk, origin, direction, maxDistance, bruteT);
+        bruteMilliseconds += millisecondsSince(bruteStart);
+
+        if (pyramidHit != bruteHit) {
+            mismatches++;
+        } else if (pyramidHit) {
+            hits++;
+            maxTError = std::max(maxTError, (double)std::fabs(pyramidT - bruteT));
+        }
+    }
+
+    json.beginObject("raycast");
+    json.value("rays", options.rays);
+    json.value("hits", hits);
+    json.value("hitMismatches", mismatches);
+    json.value("maxTError", maxTError);
+    json.value("pyramidUsPerRay", pyramidMilliseconds * 1000.0 / options.rays);
+    json.value("bruteForceUsPerRay", bruteMilliseconds * 1000.0 / options.rays);
+    checks.expect(json, "raycast", "hitsMatch", mismatches == 0);
+    checks.expect(json, "raycast", "tWithinEpsilon", maxTError <= RAY_T_EPSILON);
+    json.endObject();
+}
+
+// Radius queries (aggro, mining) and ray picks (click, hover) through the grid against a
+// linear scan, for growing crowds. Entities keep the density of 2000 over the generated
+// region, so more of them means more world, as it does when streaming; per-query grid cost
+// should stay flat while the scans grow with the count.
+void benchSpatialGrid(const Region& region, JsonWriter& json, Checks& checks) {
+    struct Entity {
+        float x, z;
+    };
+    struct Ray {
+        float x, z, directionX, directionZ;
+    };
+    const int queryCount = 5000;
+    const float radius = 12.0f;         // NPC::MAX_AGGRO_RANGE
+    const float pickDistance = 200.0f;  // PICK_DISTANCE in main.cpp
+    const float pickRadius = 1.2f;      // An NPC's pick sphere, size * 1.5
+    const float density = 2000.0f / (region.getWorldSize() * region.getWorldSize());
+
+    // Horizontal distance along the ray to the entity's pick circle, -1 for a miss
+    auto hitDistance = [pickRadius](const Ray& ray, const Entity& entity) {
+        float toX = entity.x - ray.x, toZ = entity.z - ray.z;
+        float along = toX * ray.directionX + toZ * ray.directionZ;
+        float offAxis = toX * toX + toZ * toZ - along * along;
+        if (toX * toX + toZ * toZ <= pickRadius * pickRadius) return 0.0f;
+        if (along < 0.0f || offAxis > pickRadius * pickRadius) return -1.0f;
+        return along - std::sqrt(pickRadius * pickRadius - offAxis);
+    };
+
+    json.beginObject("spatialGrid");
+    for (int entityCount : {1000, 10000, 50000}) {
+        const float side = std::sqrt(entityCount / density);
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> coordinate(region.getMinWorld(), region.getMinWorld() + side);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+        std::vector<Entity> entities(entityCount);
+        SpatialGrid<Entity> grid;
+        for (Entity& entity : entities) {
+            entity = {coordinate(random), coordinate(random)};
+            grid.insert(&entity, entity.x, entity.z);
+        }
+        std::vector<Entity> queries(queryCount);
+        std::vector<Ray> rays(queryCount);
+        for (int i = 0; i < queryCount; i++) {
+            queries[i] = {coordinate(random), coordinate(random)};
+            float heading = angle(random);
+            rays[i] = {coordinate(random), coordinate(random), std::cos(heading), std::sin(heading)};
+        }
+
+        size_t linearFound = 0, gridFound = 0;
+        auto linearStart = Clock::now();
+        for (const Entity& query : queries) {
+            for (const Entity& entity : entities) {
+                float dx = entity.x - query.x, dz = entity.z - query.z;
+                if (dx * dx + dz * dz <= radius * radius) linearFound++;
+            }
+        }
+        double linearMilliseconds = millisecondsSince(linearStart);
+
+        auto gridStart = Clock::now();
+        for (const Entity& query : queries) {
+            grid.queryRadius(query.x, query.z, radius, [&](Entity* entity) {
+                float dx = entity->x - query.x, dz = entity->z - query.z;
+                if (dx * dx + dz * dz <= radius * radius) gridFound++;
+            });
+        }
+        double gridMilliseconds = millisecondsSince(gridStart);
+
+        // Nearest pick along each ray; both sides compute the same distances, so they must agree exactly
+        std::vector<float> linearHits(queryCount, -1.0f);
+        auto linearRayStart = Clock::now();
+        for (int i = 0; i < queryCount; i++) {
+            float nearest = pickDistance;
+            for (const Entity& entity : entities) {
+                float distance = hitDistance(rays[i], entity);
+                if (distance >= 0.0f && distance < nearest) {
+                    nearest = distance;
+                    linearHits[i] = distance;
+                }
+            }
+        }
+        double linearRayMilliseconds = millisecondsSince(linearRayStart);
+
+        int rayMismatches = 0;
+        auto gridRayStart = Clock::now();
+        for (int i = 0; i < queryCount; i++) {
+            const Ray& ray = rays[i];
+            Entity* hit = grid.raycast(ray.x, ray.z, ray.directionX, ray.directionZ, pickDistance,
+                                       [&](Entity* entity) { return hitDistance(ray, *entity); });
+            float distance = hit ? hitDistance(ray, *hit) : -1.0f;
+            if (distance != linearHits[i]) rayMismatches++;
+        }
+        double gridRayMilliseconds = millisecondsSince(gridRayStart);
+
+        std::string key = "entities" + std::to_string(entityCount);
+        json.beginObject(key.c_str());
+        json.value("worldSide", side);
+        json.value("linearUsPerQuery", linearMilliseconds * 1000.0 / queryCount);
+        json.value("gridUsPerQuery", gridMilliseconds * 1000.0 / queryCount);
+        json.value("linearUsPerRay", linearRayMilliseconds * 1000.0 / queryCount);
+        json.value("gridUsPerRay", gridRayMilliseconds * 1000.0 / queryCount);
+        json.value("rayMismatches", rayMismatches);
+        checks.expect(json, ("spatialGrid." + key).c_str(), "resultsMatch", linearFound == gridFound);
+        checks.expect(json, ("spatialGrid." + key).c_str(), "raysMatch", rayMismatches == 0);
+        json.endObject();
+    }
+    json.endObject();
+}
+
+// The region's walk cells as one flat grid, row-major from its minimum corner
+struct FlatWalkGrid {
+    int originCell = 0;  // Global cell index of column/row 0 on both axes
+    int side = 0;
+    std::vector<uint8_t> costs;
+
+    explicit FlatWalkGrid(const Region& region)
+        : originCell(region.minChunk * PathFinder::WALK_CELLS), side(region.size * PathFinder::WALK_CELLS),
+          costs((size_t)side * side, PathFinder::BLOCKED) {
+        for (const auto& chunk : region.chunks) {
+            int cornerX = chunk->chunkX * PathFinder::WALK_CELLS - originCell;
+            int cornerZ = chunk->chunkZ * PathFinder::WALK_CELLS - originCell;
+            for (int z = 0; z < PathFinder::WALK_CELLS; z++) {
+                std::copy_n(chunk->walkCosts.begin() + z * PathFinder::WALK_CELLS, PathFinder::WALK_CELLS,
+                            costs.begin() + (size_t)(cornerZ + z) * side + cornerX);
+            }
+        }
+    }
+
+    int getCell(float worldX, float worldZ) const {
+        int x = (int)std::floor(worldX / PathFinder::CELL_SIZE) - originCell;
+        int z = (int)std::floor(worldZ / PathFinder::CELL_SIZE) - originCell;
+        return z * side + x;
+    }
+};
+
+// Plain A* over the flat grid with PathFinder's step costs and corner rule, the reference
+// for the hierarchical search. Returns the length in world units of the cheapest path
+// between two walkable cells, or a negative value if there is none.
+float findFlatPathLength(const FlatWalkGrid& grid, int start, int goal) {
+    constexpr float DIAGONAL = 1.41421356f;
+    const int side = grid.side;
+    const uint8_t* costs = grid.costs.data();
+    auto heuristic = [side, goal](int cell) {
+        int dx = std::abs(cell % side - goal % side), dz = std::abs(cell / side - goal / side);
+        return (float)std::max(dx, dz) + (DIAGONAL - 1.0f) * std::min(dx, dz);
+    };
+
+    std::vector<float> distance(grid.costs.size(), std::numeric_limits<float>::infinity());
+    std::vector<float> length(grid.costs.size(), 0.0f);
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    distance[start] = 0.0f;
+    open.push({heuristic(start), start});
+    while (!open.empty()) {
+        auto [estimate, cell] = open.top();
+        open.pop();
+        if (cell == goal) return length[goal] * PathFinder::CELL_SIZE;
+        if (estimate > distance[cell] + heuristic(cell) + 1e-4f) continue;  // Stale entry
+
+        const int x = cell % side, z = cell / side;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                const int nx = x + dx, nz = z + dz;
+                if ((dx == 0 && dz == 0) || nx < 0 || nx >= side || nz < 0 || nz >= side) continue;
+                const int next = nz * side + nx;
+                if (costs[next] == PathFinder::BLOCKED) continue;
+                const bool diagonal = dx != 0 && dz != 0;
+                if (diagonal && (costs[z * side + nx] == PathFinder::BLOCKED || costs[nz * side + x] == PathFinder::BLOCKED)) {
+                    continue;
+                }
+                const float step = diagonal ? DIAGONAL : 1.0f;
+                const float cost = distance[cell] + step * (costs[cell] + costs[next]) * 0.5f;
+                if (cost < distance[next]) {
+                    distance[next] = cost;
+                    length[next] = length[cell] + step;
+                    open.push({cost + heuristic(next), next});
+                }
+            }
+        }
+    }
+    return -1.0f;
+}
+
+void benchPathfinding(const Options& options, const Region& region, JsonWriter& json, Checks& checks) {
+    ThreadPool pool(options.threads);
+    PathFinder pathFinder(pool);
+
+    auto buildStart = Clock::now();
+    for (const auto& chunk : region.chunks) {
+        pathFinder.addChunk(chunk->chunkX, chunk->chunkZ, chunk->walkCosts);
+    }
+    do {
+        pathFinder.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } while (pathFinder.getStats().pendingBuilds > 0);
+    pathFinder.update();
+    double buildMilliseconds = millisecondsSince(buildStart);
+    PathFinder::Stats stats = pathFinder.getStats();
+
+    json.beginObject("pathfinding");
+    json.value("clusters", (double)stats.clusters);
+    json.value("transitions", (double)stats.transitions);
+    json.value("buildMs", buildMilliseconds);
+
+    // Random trips of a fixed length that start on walkable ground. Spans are fractions of
+    // the region side and goals are clamped into it, so every request has loaded ground at
+    // both ends and the long trips measure search rather than NOT_LOADED early-outs.
+    constexpr int MAX_START_ATTEMPTS = 64;
+    const float minWorld = region.getMinWorld();
+    const float maxWorld = minWorld + region.getWorldSize() - 0.01f;
+    std::mt19937 random(4);
+    std::uniform_real_distribution<float> coordinate(minWorld, maxWorld);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    const int requestCount = 300;
+    for (float fraction : {0.05f, 0.25f, 0.75f}) {
+        float span = fraction * region.getWorldSize();
+        int found = 0, unreachable = 0, notLoaded = 0, noStart = 0;
+        double milliseconds = 0.0;
+        for (int i = 0; i < requestCount; i++) {
+            float startX = 0.0f, startZ = 0.0f;
+            bool walkable = false;
+            for (int attempt = 0; attempt < MAX_START_ATTEMPTS && !walkable; attempt++) {
+                startX = coordinate(random);
+                startZ = coordinate(random);
+                walkable = pathFinder.isWalkable(startX, startZ);
+            }
+            if (!walkable) {
+                noStart++;
+                continue;
+            }
+            float heading = angle(random);
+            float goalX = std::clamp(startX + std::cos(heading) * span, minWorld, maxWorld);
+            float goalZ = std::clamp(startZ + std::sin(heading) * span, minWorld, maxWorld);
+            auto start = Clock::now();
+            PathResult result = pathFinder.findPath(startX, startZ, goalX, goalZ);
+            milliseconds += millisecondsSince(start);
+            if (result.outcome == PathResult::Outcome::FOUND) found++;
+            else if (result.outcome == PathResult::Outcome::UNREACHABLE) unreachable++;
+            else notLoaded++;
+        }
+
+        std::string key = "span" + std::to_string((int)span);
+        json.beginObject(key.c_str());
+        json.value("span", span);
+        json.value("requestsPerSecond", (requestCount - noStart) / (milliseconds / 1000.0));
+        json.value("found", found);
+        json.value("unreachable", unreachable);
+        json.value("notLoaded", notLoaded);
+        json.value("noWalkableStart", noStart);
+        json.endObject();
+    }
+
+    // A sample of trips between walkable cells against plain A* over the same cells: the
+    // same trips must be reachable, and the smoothed hierarchical path may be longer than
+    // the cheapest flat one, but only by a bounded factor
+    constexpr int REFERENCE_TRIPS = 40;
+    constexpr float MAX_LENGTH_RATIO = 1.5f;
+    constexpr float LENGTH_SLACK = 2.0f;  // World units, for snapping ends to cell centres
+    FlatWalkGrid grid(region);
+    int reachabilityMismatches = 0, tooLong = 0, compared = 0;
+    float maxRatio = 0.0f;
+    for (int trip = 0; trip < REFERENCE_TRIPS; trip++) {
+        float ends[4] = {};
+        bool walkable = false;
+        for (int attempt = 0; attempt < MAX_START_ATTEMPTS && !walkable; attempt++) {
+            for (float& end : ends) end = coordinate(random);
+            walkable = pathFinder.isWalkable(ends[0], ends[1]) && pathFinder.isWalkable(ends[2], ends[3]);
+        }
+        if (!walkable) continue;
+
+        PathResult result = pathFinder.findPath(ends[0], ends[1], ends[2], ends[3]);
+        float referenceLength = findFlatPathLength(grid, grid.getCell(ends[0], ends[1]), grid.getCell(ends[2], ends[3]));
+        bool found = result.outcome == PathResult::Outcome::FOUND;
+        compared++;
+        if (found != (referenceLength >= 0.0f)) {
+            reachabilityMismatches++;
+            continue;
+        }
+        if (!found) continue;
+
+        float length = 0.0f, x = ends[0], z = ends[1];
+        for (const PathPoint& point : result.waypoints) {
+            length += std::hypot(point.x - x, point.z - z);
+            x = point.x;
+            z = point.z;
+        }
+        if (length > referenceLength * MAX_LENGTH_RATIO + LENGTH_SLACK) tooLong++;
+        if (referenceLength > 0.0f) maxRatio = std::max(maxRatio, length / referenceLength);
+    }
+    json.beginObject("flatReference");
+    json.value("trips", compared);
+    json.value("maxLengthRatio", maxRatio);
+    json.endObject();
+    checks.expect(json, "pathfinding", "reachabilityMatchesFlat", compared > 0 && reachabilityMismatches == 0);
+    checks.expect(json, "pathfinding", "lengthWithinFlatBound", tooLong == 0);
+    json.endObject();
+}
+
+// bgfx without a GPU, for the sections that drive a real ChunkManager
+bool initNoopRenderer() {
+    bgfx::Init init;
+    init.type = bgfx::RendererType::Noop;
+    init.vendorId = BGFX_PCI_ID_NONE;
+    init.resolution.width = 1280;
+    init.resolution.height = 720;
+    return bgfx::init(init);
+}
+
+// Brush edits on the loaded terrain: per-edit latency, seams between neighbouring chunks
+// and ray hits against the edited heights
+void benchDeformation(const std::filesystem::path& scratch, JsonWriter& json, Checks& checks) {
+    constexpr int EDIT_COUNT = 400;
+    constexpr float EDIT_AREA = 120.0f;  // Brush centres within this distance of the origin, inside the load range
+
+    if (!initNoopRenderer()) {
+        std::cerr << "bgfx Noop init failed, skipping deformation" << std::endl;
+        return;
+    }
+
+    // ChunkManager keeps its region files under the working directory
+    std::filesystem::path previousDirectory = std::filesystem::current_path();
+    std::filesystem::create_directories(scratch / "deform");
+    std::filesystem::current_path(scratch / "deform");
+
+    std::vector<double> editMilliseconds;
+    double totalVertices = 0.0, totalChunks = 0.0;
+    double maxRayError = 0.0, maxSeamError = 0.0;
+    int rayMisses = 0, seamViolations = 0;
+    {
+        std::vector<ResourceNode> resourceNodes;
+        std::vector<std::unique_ptr<NPC>> npcs;
+        ChunkManager chunkManager;
+        chunkManager.setResourceNodesPointer(&resourceNodes);
+        chunkManager.setNPCsPointer(&npcs);
+        chunkManager.forceInitialChunkLoad(0.0f, 0.0f);
+        while (chunkManager.getPendingChunkCount() > 0) {
+            chunkManager.updateChunksAroundPlayer(0.0f, 0.0f);
+            bgfx::frame();
+        }
+
+        std::mt19937 rng(20);
+        std::uniform_real_distribution<float> position(-EDIT_AREA, EDIT_AREA);
+        std::uniform_real_distribution<float> radius(2.0f, 12.0f);
+        std::uniform_real_distribution<float> amount(-3.0f, 3.0f);
+        for (int i = 0; i < EDIT_COUNT; i++) {
+            ChunkManager::TerrainBrush brush;
+            brush.x = position(rng);
+            brush.z = position(rng);
+            brush.radius = radius(rng);
+            if (i % 2 == 0) {
+                brush.mode = ChunkManager::TerrainBrush::Mode::RAISE;
+                brush.amount = amount(rng);
+            } else {
+                brush.mode = ChunkManager::TerrainBrush::Mode::FLATTEN;
+                brush.amount = 0.8f;
+                brush.targetHeight = chunkManager.getHeightAt(brush.x, brush.z);
+            }
+
+            ChunkManager::DeformResult result = chunkManager.deformTerrain(brush);
+            editMilliseconds.push_back(result.milliseconds);
+            totalVertices += result.verticesChanged;
+            totalChunks += result.chunksChanged;
+            bgfx::frame();
+
+            // Straight down onto the grid vertex nearest the centre, where the ray and the
+            // bilinear height query must agree
+            float vertexX = std::round(brush.x / TerrainChunk::SCALE) * TerrainChunk::SCALE;
+            float vertexZ = std::round(brush.z / TerrainChunk::SCALE) * TerrainChunk::SCALE;
+            bx::Vec3 hit(bx::InitNone);
+            if (chunkManager.raycast({vertexX, 200.0f, vertexZ}, {0.0f, -1.0f, 0.0f}, 1000.0f, hit)) {
+                float expected = chunkManager.getHeightAt(vertexX, vertexZ) - 5.0f;
+                maxRayError = std::max(maxRayError, (double)std::fabs(hit.y - expected));
+            } else {
+                rayMisses++;
+            }
+        }
+
+        // Every border shared by two loaded chunks, edited or not
+        const int last = TerrainChunk::CHUNK_SIZE;
+        for (int chunkZ = -ChunkManager::RENDER_DISTANCE; chunkZ <= ChunkManager::RENDER_DISTANCE; chunkZ++) {
+            for (int chunkX = -ChunkManager::RENDER_DISTANCE; chunkX <= ChunkManager::RENDER_DISTANCE; chunkX++) {
+                const TerrainChunk* chunk = chunkManager.findChunk(chunkX, chunkZ);
+                if (!chunk) continue;
+                const TerrainChunk* east = chunkManager.findChunk(chunkX + 1, chunkZ);
+                const TerrainChunk* south = chunkManager.findChunk(chunkX, chunkZ + 1);
+                // Each side is within half a quantization step of the shared height
+                auto checkSeam = [&](const TerrainChunk* neighbour, float height, float neighbourHeight) {
+                    double error = std::fabs(height - neighbourHeight);
+                    double allowed = 0.5 * (chunk->heightTile.heightScale + neighbour->heightTile.heightScale) + 1e-6;
+                    maxSeamError = std::max(maxSeamError, error);
+                    if (error > allowed) seamViolations++;
+                };
+                for (int i = 0; i <= last; i++) {
+                    if (east) checkSeam(east, chunk->getVertexHeight(last, i), east->getVertexHeight(0, i));
+                    if (south) checkSeam(south, chunk->getVertexHeight(i, last), south->getVertexHeight(i, 0));
+                }
+            }
+        }
+        chunkManager.shutdown();
+    }
+    bgfx::shutdown();
+    std::filesystem::current_path(previousDirectory);
+
+    std::vector<double> sorted = editMilliseconds;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double milliseconds : sorted) sum += milliseconds;
+
+    json.beginObject("deformation");
+    json.value("edits", EDIT_COUNT);
+    json.value("meanMs", sum / sorted.size());
+    json.value("p99Ms", sorted[sorted.size() * 99 / 100]);
+    json.value("maxMs", sorted.back());
+    json.value("meanVertices", totalVertices / EDIT_COUNT);
+    json.value("meanChunks", totalChunks / EDIT_COUNT);
+    json.value("maxSeamError", maxSeamError);
+    json.value("maxRayError", maxRayError);
+    json.value("rayMisses", rayMisses);
+    checks.expect(json, "deformation", "seamsWithinQuantization", seamViolations == 0);
+    checks.expect(json, "deformation", "raysHitEditedHeights", rayMisses == 0 && maxRayError <= RAY_T_EPSILON);
+    json.endObject();
+}
+
+// Streams a long walk around a circle through a real ChunkManager (Noop renderer) and
+// samples the world entity counts and RSS at the end of every minute, which should stay
+// flat however far the player goes
+void benchWalk(const Options& options, const std::filesystem::path& scratch, JsonWriter& json, Checks& checks) {
+    if (!initNoopRenderer()) {
+        std::cerr << "bgfx Noop init failed, skipping the walk" << std::endl;
+        return;
+    }
+
+    // ChunkManager keeps its region files under the working directory
+    std::filesystem::path previousDirectory = std::filesystem::current_path();
+    std::filesystem::create_directories(scratch / "walk");
+    std::filesystem::current_path(scratch / "walk");
+
+    const float frameSeconds = 1.0f / 60.0f;
+    const float speed = 15.0f;      // Sprinting, world units per second
+    const float radius = 400.0f;    // Laps of ~2500 units revisit earlier chunks
+    const int frameCount = (int)(options.walkMinutes * 60.0f / frameSeconds);
+    const int framesPerMinute = (int)(60.0f / frameSeconds);
+
+    std::vector<ResourceNode> resourceNodes;
+    std::vector<std::unique_ptr<NPC>> npcs;
+    size_t maxNPCs = 0, maxResources = 0, maxChunks = 0;
+    int streamingFrames = 0;
+    std::vector<double> npcsPerMinute, resourcesPerMinute, rssKBPerMinute;
+    ChunkManager::LoadStats loadStats;
+    ChunkManager::ResidencyStats residency;
+    ChunkCache::Stats cacheStats;
+    auto walkStart = Clock::now();
+    {
+        ChunkManager chunkManager;
+        chunkManager.setResourceNodesPointer(&resourceNodes);
+        chunkManager.setNPCsPointer(&npcs);
+        chunkManager.forceInitialChunkLoad(radius, 0.0f);
+
+        for (int frame = 0; frame < frameCount; frame++) {
+            auto frameStart = Clock::now();
+            float angle = frame * frameSeconds * speed / radius;
+            float x = std::cos(angle) * radius, z = std::sin(angle) * radius;
+            float velocityX = -std::sin(angle) * speed, velocityZ = std::cos(angle) * speed;
+            chunkManager.updateChunksAroundPlayer(x, z, velocityX, velocityZ);
+            bgfx::frame();
+
+            maxNPCs = std::max(maxNPCs, npcs.size());
+            maxResources = std::max(maxResources, resourceNodes.size());
+            maxChunks = std::max(maxChunks, chunkManager.getMemoryStats().chunkCount);
+            if (frame % framesPerMinute == framesPerMinute - 1) {
+                npcsPerMinute.push_back((double)npcs.size());
+                resourcesPerMinute.push_back((double)resourceNodes.size());
+                rssKBPerMinute.push_back(getCurrentRssKilobytes());
+            }
+
+            // Give the workers real frame time while anything is streaming; quiet frames run flat out
+            if (chunkManager.getPendingChunkCount() > 0) {
+                streamingFrames++;
+                std::this_thread::sleep_until(frameStart + std::chrono::microseconds((int)(frameSeconds * 1e6f)));
+            }
+        }
+
+        loadStats = chunkManager.getLoadStats();
+        residency = chunkManager.getResidencyStats();
+        cacheStats = chunkManager.getCacheStats();
+        chunkManager.shutdown();
+    }
+    double walkMilliseconds = millisecondsSince(walkStart);
+    bgfx::shutdown();
+    std::filesystem::current_path(previousDirectory);
+
+    json.beginObject("walk");
+    json.value("minutes", options.walkMinutes);
+    json.value("frames", frameCount);
+    json.value("streamingFrames", streamingFrames);
+    json.value("wallSeconds", walkMilliseconds / 1000.0);
+    json.value("maxLoadedChunks", (double)maxChunks);
+    json.value("maxNPCs", (double)maxNPCs);
+    json.value("maxResourceNodes", (double)maxResources);
+    json.value("finalNPCs", (double)npcs.size());
+    json.value("finalResourceNodes", (double)resourceNodes.size());
+    json.values("npcsPerMinute", npcsPerMinute);
+    json.values("resourceNodesPerMinute", resourcesPerMinute);
+    json.values("rssKBPerMinute", rssKBPerMinute);
+    json.value("generatedChunks", loadStats.generatedChunks);
+    json.value("cachedChunks", loadStats.cachedChunks);
+    json.value("cacheWrites", (double)cacheStats.writes);
+    json.value("warmHits", (double)residency.warmHits);
+    json.value("warmEvictions", (double)residency.warmEvictions);
+    json.value("chunksAllocated", (double)residency.pool.chunksAllocated);
+    json.value("chunksReused", (double)residency.pool.chunksReused);
+    json.value("buffersCreated", (double)residency.buffers.created);
+    json.value("buffersUpdated", (double)residency.buffers.updated);
+
+    // The first minute is the baseline once the start area has streamed in; a walk of one
+    // minute has nothing to compare it with
+    auto staysFlat = [](const std::vector<double>& series) {
+        return series.size() < 2 || series.back() <= series.front() * (1.0 + WALK_GROWTH_TOLERANCE);
+    };
+    checks.expect(json, "walk", "npcsStayFlat", staysFlat(npcsPerMinute));
+    checks.expect(json, "walk", "resourceNodesStayFlat", staysFlat(resourcesPerMinute));
+    checks.expect(json, "walk", "rssStaysFlat", staysFlat(rssKBPerMinute));
+    json.endObject();
+}
+
+// Animated instances set up like NPCs: the idle/walking split, random phases and one
+// identity skin binding they all share, as NPCs share theirs through the AnimationLibrary
+// (pose sharing keys on it). False if the NPC clips aren't in options.animAssets.
+bool createAnimatedInstances(const Options& options, int count, std::mt19937& rng,
+                             std::vector<std::unique_ptr<OzzAnimationSystem>>& systems) {
+    const std::string skeletonPath = options.animAssets + "/skeleton.ozz";
+    const std::string clipPaths[] = {options.animAssets + "/Armature_mixamo.com_Layer0.002.ozz",
+                                     options.animAssets + "/walking_inplace.ozz"};
+    systems.clear();
+    for (int i = 0; i < count; i++) {
+        auto system = std::make_unique<OzzAnimationSystem>();
+        if (!system->loadSkeleton(skeletonPath) || !system->loadAnimation("idle", clipPaths[0]) ||
+            !system->loadAnimation("walking", clipPaths[1])) {
+            std::cerr << "Skipping the animation benchmarks, NPC clips not found in " << options.animAssets
+                      << std::endl;
+            return false;
+        }
+        if (i % 2) system->setCurrentAnimation("walking");
+        system->setAnimationTime(std::uniform_real_distribution<float>(0.0f, system->getAnimationDuration())(rng));
+        systems.push_back(std::move(system));
+    }
+
+    const int numJoints = systems[0]->getNumBones();
+    std::vector<float> identities((size_t)numJoints * 16, 0.0f);
+    std::vector<int> identityMapping(numJoints);
+    for (int joint = 0; joint < numJoints; joint++) {
+        identities[joint * 16] = identities[joint * 16 + 5] = identities[joint * 16 + 10] = identities[joint * 16 + 15] = 1.0f;
+        identityMapping[joint] = joint;
+    }
+    std::shared_ptr<const SkinBinding> binding =
+        SkinBinding::create(numJoints, identities.data(), numJoints, identityMapping);
+    for (auto& system : systems) {
+        system->setSkinBinding(binding);
+    }
+    return true;
+}
+
+// The NPC animation update: every instance sampled, converted to model space and skinned
+// each frame through the AnimationUpdateStage, from one thread up to every core
+void benchAnimation(const Options& options, JsonWriter& json) {
+    constexpr int WARMUP_FRAMES = 5;
+    constexpr int TIMED_FRAMES = 30;
+    constexpr float FRAME_SECONDS = 1.0f / 60.0f;
+
+    std::vector<size_t> threadCounts;
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads < cores; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(cores);
+
+    // Every instance sampled every frame, so thread counts compare the same work
+    AnimationLodPolicy fullRate;
+    fullRate.bands = {{FLT_MAX, 0.0f, true}};
+    fullRate.budgetMicroseconds = 0.0f;
+
+    json.beginObject("animation");
+    json.value("cores", (double)cores);
+    std::mt19937 rng(1234);
+    for (int instanceCount : {1000, 10000}) {
+        std::vector<std::unique_ptr<OzzAnimationSystem>> systems;
+        if (!createAnimatedInstances(options, instanceCount, rng, systems)) {
+            json.value("error", std::string("assets not found"));
+            break;
+        }
+
+        json.beginObject(instanceCount == 1000 ? "instances1k" : "instances10k");
+        double singleThreadMs = 0.0;
+        for (size_t threads : threadCounts) {
+            std::unique_ptr<ThreadPool> pool = threads > 1 ? std::make_unique<ThreadPool>(threads - 1) : nullptr;
+            AnimationUpdateStage stage(pool.get());
+            stage.setLodPolicy(fullRate);
+            double timedMs = 0.0;
+            for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; frame++) {
+                stage.begin();
+                for (auto& system : systems) {
+                    stage.add(system.get());
+                }
+                stage.run(FRAME_SECONDS);
+                if (frame >= WARMUP_FRAMES) timedMs += stage.getStats().milliseconds;
+            }
+            const double msPerFrame = timedMs / TIMED_FRAMES;
+            if (threads == 1) singleThreadMs = msPerFrame;
+
+            json.beginObject(("threads" + std::to_string(threads)).c_str());
+            json.value("msPerFrame", msPerFrame);
+            json.value("usPerInstance", msPerFrame * 1000.0 / instanceCount);
+            json.value("speedup", singleThreadMs / msPerFrame);
+            json.value("paletteKB", stage.getPalettes().size() * sizeof(ozz::math::Float4x4) / 1024.0);
+            json.endObject();
+        }
+        json.endObject();
+    }
+    json.endObject();
+}
+
+// Animation LOD: the cost of a crowd spread over every tier, with and without the budget and
+// pose sharing, and how far the interpolated poses of the nearer tiers stray from sampling
+// every frame
+void benchAnimationLod(const Options& options, JsonWriter& json, Checks& checks) {
+    constexpr int CROWD = 10000;
+    constexpr int WARMUP_FRAMES = 10;
+    constexpr int TIMED_FRAMES = 60;
+    constexpr float FRAME_SECONDS = 1.0f / 60.0f;
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+    json.beginObject("animationLod");
+    std::mt19937 rng(2468);
+    std::vector<std::unique_ptr<OzzAnimationSystem>> systems;
+    if (!createAnimatedInstances(options, CROWD, rng, systems)) {
+        json.value("error", std::string("assets not found"));
+        json.endObject();
+        return;
+    }
+
+    // Camera distances up to 200 units, a third of the crowd off screen
+    std::vector<float> distances(CROWD);
+    std::vector<bool> visible(CROWD);
+    std::uniform_real_distribution<float> distance(0.0f, 200.0f);
+    for (int i = 0; i < CROWD; i++) {
+        distances[i] = distance(rng);
+        visible[i] = rng() % 3 != 0;
+    }
+
+    // Default policy with and without the budget, then without pose sharing either, so the
+    // last two differ only in whether the far bands share poses
+    AnimationLodPolicy unlimited;
+    unlimited.budgetMicroseconds = 0.0f;
+    AnimationLodPolicy unshared = unlimited;
+    for (AnimationLodPolicy::Band& band : unshared.bands) band.sharePose = false;
+    const std::pair<const char*, AnimationLodPolicy> policies[] = {
+        {"budgeted", AnimationLodPolicy()}, {"unlimited", unlimited}, {"unshared", unshared}};
+    for (const auto& [name, policy] : policies) {
+        std::unique_ptr<ThreadPool> pool = cores > 1 ? std::make_unique<ThreadPool>(cores - 1) : nullptr;
+        AnimationUpdateStage stage(pool.get());
+        stage.setLodPolicy(policy);
+        double timedMs = 0.0;
+        double deferred = 0.0;
+        double sharedPoses = 0.0;
+        std::vector<AnimationUpdateStage::TierStats> tiers(policy.getTierCount());
+        for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; frame++) {
+            stage.begin();
+            for (int i = 0; i < CROWD; i++) {
+                stage.add(systems[i].get(), distances[i], visible[i]);
+            }
+            stage.run(FRAME_SECONDS);
+            if (frame < WARMUP_FRAMES) continue;
+            const AnimationUpdateStage::Stats& stats = stage.getStats();
+            timedMs += stats.milliseconds;
+            deferred += stats.deferred;
+            sharedPoses += stats.sharedPoses;
+            for (size_t t = 0; t < tiers.size(); t++) {
+                tiers[t].instances += stats.tiers[t].instances;
+                tiers[t].sampled += stats.tiers[t].sampled;
+                tiers[t].posed += stats.tiers[t].posed;
+                tiers[t].shared += stats.tiers[t].shared;
+            }
+        }
+
+        json.beginObject(name);
+        json.value("budgetUs", policy.budgetMicroseconds);
+        json.value("msPerFrame", timedMs / TIMED_FRAMES);
+        json.value("deferredPerFrame", deferred / TIMED_FRAMES);
+        json.value("sharedPosesPerFrame", sharedPoses / TIMED_FRAMES);
+        json.value("sampleUs", stage.getStats().sampleMicroseconds);
+        json.value("poseUs", stage.getStats().poseMicroseconds);
+        int sharedInstances = 0;
+        bool policyShares = false;
+        for (size_t t = 0; t < tiers.size(); t++) {
+            json.beginObject(("tier" + std::to_string(t)).c_str());
+            json.value("instances", (double)tiers[t].instances / TIMED_FRAMES);
+            json.value("sampledPerFrame", (double)tiers[t].sampled / TIMED_FRAMES);
+            json.value("posedPerFrame", (double)tiers[t].posed / TIMED_FRAMES);
+            json.value("sharedPerFrame", (double)tiers[t].shared / TIMED_FRAMES);
+            json.endObject();
+            sharedInstances += tiers[t].shared;
+            policyShares = policyShares || policy.sharesPose((int)t);
+        }
+        // Thousands of instances on two clips must land in common buckets wherever sharing is on
+        checks.expect(json, (std::string("animationLod.") + name).c_str(), "sharesOnlyWhereEnabled",
+                      policyShares ? sharedInstances > 0 : sharedInstances == 0);
+        json.endObject();
+    }
+
+    // Twin crowds at the same phases: one sampled every frame, one through an interpolating
+    // band. The gap is the largest joint translation difference in model space.
+    constexpr int TWINS = 256;
+    for (int tier = 0; tier < 2; tier++) {
+        AnimationLodPolicy policy;
+        policy.budgetMicroseconds = 0.0f;  // Only interpolation error, no deferred samples
+        const float twinDistance = tier == 0 ? 0.0f : policy.bands[0].maxDistance + 1.0f;
+        std::mt19937 twinRng(1357);
+        std::vector<std::unique_ptr<OzzAnimationSystem>> reference, interpolated;
+        createAnimatedInstances(options, TWINS, twinRng, reference);
+        twinRng.seed(1357);
+        createAnimatedInstances(options, TWINS, twinRng, interpolated);
+
+        AnimationLodPolicy fullRate;
+        fullRate.bands = {{FLT_MAX, 0.0f, true}};
+        fullRate.budgetMicroseconds = 0.0f;
+        AnimationUpdateStage referenceStage, interpolatedStage;
+        referenceStage.setLodPolicy(fullRate);
+        interpolatedStage.setLodPolicy(policy);
+
+        double maxError = 0.0;
+        for (int frame = 0; frame < 120; frame++) {
+            std::vector<int> referenceHandles, interpolatedHandles;
+            referenceStage.begin();
+            interpolatedStage.begin();
+            for (int i = 0; i < TWINS; i++) {
+                referenceHandles.push_back(referenceStage.add(reference[i].get()));
+                interpolatedHandles.push_back(interpolatedStage.add(interpolated[i].get(), twinDistance, true));
+            }
+            referenceStage.run(FRAME_SECONDS);
+            interpolatedStage.run(FRAME_SECONDS);
+            for (int i = 0; i < TWINS; i++) {
+                const ozz::math::Float4x4* exact = referenceStage.getPalette(referenceHandles[i]);
+                const ozz::math::Float4x4* blended = interpolatedStage.getPalette(interpolatedHandles[i]);
+                for (int j = 0; j < reference[i]->getNumBones(); j++) {
+                    float a[4], b[4];
+                    ozz::math::StorePtrU(exact[j].cols[3], a);
+                    ozz::math::StorePtrU(blended[j].cols[3], b);
+                    for (int c = 0; c < 3; c++) maxError = std::max(maxError, (double)std::fabs(a[c] - b[c]));
+                }
+            }
+        }
+        json.value(tier == 0 ? "tier0MaxJointError" : "tier1MaxJointError", maxError);
+    }
+    json.endObject();
+}
+
+// GPU skinning check without a GPU: pack the palettes of every other instance the way the
+// NPC draw does, skin random vertices from the packed texels exactly as vs_npc_instanced.sc
+// reads them, and compare with ozz's SkinningJob on the unpacked matrices. Both sides are
+// the same float math in a different order, so anything past rounding is a packing bug.
+void benchSkinPalette(const Options& options, JsonWriter& json, Checks& checks) {
+    constexpr int INSTANCES = 64;
+    constexpr int VERTICES = 2000;
+    constexpr double MAX_ERROR_ALLOWED = 1e-4;  // Model-space units
+
+    json.beginObject("skinPalette");
+    std::mt19937 rng(4321);
+    std::vector<std::unique_ptr<OzzAnimationSystem>> systems;
+    if (!createAnimatedInstances(options, INSTANCES, rng, systems)) {
+        json.value("error", std::string("assets not found"));
+        json.endObject();
+        return;
+    }
+    const int numJoints = systems[0]->getNumBones();
+
+    AnimationUpdateStage stage;
+    std::vector<int> handles;
+    stage.begin();
+    for (auto& system : systems) {
+        handles.push_back(stage.add(system.get()));
+    }
+    stage.run(0.37f);
+
+    // Every other instance is "off screen", so packed offsets differ from the stage's
+    SkinPalette palette;
+    std::vector<std::pair<int, uint32_t>> packed;
+    auto packStart = Clock::now();
+    palette.begin();
+    for (int i = 0; i < INSTANCES; i += 2) {
+        packed.push_back({handles[i], palette.add(stage.getPalette(handles[i]), numJoints)});
+    }
+    double packMilliseconds = millisecondsSince(packStart);
+
+    // Vertices around a mannequin-sized box with four normalized influences each
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> joint(0, numJoints - 1);
+    std::vector<float> positions(VERTICES * 3);
+    std::vector<uint8_t> jointIndices(VERTICES * 4);
+    std::vector<uint16_t> ozzJointIndices(VERTICES * 4);
+    std::vector<float> jointWeights(VERTICES * 4);
+    std::vector<float> ozzJointWeights(VERTICES * 3);
+    for (int v = 0; v < VERTICES; v++) {
+        for (int c = 0; c < 3; c++) positions[v * 3 + c] = coordinate(rng);
+        float weightSum = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            jointIndices[v * 4 + k] = (uint8_t)joint(rng);
+            ozzJointIndices[v * 4 + k] = jointIndices[v * 4 + k];
+            jointWeights[v * 4 + k] = coordinate(rng) * 0.5f + 0.5f;
+            weightSum += jointWeights[v * 4 + k];
+        }
+        for (int k = 0; k < 4; k++) jointWeights[v * 4 + k] /= weightSum;
+        for (int k = 0; k < 3; k++) ozzJointWeights[v * 3 + k] = jointWeights[v * 4 + k];
+    }
+
+    double maxError = 0.0;
+    bool skinningJobsRan = true;
+    std::vector<float> reference(VERTICES * 3);
+    for (const auto& instance : packed) {
+        ozz::geometry::SkinningJob skinningJob;
+        skinningJob.vertex_count = VERTICES;
+        skinningJob.influences_count = 4;
+        skinningJob.joint_matrices = ozz::span<const ozz::math::Float4x4>(stage.getPalette(instance.first), numJoints);
+        skinningJob.joint_indices = ozz::span<const uint16_t>(ozzJointIndices.data(), ozzJointIndices.size());
+        skinningJob.joint_indices_stride = sizeof(uint16_t) * 4;
+        skinningJob.joint_weights = ozz::span<const float>(ozzJointWeights.data(), ozzJointWeights.size());
+        skinningJob.joint_weights_stride = sizeof(float) * 3;
+        skinningJob.in_positions = ozz::span<const float>(positions.data(), positions.size());
+        skinningJob.in_positions_stride = sizeof(float) * 3;
+        skinningJob.out_positions = ozz::span<float>(reference.data(), reference.size());
+        skinningJob.out_positions_stride = sizeof(float) * 3;
+        if (!skinningJob.Run()) {
+            json.value("error", std::string("SkinningJob failed"));
+            skinningJobsRan = false;
+            break;
+        }
+
+        for (int v = 0; v < VERTICES; v++) {
+            float skinned[3];
+            SkinPalette::skinPosition(palette.getTexels().data(), instance.second, &jointIndices[v * 4],
+                                      &jointWeights[v * 4], &positions[v * 3], skinned);
+            for (int c = 0; c < 3; c++) {
+                maxError = std::max(maxError, (double)std::fabs(skinned[c] - reference[v * 3 + c]));
+            }
+        }
+    }
+
+    json.value("instancesPacked", (double)packed.size());
+    json.value("verticesChecked", (double)packed.size() * VERTICES);
+    json.value("maxError", maxError);
+    json.value("maxErrorAllowed", MAX_ERROR_ALLOWED);
+    checks.expect(json, "skinPalette", "matchesSkinningJob", skinningJobsRan && maxError <= MAX_ERROR_ALLOWED);
+    json.value("usPackPerInstance", packMilliseconds * 1000.0 / packed.size());
+    json.value("paletteKB", palette.getTexelCount() * 16 / 1024.0);
+    json.endObject();
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue) {
+            options.size = std::max(3, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--rays" && hasValue) {
+            options.rays = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--walk-minutes" && hasValue) {
+            options.walkMinutes = std::max(0.0f, (float)std::atof(argv[++i]));
+        } else if (arg == "--anim-assets" && hasValue) {
+            options.animAssets = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--size N] [--threads T] [--rays R] [--walk-minutes M] [--anim-assets dir] [--json path]"
+                      << " [--verbose]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    // Generation logs a line per chunk; keep it out of the timings unless asked for
+    NullBuffer nullBuffer;
+    std::streambuf* consoleBuffer = std::cout.rdbuf();
+    if (!options.verbose) {
+        std::cout.rdbuf(&nullBuffer);
+    }
+
+    std::filesystem::path scratch = std::filesystem::temp_directory_path() / "worldgen_bench";
+    std::filesystem::remove_all(scratch);
+    std::filesystem::create_directories(scratch);
+
+    JsonWriter json;
+    Checks checks;
+    json.beginObject();
+    json.beginObject("config");
+    json.value("size", options.size);
+    json.value("threads", options.threads);
+    json.value("simd", std::string(TerrainKernel::getSimdName()));
+    json.endObject();
+
+    Region region;
+    benchGeneration(options, region, json, checks);
+    benchKernel(region, json, checks);
+    benchKernelSpecializations(json, checks);
+    benchCache(region, scratch, json, checks);
+    benchHeightQueries(region, json);
+    benchChunkLookup(region, json, checks);
+    benchRaycast(options, region, json, checks);
+    benchSpatialGrid(region, json, checks);
+    benchPathfinding(options, region, json, checks);
+    benchDeformation(scratch, json, checks);
+    benchAnimation(options, json);
+    benchAnimationLod(options, json, checks);
+    benchSkinPalette(options, json, checks);
+    if (options.walkMinutes > 0.0f) {
+        benchWalk(options, scratch, json, checks);
+    }
+    json.value("peakRssKB", getPeakRssKilobytes());
+    checks.write(json);
+    json.endObject();
+
+    std::cout.rdbuf(consoleBuffer);
+    std::filesystem::remove_all(scratch);
+
+    std::string report = json.str();
+    std::cout << report;
+    if (!options.jsonPath.empty()) {
+        std::ofstream file(options.jsonPath);
+        file << report;
+        if (!file) {
+            std::cerr << "Failed to write " << options.jsonPath << std::endl;
+            return 1;
+        }
+    }
+    if (checks.getFailureCount() > 0) {
+        checks.printFailures(std::cerr);
+        return 1;
+    }
+    return 0;
+}